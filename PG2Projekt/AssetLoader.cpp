@@ -0,0 +1,247 @@
+﻿#include "AssetLoader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+AssetLoader* AssetLoader::instance = nullptr;
+
+AssetLoader::AssetLoader() {
+    // Jedno jádro zůstává hlavnímu (GL) vláknu
+    unsigned int hardware = std::thread::hardware_concurrency();
+    unsigned int count = std::max(1u, hardware > 1 ? hardware - 1 : 1u);
+
+    for (unsigned int i = 0; i < count; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+    std::cout << "AssetLoader: " << count << " worker threads" << std::endl;
+}
+
+AssetLoader::~AssetLoader() {
+    shutdown();
+}
+
+AssetLoader* AssetLoader::getInstance() {
+    if (!instance) {
+        instance = new AssetLoader();
+    }
+    return instance;
+}
+
+void AssetLoader::enqueue(std::shared_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cpu_queue.push_back(std::move(job));
+    }
+    submitted++;
+    work_available.notify_one();
+}
+
+void AssetLoader::workerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_available.wait(lock, [this] { return stopping || !cpu_queue.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = cpu_queue.front();
+            cpu_queue.pop_front();
+        }
+
+        try {
+            job->cpu();
+        }
+        catch (const std::exception& e) {
+            job->error = e.what();
+        }
+        catch (...) {
+            job->error = "Unknown error";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            gpu_queue.push_back(std::move(job));
+        }
+        upload_available.notify_one();
+    }
+}
+
+void AssetLoader::finishJob(Job& job) {
+    if (job.error.empty()) {
+        try {
+            job.gpu();
+        }
+        catch (const std::exception& e) {
+            job.error = e.what();
+        }
+    }
+
+    if (!job.error.empty()) {
+        std::cerr << "Asset loading error (" << job.name << "): " << job.error << std::endl;
+        job.fail(job.error);
+        failures++;
+    }
+    completed++;
+}
+
+void AssetLoader::update(double budget_ms) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (gpu_queue.empty()) {
+                return;
+            }
+            job = gpu_queue.front();
+            gpu_queue.pop_front();
+        }
+
+        finishJob(*job);
+
+        // Časový limit - zbytek se nahraje v dalších snímcích
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budget_ms) {
+            return;
+        }
+    }
+}
+
+void AssetLoader::flush() {
+    while (!idle()) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            upload_available.wait(lock, [this] { return !gpu_queue.empty() || stopping; });
+            if (stopping) {
+                return;
+            }
+        }
+        update(1e9);
+    }
+}
+
+void AssetLoader::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        stopping = true;
+        cpu_queue.clear();
+    }
+    work_available.notify_all();
+    upload_available.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+
+    // Hotová data, která se už nenahrají (mapované soubory apod.)
+    gpu_queue.clear();
+    pending_meshes.clear();
+    pending_textures.clear();
+}
+
+AssetHandle<std::shared_ptr<MeshGeometry>> AssetLoader::loadMesh(const std::filesystem::path& path,
+    const MeshImportOptions& options) {
+    using GeometryState = AssetState<std::shared_ptr<MeshGeometry>>;
+
+    // Už nahraná geometrie - handle je hotový hned
+    if (auto geometry = ResourceManager::getInstance()->findMeshGeometry(path, options)) {
+        return AssetHandle<std::shared_ptr<MeshGeometry>>::resolved(geometry);
+    }
+
+    // Stejný mesh se právě načítá - sdílí se výsledek
+    std::string key = ResourceManager::meshKey(path, options);
+    auto pending = pending_meshes.find(key);
+    if (pending != pending_meshes.end()) {
+        return AssetHandle<std::shared_ptr<MeshGeometry>>(pending->second);
+    }
+
+    auto state = std::make_shared<GeometryState>();
+    auto data = std::make_shared<MeshImportData>();
+
+    auto job = std::make_shared<Job>();
+    job->name = path.filename().string();
+    job->cpu = [data, path, options]() {
+        ResourceManager::importMeshData(path, options, *data);
+        };
+    job->gpu = [this, data, state, path, options, key]() {
+        pending_meshes.erase(key);
+        state->value = ResourceManager::getInstance()->addMeshGeometry(path, options, *data);
+        state->ready = true;
+        };
+    job->fail = [this, state, key](const std::string& error) {
+        pending_meshes.erase(key);
+        state->error = error;
+        state->failed = true;
+        };
+
+    pending_meshes[key] = state;
+    enqueue(job);
+    return AssetHandle<std::shared_ptr<MeshGeometry>>(state);
+}
+
+AssetHandle<std::shared_ptr<Texture>> AssetLoader::loadTexture(const std::filesystem::path& path,
+    const TextureOptions& options) {
+    using TextureState = AssetState<std::shared_ptr<Texture>>;
+
+    if (auto texture = ResourceManager::getInstance()->findTexture(path, options)) {
+        return AssetHandle<std::shared_ptr<Texture>>::resolved(texture);
+    }
+
+    std::string key = ResourceManager::textureKey(path, options);
+    auto pending = pending_textures.find(key);
+    if (pending != pending_textures.end()) {
+        return AssetHandle<std::shared_ptr<Texture>>(pending->second);
+    }
+
+    auto state = std::make_shared<TextureState>();
+    auto data = std::make_shared<TextureImportData>();
+
+    auto job = std::make_shared<Job>();
+    job->name = path.filename().string();
+    job->cpu = [data, path, options]() {
+        ResourceManager::loadTextureData(path, options, *data);
+        };
+    job->gpu = [this, data, state, path, options, key]() {
+        pending_textures.erase(key);
+        state->value = ResourceManager::getInstance()->addTexture(path, options, *data);
+        state->ready = true;
+        };
+    job->fail = [this, state, key](const std::string& error) {
+        pending_textures.erase(key);
+        state->error = error;
+        state->failed = true;
+        };
+
+    pending_textures[key] = state;
+    enqueue(job);
+    return AssetHandle<std::shared_ptr<Texture>>(state);
+}
+
+std::vector<AssetHandle<std::shared_ptr<Texture>>> AssetLoader::loadTextures(const std::vector<TextureRequest>& requests) {
+    // Pořadí zařazení podle velikosti souboru (sestupně) - nejdelší dekódování začne nejdřív
+    std::vector<std::pair<uintmax_t, size_t>> order;
+    for (size_t i = 0; i < requests.size(); i++) {
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(requests[i].path, error);
+        order.emplace_back(error ? 0 : size, i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<AssetHandle<std::shared_ptr<Texture>>> handles(requests.size());
+    for (const auto& entry : order) {
+        const TextureRequest& request = requests[entry.second];
+        handles[entry.second] = loadTexture(request.path, request.options);
+    }
+    return handles;
+}
@@ -0,0 +1,174 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ResourceManager.hpp"
+
+// Stav asynchronního požadavku - zapisuje a čte se jen na GL (hlavním) vlákně
+template <typename T>
+struct AssetState {
+    bool ready{ false };
+    bool failed{ false };
+    T value{};
+    std::string error;
+};
+
+// Handle na výsledek načítání (obdoba std::future, ale bez blokování) - kontroluje se každý snímek
+template <typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<AssetState<T>> state) : state(std::move(state)) {}
+
+    // Handle na už existující hodnotu (asset byl v cache)
+    static AssetHandle resolved(T value) {
+        auto state = std::make_shared<AssetState<T>>();
+        state->value = std::move(value);
+        state->ready = true;
+        return AssetHandle(state);
+    }
+
+    bool valid() const { return state != nullptr; }
+    bool ready() const { return state && state->ready; }
+    bool failed() const { return state && state->failed; }
+    // Dokončeno (úspěšně nebo s chybou)
+    bool done() const { return ready() || failed(); }
+
+    // Výsledek - jen pro ready(), jinak výjimka s popisem chyby
+    const T& get() const {
+        if (!ready()) {
+            throw std::runtime_error(failed() ? state->error : std::string("Asset is not loaded yet"));
+        }
+        return state->value;
+    }
+
+    const std::string& error() const {
+        static const std::string none;
+        return state ? state->error : none;
+    }
+
+private:
+    std::shared_ptr<AssetState<T>> state;
+};
+
+// Jedna textura v dávce (AssetLoader::loadTextures)
+struct TextureRequest {
+    std::filesystem::path path;
+    TextureOptions options;
+};
+
+// Asynchronní načítání assetů. Každý požadavek má dvě části:
+//  - CPU část (čtení souborů, dekódování obrázků, parsování a zpracování meshů) běží na pracovních vláknech,
+//  - GL část (nahrání na GPU) běží na hlavním vlákně v update() s časovým limitem na snímek.
+class AssetLoader {
+private:
+    static AssetLoader* instance;
+
+    AssetLoader();
+
+    struct Job {
+        std::string name;
+        std::function<void()> cpu;
+        std::function<void()> gpu;
+        std::function<void(const std::string&)> fail;
+        std::string error; // chyba z CPU části - GL část se pak nespouští
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable upload_available;
+    std::deque<std::shared_ptr<Job>> cpu_queue; // chráněno mutexem
+    std::deque<std::shared_ptr<Job>> gpu_queue; // chráněno mutexem
+    bool stopping{ false };
+
+    // Statistiky (jen GL vlákno)
+    size_t submitted{ 0 };
+    size_t completed{ 0 };
+    size_t failures{ 0 };
+
+    // Rozpracované meshe a textury - opakovaný požadavek dostane stejný handle
+    std::unordered_map<std::string, std::shared_ptr<AssetState<std::shared_ptr<MeshGeometry>>>> pending_meshes;
+    std::unordered_map<std::string, std::shared_ptr<AssetState<std::shared_ptr<Texture>>>> pending_textures;
+
+    void enqueue(std::shared_ptr<Job> job);
+    void workerLoop();
+    void finishJob(Job& job);
+
+public:
+    static AssetLoader* getInstance();
+
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Obecný požadavek: cpu_stage naplní Data na pracovním vlákně (bez GL volání),
+    // gpu_stage z nich na GL vlákně vytvoří výsledek. Výjimky se uloží do handle.
+    template <typename Data, typename T>
+    AssetHandle<T> submit(const std::string& name, std::function<void(Data&)> cpu_stage,
+        std::function<T(Data&)> gpu_stage);
+
+    // Mesh přes ResourceManager (binární cache / OBJ import) - stejné volby sdílí jednu geometrii
+    AssetHandle<std::shared_ptr<MeshGeometry>> loadMesh(const std::filesystem::path& path,
+        const MeshImportOptions& options = MeshImportOptions());
+
+    // Textura přes ResourceManager (dekódování na pracovním vlákně) - stejná cesta a volby sdílí jednu texturu
+    AssetHandle<std::shared_ptr<Texture>> loadTexture(const std::filesystem::path& path,
+        const TextureOptions& options = TextureOptions());
+
+    // Dávka textur - dekódování a mipmapy běží paralelně na pracovních vláknech, největší soubory se
+    // zařadí první, aby se jejich dekódování překrývalo s nahráváním menších. Handly jsou v pořadí požadavků.
+    std::vector<AssetHandle<std::shared_ptr<Texture>>> loadTextures(const std::vector<TextureRequest>& requests);
+
+    // Zpracování hotových CPU částí - nahrává na GPU, dokud nevyprší budget_ms (alespoň jeden požadavek)
+    void update(double budget_ms);
+
+    // Dokončení všech požadavků (blokující - pro synchronní načítání)
+    void flush();
+
+    // Zastavení pracovních vláken (nedokončené požadavky se zahodí)
+    void shutdown();
+
+    size_t totalCount() const { return submitted; }
+    size_t completedCount() const { return completed; }
+    size_t failedCount() const { return failures; }
+    bool idle() const { return completed == submitted; }
+    float progress() const {
+        return submitted == 0 ? 1.0f : static_cast<float>(completed) / static_cast<float>(submitted);
+    }
+    size_t workerCount() const { return workers.size(); }
+};
+
+template <typename Data, typename T>
+AssetHandle<T> AssetLoader::submit(const std::string& name, std::function<void(Data&)> cpu_stage,
+    std::function<T(Data&)> gpu_stage) {
+    auto state = std::make_shared<AssetState<T>>();
+    auto data = std::make_shared<Data>();
+
+    auto job = std::make_shared<Job>();
+    job->name = name;
+    job->cpu = [data, cpu_stage]() {
+        cpu_stage(*data);
+        };
+    job->gpu = [data, state, gpu_stage]() {
+        state->value = gpu_stage(*data);
+        state->ready = true;
+        };
+    job->fail = [state](const std::string& error) {
+        state->error = error;
+        state->failed = true;
+        };
+
+    enqueue(job);
+    return AssetHandle<T>(state);
+}
@@ -13,9 +13,9 @@ public:
     glm::vec3 Right{ 1.0f, 0.0f, 0.0f };
 
     // Euler angles
-    float Yaw{ -90.0f };  // otoen kolem Y osy (vlevo/vpravo)
-    float Pitch{ 0.0f };  // otoen kolem X osy (nahoru/dol)
-    float Roll{ 0.0f };   // otoen kolem Z osy (nklon)
+    float Yaw{ -90.0f };  // otočení kolem Y osy (vlevo/vpravo)
+    float Pitch{ 0.0f };  // otočení kolem X osy (nahoru/dolů)
+    float Roll{ 0.0f };   // otočení kolem Z osy (náklon)
 
     // Parametry kamery
     float MovementSpeed{ 2.5f };
@@ -25,12 +25,12 @@ public:
         updateCameraVectors();
     }
 
-    // Zskn View matice
+    // Získání View matice
     glm::mat4 GetViewMatrix() const {
         return glm::lookAt(Position, Position + Front, Up);
     }
 
-    // Zpracovn vstupu z klvesnice
+    // Zpracování vstupu z klávesnice
     glm::vec3 ProcessKeyboard(GLFWwindow* window, float deltaTime) {
         glm::vec3 direction{ 0.0f };
 
@@ -47,14 +47,14 @@ public:
         if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
             direction -= Up;
 
-        // Normalizace vektoru smru, pokud nen nulov
+        // Normalizace vektoru směru, pokud není nulový
         if (glm::length(direction) > 0.0f)
             direction = glm::normalize(direction);
 
-        // Kontrola, zda je Shift stisknut, pro rychlej pohyb
+        // Kontrola, zda je Shift stisknutý, pro rychlejší pohyb
         float speed = MovementSpeed;
         if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-            speed *= 2.5f;  // 2.5x rychlej se Shiftem
+            speed *= 2.5f;  // 2.5x rychlejší se Shiftem
 
         return direction * speed * deltaTime;
     }
@@ -64,7 +64,7 @@ public:
         Position += offset;
     }
 
-    // Zpracovn pohybu myi
+    // Zpracování pohybu myši
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true) {
         xoffset *= MouseSensitivity;
         yoffset *= MouseSensitivity;
@@ -72,7 +72,7 @@ public:
         Yaw += xoffset;
         Pitch += yoffset;
 
-        // Omezen maximlnho otoen nahoru/dol
+        // Omezení maximálního otočení nahoru/dolů
         if (constrainPitch) {
             if (Pitch > 89.0f)
                 Pitch = 89.0f;
@@ -80,21 +80,21 @@ public:
                 Pitch = -89.0f;
         }
 
-        // Aktualizace vektor kamery
+        // Aktualizace vektorů kamery
         updateCameraVectors();
     }
 
 private:
-    // Vpoet vektor kamery z Euler hl
+    // Výpočet vektorů kamery z Euler úhlů
     void updateCameraVectors() {
-        // Vpoet forward vektoru
+        // Výpočet forward vektoru
         glm::vec3 front;
         front.x = cos(glm::radians(Yaw)) * cos(glm::radians(Pitch));
         front.y = sin(glm::radians(Pitch));
         front.z = sin(glm::radians(Yaw)) * cos(glm::radians(Pitch));
         Front = glm::normalize(front);
 
-        // Vpoet right a up vektor
+        // Výpočet right a up vektorů
         Right = glm::normalize(glm::cross(Front, glm::vec3(0.0f, 1.0f, 0.0f)));
         Up = glm::normalize(glm::cross(Right, Front));
     }
@@ -52,9 +52,8 @@ public:
     }
 
     // Nastavení všech uniforem pro světlo do shaderu
+    // (program nemusí být aktivní - ShaderProgram nastavuje uniformy přes DSA)
     void SetUniforms(ShaderProgram& shader) const {
-        shader.activate();
-
         shader.setUniform("dirLight.direction", _direction);
         shader.setUniform("dirLight.ambient", _ambient);
         shader.setUniform("dirLight.diffuse", _diffuse);
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <glm/glm.hpp>
+
+// Pohledový jehlan - 6 rovin z matice projection * view (Gribb-Hartmann), normály míří dovnitř
+// a jsou normalizované, takže dot(normála, bod) + w je vzdálenost bodu od roviny
+struct Frustum {
+    glm::vec4 planes[6]{};
+
+    Frustum() = default;
+
+    explicit Frustum(const glm::mat4& view_projection) {
+        // Sloupce transpozice = řádky matice
+        glm::mat4 m = glm::transpose(view_projection);
+        planes[0] = m[3] + m[0]; // levá
+        planes[1] = m[3] - m[0]; // pravá
+        planes[2] = m[3] + m[1]; // dolní
+        planes[3] = m[3] - m[1]; // horní
+        planes[4] = m[3] + m[2]; // blízká
+        planes[5] = m[3] - m[2]; // vzdálená
+        for (auto& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Konzervativní test kvádru - vrchol nejdál ve směru normály (p-vertex) musí být před každou rovinou
+    bool intersectsBox(const glm::vec3& box_min, const glm::vec3& box_max) const {
+        for (const auto& plane : planes) {
+            glm::vec3 p(plane.x > 0.0f ? box_max.x : box_min.x,
+                plane.y > 0.0f ? box_max.y : box_min.y,
+                plane.z > 0.0f ? box_max.z : box_min.z);
+            if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
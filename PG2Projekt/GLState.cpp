@@ -0,0 +1,46 @@
+﻿#include "GLState.hpp"
+
+GLState* GLState::instance = nullptr;
+
+GLState* GLState::getInstance() {
+    if (!instance) {
+        instance = new GLState();
+        instance->invalidate();
+    }
+    return instance;
+}
+
+void GLState::forgetTexture(GLuint texture) {
+    for (GLuint& bound : textures) {
+        if (bound == texture) {
+            bound = UNKNOWN;
+        }
+    }
+}
+
+void GLState::forgetVertexArray(GLuint id) {
+    if (vertex_array == id) {
+        vertex_array = UNKNOWN;
+    }
+}
+
+void GLState::forgetProgram(GLuint id) {
+    if (program == id) {
+        program = UNKNOWN;
+    }
+}
+
+void GLState::invalidate() {
+    program = UNKNOWN;
+    vertex_array = UNKNOWN;
+    for (GLuint& bound : textures) {
+        bound = UNKNOWN;
+    }
+    blend = depth_test = depth_mask = UNKNOWN_FLAG;
+    blend_src = blend_dst = UNKNOWN;
+}
+
+void GLState::endFrame() {
+    last_frame = current;
+    current = GLStateStats();
+}
@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <GL/glew.h>
+
+// Počty volání za snímek - vydaná do GL a přeskočená (beze změny stavu)
+struct GLStateStats {
+    uint32_t issued{ 0 };
+    uint32_t skipped{ 0 };
+};
+
+// Sledování GL stavu - program, VAO, textury na jednotkách, blending, depth test a zápis hloubky.
+// Volání, které stav nemění, se do GL vůbec nepošle. Veškeré nastavování těchto stavů musí jít přes
+// tuto třídu (jinak cache nesouhlasí s GL); kód mimo ni může stav zneplatnit přes invalidate().
+class GLState {
+private:
+    static GLState* instance;
+
+    GLState() = default;
+
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFFu; // stav zatím neznámý - první volání se vždy provede
+    static constexpr int MAX_TEXTURE_UNITS = 32;
+    static constexpr int UNKNOWN_FLAG = -1;
+
+    GLuint program{ UNKNOWN };
+    GLuint vertex_array{ UNKNOWN };
+    GLuint textures[MAX_TEXTURE_UNITS];
+    int blend{ UNKNOWN_FLAG };
+    int depth_test{ UNKNOWN_FLAG };
+    int depth_mask{ UNKNOWN_FLAG };
+    GLenum blend_src{ UNKNOWN };
+    GLenum blend_dst{ UNKNOWN };
+
+    GLStateStats current;
+    GLStateStats last_frame;
+
+    // true = volání se má provést (stav se liší), zároveň započítá statistiku
+    template <typename T>
+    bool change(T& cached, T value) {
+        if (cached == value) {
+            current.skipped++;
+            return false;
+        }
+        cached = value;
+        current.issued++;
+        return true;
+    }
+
+    static void setCapability(GLenum capability, bool enabled) {
+        if (enabled) glEnable(capability); else glDisable(capability);
+    }
+
+public:
+    static GLState* getInstance();
+
+    GLState(const GLState&) = delete;
+    GLState& operator=(const GLState&) = delete;
+
+    void useProgram(GLuint id) {
+        if (change(program, id)) glUseProgram(id);
+    }
+
+    void bindVertexArray(GLuint id) {
+        if (change(vertex_array, id)) glBindVertexArray(id);
+    }
+
+    void bindTextureUnit(GLuint unit, GLuint texture) {
+        if (unit >= static_cast<GLuint>(MAX_TEXTURE_UNITS)) {
+            glBindTextureUnit(unit, texture);
+            current.issued++;
+            return;
+        }
+        if (change(textures[unit], texture)) glBindTextureUnit(unit, texture);
+    }
+
+    void setBlend(bool enabled) {
+        if (change(blend, enabled ? 1 : 0)) setCapability(GL_BLEND, enabled);
+    }
+
+    void blendFunc(GLenum src, GLenum dst) {
+        if (blend_src == src && blend_dst == dst) {
+            current.skipped++;
+            return;
+        }
+        blend_src = src;
+        blend_dst = dst;
+        current.issued++;
+        glBlendFunc(src, dst);
+    }
+
+    void setDepthTest(bool enabled) {
+        if (change(depth_test, enabled ? 1 : 0)) setCapability(GL_DEPTH_TEST, enabled);
+    }
+
+    void setDepthMask(bool enabled) {
+        if (change(depth_mask, enabled ? 1 : 0)) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+
+    // Smazaný objekt - GL ho odváže (textury, VAO) a jméno může dostat nový objekt
+    void forgetTexture(GLuint texture);
+    void forgetVertexArray(GLuint id);
+    void forgetProgram(GLuint id);
+
+    // Stav změněný mimo tuto třídu - vše se nastaví znovu
+    void invalidate();
+
+    // Konec snímku - uloží počty za snímek a vynuluje je
+    void endFrame();
+    const GLStateStats& frameStats() const { return last_frame; }
+};
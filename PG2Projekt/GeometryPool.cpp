@@ -0,0 +1,280 @@
+﻿#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "GeometryPool.hpp"
+
+GeometryPool* GeometryPool::instance = nullptr;
+
+// --- FreeList ---
+
+void FreeList::reset(size_t capacity) {
+    blocks.clear();
+    if (capacity > 0) {
+        blocks[0] = capacity;
+    }
+}
+
+bool FreeList::allocate(size_t size, size_t& out_offset) {
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+        if (it->second >= size) {
+            out_offset = it->first;
+            size_t remaining = it->second - size;
+            blocks.erase(it);
+            if (remaining > 0) {
+                blocks[out_offset + size] = remaining;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void FreeList::release(size_t offset, size_t size) {
+    auto next = blocks.lower_bound(offset);
+
+    // Sloučení s následujícím blokem
+    if (next != blocks.end() && offset + size == next->first) {
+        size += next->second;
+        next = blocks.erase(next);
+    }
+    // Sloučení s předchozím blokem
+    if (next != blocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    blocks[offset] = size;
+}
+
+void FreeList::grow(size_t old_capacity, size_t new_capacity) {
+    release(old_capacity, new_capacity - old_capacity);
+}
+
+size_t FreeList::freeBytes() const {
+    size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block.second;
+    }
+    return total;
+}
+
+size_t FreeList::largestBlock() const {
+    size_t largest = 0;
+    for (const auto& block : blocks) {
+        largest = std::max(largest, block.second);
+    }
+    return largest;
+}
+
+// --- GeometryPool ---
+
+GeometryPool::GeometryPool() {
+    for (size_t f = 0; f < 2; f++) {
+        createArena(formats[f].vertices, INITIAL_VERTEX_CAPACITY);
+        glCreateVertexArrays(1, &formats[f].VAO);
+        setupVertexArray(static_cast<VertexFormat>(f));
+    }
+    createArena(indices, INITIAL_INDEX_CAPACITY);
+    attachBuffers();
+}
+
+GeometryPool::~GeometryPool() {
+    for (auto& format : formats) {
+        GLState::getInstance()->forgetVertexArray(format.VAO);
+        glDeleteVertexArrays(1, &format.VAO);
+        glDeleteBuffers(1, &format.vertices.buffer);
+    }
+    glDeleteBuffers(1, &indices.buffer);
+}
+
+GeometryPool* GeometryPool::getInstance() {
+    if (!instance) {
+        instance = new GeometryPool();
+    }
+    return instance;
+}
+
+void GeometryPool::createArena(Arena& arena, size_t capacity) {
+    glCreateBuffers(1, &arena.buffer);
+    // Immutable storage - data se dopisují přes glNamedBufferSubData / glCopyNamedBufferSubData
+    glNamedBufferStorage(arena.buffer, capacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    arena.capacity = capacity;
+    arena.free_list.reset(capacity);
+}
+
+void GeometryPool::growArena(Arena& arena, size_t required) {
+    // Nové místo na konci samo stačí na požadovaný blok
+    size_t new_capacity = std::max(arena.capacity * 2, arena.capacity + required);
+
+    // Immutable buffer nejde zvětšit - nový buffer a kopie obsahu na GPU
+    GLuint buffer = 0;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, new_capacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    glCopyNamedBufferSubData(arena.buffer, buffer, 0, 0, arena.capacity);
+    glDeleteBuffers(1, &arena.buffer);
+
+    std::cout << "GeometryPool: buffer grown " << arena.capacity / 1024 << " KB -> " << new_capacity / 1024 << " KB" << std::endl;
+    arena.buffer = buffer;
+    arena.free_list.grow(arena.capacity, new_capacity);
+    arena.capacity = new_capacity;
+    attachBuffers();
+}
+
+size_t GeometryPool::allocateIn(Arena& arena, size_t size) {
+    size_t offset = 0;
+    if (!arena.free_list.allocate(size, offset)) {
+        growArena(arena, size);
+        arena.free_list.allocate(size, offset);
+    }
+    arena.used += size;
+    arena.peak = std::max(arena.peak, arena.used);
+    return offset;
+}
+
+void GeometryPool::setupVertexArray(VertexFormat format) {
+    GLuint VAO = pool(format).VAO;
+    const bool quantized = format == VertexFormat::Quantized;
+
+    // Pozice vrcholu (kvantizovaná: unorm16 v rámci obalového kvádru)
+    glEnableVertexArrayAttrib(VAO, ATTRIB_POSITION);
+    if (quantized) {
+        glVertexArrayAttribFormat(VAO, ATTRIB_POSITION, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(packed_vertex, position));
+    }
+    else {
+        glVertexArrayAttribFormat(VAO, ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, offsetof(vertex, position));
+    }
+    glVertexArrayAttribBinding(VAO, ATTRIB_POSITION, 0);
+
+    // Normála vrcholu (kvantizovaná: oktaedrická 2x snorm16, shader ji dekóduje z aNorm.xy)
+    glEnableVertexArrayAttrib(VAO, ATTRIB_NORMAL);
+    if (quantized) {
+        glVertexArrayAttribFormat(VAO, ATTRIB_NORMAL, 2, GL_SHORT, GL_TRUE, offsetof(packed_vertex, normal));
+    }
+    else {
+        glVertexArrayAttribFormat(VAO, ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, offsetof(vertex, normal));
+    }
+    glVertexArrayAttribBinding(VAO, ATTRIB_NORMAL, 0);
+
+    // Texturové koordináty (kvantizované: half float)
+    glEnableVertexArrayAttrib(VAO, ATTRIB_TEXCOORD);
+    if (quantized) {
+        glVertexArrayAttribFormat(VAO, ATTRIB_TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(packed_vertex, texCoord));
+    }
+    else {
+        glVertexArrayAttribFormat(VAO, ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, offsetof(vertex, texCoord));
+    }
+    glVertexArrayAttribBinding(VAO, ATTRIB_TEXCOORD, 0);
+}
+
+void GeometryPool::attachBuffers() {
+    for (size_t f = 0; f < 2; f++) {
+        glVertexArrayVertexBuffer(formats[f].VAO, 0, formats[f].vertices.buffer, 0,
+            static_cast<GLsizei>(vertexStride(static_cast<VertexFormat>(f))));
+        glVertexArrayElementBuffer(formats[f].VAO, indices.buffer);
+    }
+}
+
+GeometryAllocation* GeometryPool::allocate(VertexFormat format, const void* vertex_data, size_t vertex_bytes,
+    const void* index_data, size_t index_bytes) {
+    GeometryAllocation* allocation = new GeometryAllocation();
+    allocation->format = format;
+
+    // Velikosti jsou násobky velikosti vrcholu, takže offsety zůstanou zarovnané pro base vertex;
+    // indexy se zarovnávají na 4 B (16bitové i 32bitové indexy v jednom bufferu)
+    allocation->vertex_bytes = vertex_bytes;
+    allocation->vertex_offset = allocateIn(pool(format).vertices, vertex_bytes);
+    allocation->index_bytes = (index_bytes + 3) & ~size_t(3);
+    allocation->index_offset = allocateIn(indices, allocation->index_bytes);
+
+    glNamedBufferSubData(pool(format).vertices.buffer, allocation->vertex_offset, vertex_bytes, vertex_data);
+    glNamedBufferSubData(indices.buffer, allocation->index_offset, index_bytes, index_data);
+
+    allocations.insert(allocation);
+    return allocation;
+}
+
+void GeometryPool::release(GeometryAllocation* allocation) {
+    if (!allocation || allocations.erase(allocation) == 0) {
+        return;
+    }
+
+    Arena& vertices = pool(allocation->format).vertices;
+    vertices.free_list.release(allocation->vertex_offset, allocation->vertex_bytes);
+    vertices.used -= allocation->vertex_bytes;
+    indices.free_list.release(allocation->index_offset, allocation->index_bytes);
+    indices.used -= allocation->index_bytes;
+
+    delete allocation;
+}
+
+void GeometryPool::defragment() {
+    // Živé alokace seřazené podle offsetu - kopírování do nového bufferu bez děr
+    auto compact = [this](Arena& arena, auto offset_of, auto size_of, auto belongs) {
+        std::vector<GeometryAllocation*> live;
+        for (auto* allocation : allocations) {
+            if (belongs(allocation)) {
+                live.push_back(allocation);
+            }
+        }
+        std::sort(live.begin(), live.end(),
+            [&](GeometryAllocation* a, GeometryAllocation* b) { return offset_of(a) < offset_of(b); });
+
+        GLuint buffer = 0;
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, arena.capacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+        size_t cursor = 0;
+        for (auto* allocation : live) {
+            glCopyNamedBufferSubData(arena.buffer, buffer, offset_of(allocation), cursor, size_of(allocation));
+            offset_of(allocation) = cursor;
+            cursor += size_of(allocation);
+        }
+
+        glDeleteBuffers(1, &arena.buffer);
+        arena.buffer = buffer;
+        arena.free_list.reset(arena.capacity);
+        size_t offset = 0;
+        if (cursor > 0) {
+            arena.free_list.allocate(cursor, offset);
+        }
+    };
+
+    size_t blocks_before = indices.free_list.blockCount();
+    for (size_t f = 0; f < 2; f++) {
+        blocks_before += formats[f].vertices.free_list.blockCount();
+        VertexFormat format = static_cast<VertexFormat>(f);
+        compact(formats[f].vertices,
+            [](GeometryAllocation* a) -> size_t& { return a->vertex_offset; },
+            [](GeometryAllocation* a) { return a->vertex_bytes; },
+            [format](GeometryAllocation* a) { return a->format == format; });
+    }
+    compact(indices,
+        [](GeometryAllocation* a) -> size_t& { return a->index_offset; },
+        [](GeometryAllocation* a) { return a->index_bytes; },
+        [](GeometryAllocation*) { return true; });
+    attachBuffers();
+
+    size_t blocks_after = indices.free_list.blockCount();
+    for (const auto& format : formats) {
+        blocks_after += format.vertices.free_list.blockCount();
+    }
+    std::cout << "GeometryPool: defragmented " << allocations.size() << " allocations, free blocks "
+        << blocks_before << " -> " << blocks_after << std::endl;
+}
+
+void GeometryPool::printStats() const {
+    auto print = [](const char* name, const Arena& arena) {
+        size_t free_bytes = arena.free_list.freeBytes();
+        float fragmentation = free_bytes > 0 ? 1.0f - static_cast<float>(arena.free_list.largestBlock()) / free_bytes : 0.0f;
+        std::cout << "  " << name << ": " << arena.used / 1024 << " / " << arena.capacity / 1024 << " KB used (peak "
+            << arena.peak / 1024 << " KB), " << arena.free_list.blockCount() << " free blocks, fragmentation "
+            << static_cast<int>(fragmentation * 100.0f) << "%" << std::endl;
+    };
+
+    std::cout << "GeometryPool: " << allocations.size() << " allocations" << std::endl;
+    print("vertices (float)", formats[0].vertices);
+    print("vertices (quantized)", formats[1].vertices);
+    print("indices", indices);
+}
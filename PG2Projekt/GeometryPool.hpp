@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <map>
+#include <unordered_set>
+#include <GL/glew.h>
+#include "GLState.hpp"
+#include "VertexFormat.hpp"
+
+// Umístění atributů vrcholu - musí odpovídat layout(location) ve vertex shaderech
+constexpr GLuint ATTRIB_POSITION = 0;
+constexpr GLuint ATTRIB_NORMAL = 1;
+constexpr GLuint ATTRIB_TEXCOORD = 2;
+
+// Úsek geometrie v mega-bufferu. Offsety se mohou změnit při defragmentaci nebo zvětšení
+// bufferu, proto se čtou vždy až při kreslení.
+struct GeometryAllocation {
+    VertexFormat format{ VertexFormat::Float };
+    size_t vertex_offset{ 0 }; // v bajtech ve vertex bufferu formátu
+    size_t vertex_bytes{ 0 };
+    size_t index_offset{ 0 };  // v bajtech ve sdíleném index bufferu
+    size_t index_bytes{ 0 };
+
+    // Base vertex pro glDrawElementsBaseVertex
+    GLint baseVertex() const {
+        return static_cast<GLint>(vertex_offset / vertexStride(format));
+    }
+};
+
+// Seznam volných bloků (offset -> velikost) se slučováním sousedních bloků
+class FreeList {
+public:
+    void reset(size_t capacity);
+    // First-fit alokace, vrací false, pokud se blok nevejde
+    bool allocate(size_t size, size_t& out_offset);
+    void release(size_t offset, size_t size);
+    // Přidání nového místa na konci (po zvětšení bufferu)
+    void grow(size_t old_capacity, size_t new_capacity);
+
+    size_t freeBytes() const;
+    size_t largestBlock() const;
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    std::map<size_t, size_t> blocks;
+};
+
+// Sdílené buffery pro veškerou statickou geometrii: jeden immutable vertex buffer a jeden VAO
+// pro každý formát vrcholů, jeden index buffer pro všechno. Meshe kreslí přes base vertex,
+// takže mezi nimi není potřeba přepínat VAO (a je možný multi-draw indirect).
+class GeometryPool {
+private:
+    static GeometryPool* instance;
+
+    GeometryPool();
+
+    // Jeden GL buffer s alokátorem
+    struct Arena {
+        GLuint buffer{ 0 };
+        size_t capacity{ 0 };
+        size_t used{ 0 };
+        size_t peak{ 0 };
+        FreeList free_list;
+    };
+
+    struct FormatPool {
+        GLuint VAO{ 0 };
+        Arena vertices;
+    };
+
+    FormatPool formats[2];
+    Arena indices;
+    std::unordered_set<GeometryAllocation*> allocations;
+
+    static constexpr size_t INITIAL_VERTEX_CAPACITY = 4 * 1024 * 1024;
+    static constexpr size_t INITIAL_INDEX_CAPACITY = 2 * 1024 * 1024;
+
+    FormatPool& pool(VertexFormat format) { return formats[static_cast<size_t>(format)]; }
+
+    void createArena(Arena& arena, size_t capacity);
+    void growArena(Arena& arena, size_t required);
+    size_t allocateIn(Arena& arena, size_t size);
+    void setupVertexArray(VertexFormat format);
+    void attachBuffers();
+
+public:
+    ~GeometryPool();
+
+    static GeometryPool* getInstance();
+
+    // Nahrání geometrie do sdílených bufferů
+    GeometryAllocation* allocate(VertexFormat format, const void* vertex_data, size_t vertex_bytes,
+        const void* index_data, size_t index_bytes);
+    void release(GeometryAllocation* allocation);
+
+    // VAO pro daný formát (obsahuje sdílený vertex i index buffer)
+    GLuint getVAO(VertexFormat format) { return pool(format).VAO; }
+    void bind(VertexFormat format) { GLState::getInstance()->bindVertexArray(pool(format).VAO); }
+
+    // Setřesení všech alokací na začátek bufferů (odstraní díry po uvolněných meshích)
+    void defragment();
+
+    // Výpis obsazenosti a fragmentace
+    void printStats() const;
+};
@@ -0,0 +1,258 @@
+﻿#include "GpuCuller.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+GpuCuller::GpuCuller() {
+    cull_program = ShaderProgram::compute("resources/shaders/cull.comp");
+    compact_program = ShaderProgram::compute("resources/shaders/cull.comp", { "COMPACT" });
+    object_count_uniform = cull_program.uniform<int>("uObjectCount");
+    draw_count_uniform = compact_program.uniform<int>("uDrawCount");
+    use_cells_uniform = cull_program.uniform<int>("uUseCells");
+}
+
+GpuCuller::~GpuCuller() {
+    deleteBuffers();
+    cull_program.clear();
+    compact_program.clear();
+}
+
+bool GpuCuller::supported() {
+    return GLEW_VERSION_4_3 || (GLEW_ARB_compute_shader && GLEW_ARB_multi_draw_indirect);
+}
+
+bool GpuCuller::indirectCountSupported() {
+    return GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters;
+}
+
+bool GpuCuller::add(Model* model, int texture_layer, GLuint cell) {
+    if (!model || model->meshes.size() != 1) {
+        return false;
+    }
+    const Mesh& mesh = model->meshes[0];
+    const std::shared_ptr<MeshGeometry>& geometry = mesh.geometry;
+    if (!geometry || !geometry->allocation || mesh.primitive_type != GL_TRIANGLES) {
+        return false;
+    }
+
+    // Jeden materiál, VAO a typ indexů pro celý multi-draw
+    if (prototype) {
+        const Mesh& first = prototype->meshes[0];
+        if (mesh.texture != first.texture || geometry->format != first.geometry->format ||
+            geometry->index_type != first.geometry->index_type) {
+            return false;
+        }
+    }
+    else {
+        prototype = model;
+    }
+
+    // Příkaz pro geometrii (různých meshů je málo - stačí lineární hledání)
+    size_t draw = 0;
+    while (draw < draws.size() && draws[draw].geometry != geometry) {
+        draw++;
+    }
+    if (draw == draws.size()) {
+        draws.push_back({ geometry, 0 });
+    }
+    draws[draw].instance_count++;
+
+    glm::mat4 model_matrix = model->getModelMatrix();
+    float max_scale = std::max(glm::length(glm::vec3(model_matrix[0])),
+        std::max(glm::length(glm::vec3(model_matrix[1])), glm::length(glm::vec3(model_matrix[2]))));
+
+    CullObject object;
+    // Kvantizované pozice (pozice = offset + aPos * scale) se dekódují rovnou model maticí
+    glm::mat4 decode = glm::translate(glm::mat4(1.0f), geometry->positionOffset()) *
+        glm::scale(glm::mat4(1.0f), geometry->positionScale());
+    object.instance.model = model_matrix * decode;
+    object.instance.normal = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model_matrix))));
+    object.instance.params = glm::ivec4(texture_layer, 0, 0, 0);
+    glm::vec3 center = glm::vec3(model_matrix * glm::vec4((geometry->bounds_min + geometry->bounds_max) * 0.5f, 1.0f));
+    object.sphere = glm::vec4(center, glm::length(geometry->bounds_max - geometry->bounds_min) * 0.5f * max_scale);
+    object.draw = glm::uvec4(static_cast<GLuint>(draw), cell, 0, 0);
+    objects.push_back(object);
+
+    built = false;
+    return true;
+}
+
+void GpuCuller::build() {
+    deleteBuffers();
+    commands.clear();
+    if (objects.empty()) {
+        return;
+    }
+
+    // Úseky instancí za sebou v pořadí příkazů
+    GLuint base_instance = 0;
+    for (const auto& draw : draws) {
+        DrawElementsIndirectCommand command{};
+        command.base_instance = base_instance;
+        commands.push_back(command);
+        base_instance += draw.instance_count;
+    }
+    refreshCommands();
+
+    size_t command_bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+    glCreateBuffers(1, &object_buffer);
+    glNamedBufferStorage(object_buffer, objects.size() * sizeof(CullObject), objects.data(), 0);
+    glCreateBuffers(1, &instance_buffer);
+    glNamedBufferStorage(instance_buffer, objects.size() * sizeof(InstanceData), nullptr, 0);
+    glCreateBuffers(1, &template_buffer);
+    glNamedBufferStorage(template_buffer, command_bytes, commands.data(), GL_DYNAMIC_STORAGE_BIT);
+    glCreateBuffers(1, &command_buffer);
+    glNamedBufferStorage(command_buffer, command_bytes, nullptr, 0);
+    if (indirectCountSupported()) {
+        glCreateBuffers(1, &indirect_buffer);
+        glNamedBufferStorage(indirect_buffer, command_bytes, nullptr, 0);
+        glCreateBuffers(1, &parameter_buffer);
+        glNamedBufferStorage(parameter_buffer, sizeof(GLuint), nullptr, 0);
+    }
+    glCreateBuffers(1, &cell_buffer);
+    uploadVisibleCells();
+    built = true;
+
+    std::cout << "GpuCuller: " << objects.size() << " objects in " << draws.size() << " indirect draws"
+        << (indirectCountSupported() ? "" : " (without indirect count)") << std::endl;
+}
+
+void GpuCuller::clear() {
+    deleteBuffers();
+    objects.clear();
+    draws.clear();
+    commands.clear();
+    prototype = nullptr;
+}
+
+void GpuCuller::deleteBuffers() {
+    GLuint buffers[] = { object_buffer, instance_buffer, template_buffer, command_buffer, indirect_buffer, parameter_buffer, cell_buffer };
+    glDeleteBuffers(7, buffers); // nulová jména se ignorují
+    object_buffer = instance_buffer = template_buffer = command_buffer = indirect_buffer = parameter_buffer = cell_buffer = 0;
+    built = false;
+}
+
+void GpuCuller::setVisibleCells(const std::vector<uint32_t>* words) {
+    use_cells = words != nullptr && !words->empty();
+    if (use_cells) {
+        visible_cells = *words;
+    }
+    uploadVisibleCells();
+}
+
+void GpuCuller::uploadVisibleCells() {
+    if (cell_buffer == 0 || !use_cells) {
+        return;
+    }
+    // Velikost se mění jen s mřížkou - glNamedBufferData buffer případně realokuje
+    glNamedBufferData(cell_buffer, visible_cells.size() * sizeof(uint32_t), visible_cells.data(), GL_DYNAMIC_DRAW);
+}
+
+void GpuCuller::refreshCommands() {
+    bool changed = false;
+    for (size_t i = 0; i < draws.size(); i++) {
+        const MeshGeometry& geometry = *draws[i].geometry;
+        const MeshLod& level = geometry.lods[0];
+
+        DrawElementsIndirectCommand& command = commands[i];
+        GLuint count = static_cast<GLuint>(level.index_count);
+        GLuint first_index = static_cast<GLuint>(geometry.allocation->index_offset / geometry.indexSize() + level.first_index);
+        GLint base_vertex = geometry.allocation->baseVertex();
+        if (command.count != count || command.first_index != first_index || command.base_vertex != base_vertex) {
+            command.count = count;
+            command.first_index = first_index;
+            command.base_vertex = base_vertex;
+            changed = true;
+        }
+    }
+    // Při build() se šablony nahrají s vytvořením bufferu
+    if (changed && template_buffer != 0) {
+        glNamedBufferSubData(template_buffer, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+    }
+}
+
+void GpuCuller::cull() {
+    if (objects.empty()) {
+        return;
+    }
+    if (!built) {
+        build();
+    }
+    refreshCommands();
+
+    // Příkazy s nulovým počtem instancí (a nulový počet příkazů)
+    size_t command_bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+    glCopyNamedBufferSubData(template_buffer, command_buffer, 0, 0, command_bytes);
+    if (parameter_buffer != 0) {
+        glClearNamedBufferData(parameter_buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // 1. Test obalových koulí, zápis viditelných instancí
+    cull_program.activate();
+    cull_program.set(object_count_uniform, static_cast<int>(objects.size()));
+    cull_program.set(use_cells_uniform, use_cells ? 1 : 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, InstanceBatch::INSTANCE_BINDING, instance_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, object_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, command_buffer);
+    if (use_cells) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CELL_BINDING, cell_buffer);
+    }
+    glDispatchCompute(static_cast<GLuint>((objects.size() + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+
+    // 2. Neprázdné příkazy na začátek a jejich počet
+    if (parameter_buffer != 0) {
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        compact_program.activate();
+        compact_program.set(draw_count_uniform, static_cast<int>(commands.size()));
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDIRECT_BINDING, indirect_buffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARAMETER_BINDING, parameter_buffer);
+        glDispatchCompute(static_cast<GLuint>((commands.size() + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE), 1, 1);
+    }
+
+    // Příkazy a instance čte až vykreslení
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCuller::draw(const ShaderProgram& program) {
+    if (!built || !program.ready()) {
+        return;
+    }
+
+    prototype->setShader(program);
+    program.activate();
+    const Mesh& mesh = prototype->meshes[0];
+    if (!mesh.bindForDraw()) {
+        return;
+    }
+
+    // Pozice jsou dekódované v model matici instancí - normály dekóduje shader dál podle uQuantized
+    if (uniforms_program != program.getID()) {
+        uniforms_program = program.getID();
+        pos_offset_uniform = program.uniform<glm::vec3>("uPosOffset");
+        pos_scale_uniform = program.uniform<glm::vec3>("uPosScale");
+    }
+    program.set(pos_offset_uniform, glm::vec3(0.0f));
+    program.set(pos_scale_uniform, glm::vec3(1.0f));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, InstanceBatch::INSTANCE_BINDING, instance_buffer);
+    GLenum index_type = mesh.geometry->index_type;
+    GLsizei max_draws = static_cast<GLsizei>(commands.size());
+
+    if (parameter_buffer == 0) {
+        // Bez počtu z bufferu - všechny příkazy, prázdné se nevykreslí
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, index_type, nullptr, max_draws, 0);
+        return;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+    glBindBuffer(GL_PARAMETER_BUFFER, parameter_buffer);
+    if (GLEW_VERSION_4_6) {
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, index_type, nullptr, 0, max_draws, 0);
+    }
+    else {
+        glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, index_type, nullptr, 0, max_draws, 0);
+    }
+}
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "InstanceBatch.hpp"
+#include "Model.hpp"
+#include "ShaderProgram.hpp"
+
+// Příkaz pro glMultiDrawElementsIndirect(Count) - pořadí a velikost dané specifikací GL
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand musí mít 5 x 4 bajty");
+
+// Objekt ke kontrole v cull.comp (layout std430) - data instance, obalová koule ve world space
+// (xyz střed, w poloměr) a index příkazu, do jehož úseku instancí se zapíše
+struct CullObject {
+    InstanceData instance;
+    glm::vec4 sphere;
+    glm::uvec4 draw; // x = index příkazu, y = buňka PVS (GpuCuller::NO_CELL = vždy), zw rezerva (zarovnání std430)
+};
+static_assert(sizeof(CullObject) == 176, "CullObject neodpovídá std430 v cull.comp");
+
+// Ořezání statických objektů pohledovým jehlanem na GPU. Compute shader otestuje obalové koule,
+// viditelné instance zapíše do SSBO (úsek podle meshe) a spočítá instance příkazů; druhý průchod
+// přesune neprázdné příkazy na začátek a zapíše jejich počet. Vykreslení je jeden
+// glMultiDrawElementsIndirectCount - procesor za snímek neprochází objekty, jen spustí dva dispatch.
+// Všechny objekty sdílí materiál a texturu (vrstva pole textur je v datech instance),
+// formát vrcholů a typ indexů; meshe se mohou lišit.
+class GpuCuller {
+public:
+    GpuCuller();
+    ~GpuCuller();
+
+    // Vlastní GL buffery - kopírování není povoleno
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    // Compute shadery a multi-draw indirect (GL 4.3)
+    static bool supported();
+    // Počet příkazů z bufferu (GL 4.6 nebo ARB_indirect_parameters); jinak se kreslí i prázdné příkazy
+    static bool indirectCountSupported();
+
+    static constexpr GLuint NO_CELL = 0xFFFFFFFFu;
+
+    // Přidání objektu; false = jiný materiál, formát vrcholů nebo typ indexů (nutno kreslit jinak).
+    // cell = buňka mřížky viditelnosti (MazePVS), objekt se vykreslí jen pokud je buňka viditelná.
+    bool add(Model* model, int texture_layer = -1, GLuint cell = NO_CELL);
+    // Nahrání objektů a příkazů po přidání všech objektů
+    void build();
+    void clear();
+
+    // Bitová množina viditelných buněk (bit i slova i / 32); nullptr = bez filtru buněk.
+    // Nahraje se jen při změně - volat při přechodu kamery do jiné buňky.
+    void setVisibleCells(const std::vector<uint32_t>* words);
+
+    // Ořezání pro aktuální kameru (SceneUniforms musí být nahrané) - jednou za snímek před draw()
+    void cull();
+    // Vykreslení viditelných instancí programem s definicí INSTANCED
+    void draw(const ShaderProgram& program);
+
+    size_t objectCount() const { return objects.size(); }
+    size_t drawCount() const { return draws.size(); }
+    Model* prototypeModel() const { return prototype; }
+
+private:
+    // Binding pointy SSBO - musí odpovídat cull.comp (0 je zároveň InstanceBuffer v directional.vert)
+    static constexpr GLuint OBJECT_BINDING = 1;
+    static constexpr GLuint COMMAND_BINDING = 2;
+    static constexpr GLuint INDIRECT_BINDING = 3;
+    static constexpr GLuint PARAMETER_BINDING = 4;
+    static constexpr GLuint CELL_BINDING = 5;
+    static constexpr GLuint WORKGROUP_SIZE = 64;
+
+    // Jeden příkaz = jedna geometrie s úsekem instancí
+    struct Draw {
+        std::shared_ptr<MeshGeometry> geometry;
+        GLuint instance_count{ 0 };
+    };
+
+    Model* prototype{ nullptr }; // materiál a textura pro všechny objekty
+    std::vector<Draw> draws;
+    std::vector<CullObject> objects;
+    std::vector<DrawElementsIndirectCommand> commands; // šablony s instance_count = 0
+
+    GLuint object_buffer{ 0 };
+    GLuint instance_buffer{ 0 };
+    GLuint template_buffer{ 0 };  // šablony příkazů, každý snímek se kopírují do command_buffer
+    GLuint command_buffer{ 0 };   // příkazy po ořezání (v pořadí meshů, i prázdné)
+    GLuint indirect_buffer{ 0 };  // neprázdné příkazy na začátku
+    GLuint parameter_buffer{ 0 }; // počet neprázdných příkazů
+    GLuint cell_buffer{ 0 };      // viditelné buňky (bity)
+    std::vector<uint32_t> visible_cells;
+    bool use_cells{ false };
+    bool built{ false };
+
+    ShaderProgram cull_program;
+    ShaderProgram compact_program;
+    Uniform<int> object_count_uniform;
+    Uniform<int> draw_count_uniform;
+    Uniform<int> use_cells_uniform;
+
+    // Dekódování kvantizovaných pozic je v model matici instance - uniformy meshe se přebijí identitou
+    GLuint uniforms_program{ 0 };
+    Uniform<glm::vec3> pos_offset_uniform;
+    Uniform<glm::vec3> pos_scale_uniform;
+
+    void deleteBuffers();
+    void uploadVisibleCells();
+    // Přepočet šablon z aktuálních alokací v GeometryPool (offsety se mění při defragmentaci)
+    void refreshCommands();
+};
@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "Model.hpp"
+#include "ShaderProgram.hpp"
+
+// Data jedné instance tak, jak je čte directional.vert (layout std430)
+struct InstanceData {
+    glm::mat4 model;   // Model matice
+    glm::mat4 normal;  // Normálová matice (mat3 uložená v mat4 kvůli zarovnání std430)
+    glm::ivec4 params; // x = vrstva pole textur (-1 = bez pole), yzw rezerva (zarovnání std430)
+};
+
+// Skupina objektů se stejným meshem a texturou - vykreslí se jedním glDrawElementsInstanced
+// (u pole textur může mít každá instance jinou vrstvu)
+class InstanceBatch {
+public:
+    // Binding point SSBO s daty instancí (musí odpovídat directional.vert)
+    static constexpr GLuint INSTANCE_BINDING = 0;
+
+    // prototype = model, jehož meshe (VAO, textura, materiál) se pro celou skupinu použijí
+    InstanceBatch(Model* prototype) : prototype(prototype) {
+        glCreateBuffers(1, &SSBO);
+    }
+
+    ~InstanceBatch() {
+        if (SSBO != 0) {
+            glDeleteBuffers(1, &SSBO);
+            SSBO = 0;
+        }
+    }
+
+    // Vlastní GL buffer - kopírování není povoleno
+    InstanceBatch(const InstanceBatch&) = delete;
+    InstanceBatch& operator=(const InstanceBatch&) = delete;
+
+    // Patří model do této skupiny? (stejný mesh a stejná textura)
+    bool matches(const Model* model) const {
+        return model->meshes.size() == prototype->meshes.size() &&
+            !model->meshes.empty() &&
+            model->meshes[0].geometry == prototype->meshes[0].geometry &&
+            model->meshes[0].texture == prototype->meshes[0].texture;
+    }
+
+    // Přidání instance - normálová matice se spočítá jen jednou zde
+    void add(const glm::mat4& model_matrix, int texture_layer = -1) {
+        InstanceData data;
+        data.model = model_matrix;
+        data.normal = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model_matrix))));
+        data.params = glm::ivec4(texture_layer, 0, 0, 0);
+        instances.push_back(data);
+        dirty = true;
+    }
+
+    // Varianta programu, kterou se skupina vykreslí (instancovaná, viz ShaderPermutations)
+    void setShader(const ShaderProgram& program) {
+        prototype->setShader(program);
+    }
+
+    void clear() {
+        instances.clear();
+        dirty = true;
+    }
+
+    size_t size() const { return instances.size(); }
+    Model* prototypeModel() const { return prototype; }
+
+    // Nahrání dat instancí do SSBO (jen pokud se od posledního nahrání změnila)
+    void upload() {
+        if (!dirty) {
+            return;
+        }
+        glNamedBufferData(SSBO, instances.size() * sizeof(InstanceData), instances.data(), GL_STATIC_DRAW);
+        dirty = false;
+    }
+
+    // Vykreslení všech instancí jedním draw callem na mesh
+    void draw() {
+        if (instances.empty() || !prototype->shader.ready()) {
+            return;
+        }
+
+        upload();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, SSBO);
+
+        prototype->shader.activate();
+        for (const auto& mesh : prototype->meshes) {
+            mesh.drawInstanced(static_cast<GLsizei>(instances.size()));
+        }
+    }
+
+private:
+    Model* prototype{ nullptr };
+    std::vector<InstanceData> instances;
+    GLuint SSBO{ 0 };
+    bool dirty{ true };
+};
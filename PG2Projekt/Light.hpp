@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include "ShaderProgram.hpp"
 
@@ -46,16 +48,30 @@ public:
     void SetQuadratic(float quadratic) { _quadratic = quadratic; }
 
     // Nastavení všech uniforem pro světlo do shaderu - upraveno pro index světla
+    // (program nemusí být aktivní - ShaderProgram nastavuje uniformy přes DSA)
     void SetUniforms(ShaderProgram& shader, int lightIndex) const {
-        shader.activate();
+        const UniformNames& names = GetUniformNames(lightIndex);
 
-        // Použití indexu pro nastavení správného světla v poli
-        std::string lightPrefix = "lights[" + std::to_string(lightIndex) + "]";
+        shader.setUniform(names.position, _position);
+        shader.setUniform(names.color, _color);
+        shader.setUniform(names.constant, _constant);
+        shader.setUniform(names.linear, _linear);
+        shader.setUniform(names.quadratic, _quadratic);
+    }
+
+private:
+    // Jména uniforem světla v poli "lights[i].*" - sestaví se jen jednou pro každý index
+    struct UniformNames {
+        std::string position, color, constant, linear, quadratic;
+    };
 
-        shader.setUniform(lightPrefix + ".position", _position);
-        shader.setUniform(lightPrefix + ".color", _color);
-        shader.setUniform(lightPrefix + ".constant", _constant);
-        shader.setUniform(lightPrefix + ".linear", _linear);
-        shader.setUniform(lightPrefix + ".quadratic", _quadratic);
+    static const UniformNames& GetUniformNames(int lightIndex) {
+        static std::vector<UniformNames> names;
+        while (static_cast<int>(names.size()) <= lightIndex) {
+            std::string prefix = "lights[" + std::to_string(names.size()) + "]";
+            names.push_back({ prefix + ".position", prefix + ".color", prefix + ".constant",
+                prefix + ".linear", prefix + ".quadratic" });
+        }
+        return names[lightIndex];
     }
 };
\ No newline at end of file
@@ -0,0 +1,121 @@
+﻿#include <utility>
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ptr = std::exchange(other.data_ptr, nullptr);
+        file_size = std::exchange(other.file_size, 0);
+        opened = std::exchange(other.opened, false);
+#ifdef _WIN32
+        file_handle = std::exchange(other.file_handle, nullptr);
+        mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+#ifdef _WIN32
+    // FILE_SHARE_DELETE - namapovaný soubor lze nahradit přejmenováním (přepis cache přes dočasný soubor)
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    file_size = static_cast<size_t>(size.QuadPart);
+    opened = true;
+
+    // Prázdný soubor nelze namapovat - je to ale platný (prázdný) soubor
+    if (file_size == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mapping_handle = mapping;
+
+    data_ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data_ptr) {
+        close();
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    file_size = static_cast<size_t>(st.st_size);
+    opened = true;
+
+    if (file_size > 0) {
+        void* ptr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            opened = false;
+            file_size = 0;
+            return false;
+        }
+        data_ptr = static_cast<const char*>(ptr);
+    }
+    // Mapování zůstává platné i po zavření deskriptoru
+    ::close(fd);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data_ptr) {
+        UnmapViewOfFile(data_ptr);
+    }
+    if (mapping_handle) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle));
+        mapping_handle = nullptr;
+    }
+    if (file_handle) {
+        CloseHandle(static_cast<HANDLE>(file_handle));
+        file_handle = nullptr;
+    }
+#else
+    if (data_ptr) {
+        munmap(const_cast<char*>(data_ptr), file_size);
+    }
+#endif
+    data_ptr = nullptr;
+    file_size = 0;
+    opened = false;
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// Soubor namapovaný do paměti (jen pro čtení) - data se nekopírují do vlastního bufferu,
+// OS je načítá po stránkách až při přístupu
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    // Vlastní systémové handly - kopírování není povoleno, přesun ano
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Namapování souboru - false, pokud se soubor nepodařilo otevřít
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return data_ptr; }
+    size_t size() const { return file_size; }
+
+private:
+    const char* data_ptr{ nullptr };
+    size_t file_size{ 0 };
+    bool opened{ false };
+#ifdef _WIN32
+    void* file_handle{ nullptr };
+    void* mapping_handle{ nullptr };
+#endif
+};
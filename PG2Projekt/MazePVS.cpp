@@ -0,0 +1,361 @@
+﻿#include "MazePVS.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+void MazePVS::clear() {
+    grid_width = grid_height = 0;
+    row_bytes = 0;
+    walls.clear();
+    data.clear();
+    offsets.clear();
+    cached_cell = NO_CELL;
+    cached_row.clear();
+}
+
+void MazePVS::build(int width, int height, const std::vector<uint8_t>& walls) {
+    auto start = std::chrono::steady_clock::now();
+    clear();
+    grid_width = width;
+    grid_height = height;
+    this->walls = walls;
+
+    const int cells = width * height;
+    row_bytes = static_cast<size_t>((cells + 31) / 32) * 4; // celá 32bitová slova (pro visibleFrom)
+
+    // Každé vlákno počítá celé řádky svých buněk do vlastního pracovního řádku a hned je komprimuje -
+    // nekomprimovaná matice (buňky^2 bitů) se nikdy nealokuje
+    std::vector<std::vector<uint8_t>> rows(cells);
+    std::atomic<int> next{ 0 };
+    std::atomic<size_t> visible_total{ 0 };
+    auto worker = [&]() {
+        Sweep sweep;
+        sweep.queued_stamp.assign(cells, 0);
+        sweep.row.assign(row_bytes, 0);
+        for (int from = next++; from < cells; from = next++) {
+            // Ze zdi se nedívá - prázdný řádek
+            if (!walls[from]) {
+                // Středy úseků délky 2 * EDGE_RADIUS pokrývajících celý obvod buňky
+                const glm::dvec2 corner(from % width, from / width);
+                for (int k = 0; k < EDGE_SAMPLES; k++) {
+                    double t = (k + 0.5) / EDGE_SAMPLES;
+                    castFrom(corner + glm::dvec2(t, 0.0), from, sweep);
+                    castFrom(corner + glm::dvec2(t, 1.0), from, sweep);
+                    castFrom(corner + glm::dvec2(0.0, t), from, sweep);
+                    castFrom(corner + glm::dvec2(1.0, t), from, sweep);
+                }
+            }
+
+            std::sort(sweep.touched.begin(), sweep.touched.end());
+            compressRow(sweep.row.data(), sweep.touched, row_bytes, rows[from]);
+            size_t visible = 0;
+            for (uint32_t index : sweep.touched) {
+                visible += std::bitset<8>(sweep.row[index]).count();
+                sweep.row[index] = 0;
+            }
+            sweep.touched.clear();
+            visible_total += visible;
+        }
+        };
+
+    unsigned int thread_count = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < thread_count; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Komprimované řádky za sebou
+    offsets.reserve(cells + 1);
+    for (const auto& row : rows) {
+        offsets.push_back(static_cast<uint32_t>(data.size()));
+        data.insert(data.end(), row.begin(), row.end());
+    }
+    offsets.push_back(static_cast<uint32_t>(data.size()));
+
+    int open_cells = static_cast<int>(std::count(walls.begin(), walls.end(), 0));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "MazePVS: " << width << "x" << height << " cells, "
+        << (open_cells > 0 ? static_cast<double>(visible_total) / open_cells : 0.0) << " visible per open cell, "
+        << data.size() << " B compressed (" << row_bytes * cells << " B raw), "
+        << elapsed.count() << " ms on " << thread_count << " threads" << std::endl;
+}
+
+int MazePVS::cellAt(float x, float z) const {
+    int cell_x = static_cast<int>(std::floor(x + 0.5f));
+    int cell_y = static_cast<int>(std::floor(z + 0.5f));
+    if (cell_x < 0 || cell_y < 0 || cell_x >= grid_width || cell_y >= grid_height) {
+        return NO_CELL;
+    }
+    return cell_y * grid_width + cell_x;
+}
+
+void MazePVS::castFrom(const glm::dvec2& point, int from, Sweep& sweep) const {
+    const int from_x = from % grid_width, from_y = from / grid_width;
+    const uint32_t stamp = ++sweep.stamp;
+    sweep.blocked.clear();
+    // Zdrojová buňka a sousedé, jejichž rozšíření do ní zasahuje (před ní nic nestojí)
+    for (int y = std::max(from_y - 1, 0); y <= std::min(from_y + 1, grid_height - 1); y++) {
+        for (int x = std::max(from_x - 1, 0); x <= std::min(from_x + 1, grid_width - 1); x++) {
+            sweep.mark(y * grid_width + x);
+        }
+    }
+
+    // Buňky podle manhattanské vzdálenosti od zdrojové buňky - paprsek z bodu ve zdrojové buňce
+    // prochází buňkami s neklesající vzdáleností, takže zakrýt buňku mohou jen zdi s menší vzdáleností
+    // a do buňky vstupuje přes viditelného souseda o krok blíž (ve směru x nebo y). Další vzdálenost
+    // tvoří jen tito následníci viditelných buněk. Zdi jsou zmenšené, paprsek tedy může projít
+    // i okrajem zdi - předchůdce nemusí být volný.
+    sweep.frontier.clear();
+    auto enqueue = [&](int x, int y) {
+        if (x >= 0 && y >= 0 && x < grid_width && y < grid_height) {
+            int cell = y * grid_width + x;
+            if (sweep.queued_stamp[cell] != stamp) {
+                sweep.queued_stamp[cell] = stamp;
+                sweep.next_frontier.push_back(cell);
+            }
+        }
+        };
+    auto enqueueSuccessors = [&](int x, int y) {
+        int dx = x - from_x, dy = y - from_y;
+        if (dx >= 0) enqueue(x + 1, y);
+        if (dx <= 0) enqueue(x - 1, y);
+        if (dy >= 0) enqueue(x, y + 1);
+        if (dy <= 0) enqueue(x, y - 1);
+        };
+    sweep.next_frontier.clear();
+    enqueueSuccessors(from_x, from_y);
+
+    while (!sweep.next_frontier.empty()) {
+        std::swap(sweep.frontier, sweep.next_frontier);
+        sweep.next_frontier.clear();
+        sweep.ring_walls.clear();
+        for (int cell : sweep.frontier) {
+            int x = cell % grid_width, y = cell / grid_width;
+            if (covered(sweep.blocked, boxInterval(point, glm::dvec2(x, y), glm::dvec2(x + 1, y + 1)))) {
+                continue;
+            }
+            sweep.mark(cell);
+            if (walls[cell]) {
+                sweep.ring_walls.push_back(wallInterval(point, x, y, true, true));
+            }
+            markNeighbours(point, x, y, sweep);
+            enqueueSuccessors(x, y);
+        }
+        for (const auto& interval : sweep.ring_walls) {
+            block(sweep.blocked, interval);
+        }
+    }
+}
+
+void MazePVS::markNeighbours(const glm::dvec2& point, int x, int y, Sweep& sweep) const {
+    // Část viditelné buňky (x, y) do EDGE_RADIUS od souseda patří do jeho rozšíření - je-li vidět,
+    // je vidět i soused (zakrýt ji mohou jen zdi bližší než buňka (x, y), tedy současné blocked)
+    // U zdi navíc zakrývá části za ní její zmenšený tvar: paprsek je v x i y monotónní, takže leží-li
+    // bod před tvarem v ose x a část za ním, protne paprsek tvar dřív. Pro osu x se bere jádro
+    // s pruhy ve směru y (nezasahují do x rozsahu částí) a naopak.
+    const double r = EDGE_RADIUS;
+    const bool wall = walls[y * grid_width + x] != 0;
+    bool behind_x_ready = false, behind_y_ready = false; // spočítají se až při potřebě
+    for (int oy = -1; oy <= 1; oy++) {
+        for (int ox = -1; ox <= 1; ox++) {
+            int nx = x + ox, ny = y + oy;
+            if ((ox == 0 && oy == 0) || nx < 0 || ny < 0 || nx >= grid_width || ny >= grid_height) {
+                continue;
+            }
+            int neighbour = ny * grid_width + nx;
+            if (sweep.marked(neighbour)) {
+                continue;
+            }
+            glm::dvec2 low(ox > 0 ? x + 1 - r : x, oy > 0 ? y + 1 - r : y);
+            glm::dvec2 high(ox < 0 ? x + r : x + 1, oy < 0 ? y + r : y + 1);
+            glm::dvec2 interval = boxInterval(point, low, high);
+            if (covered(sweep.blocked, interval)) {
+                continue;
+            }
+            if (wall && ((ox > 0 && point.x <= x + r) || (ox < 0 && point.x >= x + 1 - r))) {
+                if (!behind_x_ready) {
+                    sweep.behind_x = sweep.blocked;
+                    block(sweep.behind_x, wallInterval(point, x, y, false, true));
+                    behind_x_ready = true;
+                }
+                if (covered(sweep.behind_x, interval)) {
+                    continue;
+                }
+            }
+            if (wall && ((oy > 0 && point.y <= y + r) || (oy < 0 && point.y >= y + 1 - r))) {
+                if (!behind_y_ready) {
+                    sweep.behind_y = sweep.blocked;
+                    block(sweep.behind_y, wallInterval(point, x, y, true, false));
+                    behind_y_ready = true;
+                }
+                if (covered(sweep.behind_y, interval)) {
+                    continue;
+                }
+            }
+            sweep.mark(neighbour);
+        }
+    }
+}
+
+double MazePVS::pseudoAngle(const glm::dvec2& d) {
+    // "Diamantový" úhel v [0, 4) - roste monotónně se skutečným úhlem, bez atan2
+    if (d.y >= 0.0) {
+        return d.x >= 0.0 ? d.y / (d.x + d.y) : 1.0 - d.x / (d.y - d.x);
+    }
+    return d.x < 0.0 ? 2.0 - d.y / (-d.x - d.y) : 3.0 + d.x / (d.x - d.y);
+}
+
+glm::dvec2 MazePVS::pointsInterval(const glm::dvec2& point, const glm::dvec2& reference,
+    const glm::dvec2* corners, int count) {
+    // Úhly rohů relativně ke směru na referenční bod - souvislý tvar neobsahující bod,
+    // rozpětí je nejvýš polovina kruhu
+    double center = pseudoAngle(reference - point);
+    double low = 0.0, high = 0.0;
+    for (int i = 0; i < count; i++) {
+        double angle = pseudoAngle(corners[i] - point) - center;
+        if (angle > FULL_TURN / 2) angle -= FULL_TURN;
+        if (angle < -FULL_TURN / 2) angle += FULL_TURN;
+        low = std::min(low, angle);
+        high = std::max(high, angle);
+    }
+    double start = center + low;
+    double shift = std::floor(start / FULL_TURN) * FULL_TURN;
+    return glm::dvec2(start - shift, center + high - shift);
+}
+
+glm::dvec2 MazePVS::boxInterval(const glm::dvec2& point, const glm::dvec2& low, const glm::dvec2& high) {
+    const glm::dvec2 corners[4] = { low, glm::dvec2(high.x, low.y), glm::dvec2(low.x, high.y), high };
+    return pointsInterval(point, (low + high) * 0.5, corners, 4);
+}
+
+glm::dvec2 MazePVS::wallInterval(const glm::dvec2& point, int x, int y, bool bridges_x, bool bridges_y) const {
+    // Jádro zdi zmenšené o EDGE_RADIUS a pruhy k sousedním zdem až na hranu buňky - zmenšené
+    // sjednocení zdí, mezi sousedními zdmi nevznikne mezera
+    const double r = EDGE_RADIUS;
+    glm::dvec2 corners[20] = {
+        glm::dvec2(x + r, y + r), glm::dvec2(x + 1 - r, y + r), glm::dvec2(x + r, y + 1 - r), glm::dvec2(x + 1 - r, y + 1 - r)
+    };
+    int count = 4;
+    auto wall = [this](int wx, int wy) {
+        return wx >= 0 && wy >= 0 && wx < grid_width && wy < grid_height && walls[wy * grid_width + wx];
+        };
+    if (bridges_x && wall(x - 1, y)) { corners[count++] = glm::dvec2(x, y + r); corners[count++] = glm::dvec2(x, y + 1 - r); }
+    if (bridges_x && wall(x + 1, y)) { corners[count++] = glm::dvec2(x + 1, y + r); corners[count++] = glm::dvec2(x + 1, y + 1 - r); }
+    if (bridges_y && wall(x, y - 1)) { corners[count++] = glm::dvec2(x + r, y); corners[count++] = glm::dvec2(x + 1 - r, y); }
+    if (bridges_y && wall(x, y + 1)) { corners[count++] = glm::dvec2(x + r, y + 1); corners[count++] = glm::dvec2(x + 1 - r, y + 1); }
+    return pointsInterval(point, glm::dvec2(x + 0.5, y + 0.5), corners, count);
+}
+
+bool MazePVS::covered(const std::vector<glm::dvec2>& blocked, const glm::dvec2& interval) {
+    // Interval přes celou otáčku se zkontroluje po částech
+    if (interval.y > FULL_TURN) {
+        return covered(blocked, glm::dvec2(interval.x, FULL_TURN)) && covered(blocked, glm::dvec2(0.0, interval.y - FULL_TURN));
+    }
+    // Poslední blokovaný interval, který začíná před začátkem testovaného (bez tolerance - v pochybnosti viditelné)
+    auto next = std::upper_bound(blocked.begin(), blocked.end(), interval.x,
+        [](double value, const glm::dvec2& range) { return value < range.x; });
+    return next != blocked.begin() && (next - 1)->y >= interval.y;
+}
+
+void MazePVS::block(std::vector<glm::dvec2>& blocked, const glm::dvec2& interval) {
+    if (interval.y > FULL_TURN) {
+        block(blocked, glm::dvec2(interval.x, FULL_TURN));
+        block(blocked, glm::dvec2(0.0, interval.y - FULL_TURN));
+        return;
+    }
+    // Vložení se sloučením překrývajících se a dotýkajících se intervalů (zdi vedle sebe)
+    auto position = std::lower_bound(blocked.begin(), blocked.end(), interval.x,
+        [](const glm::dvec2& range, double value) { return range.x < value; });
+    position = blocked.insert(position, interval);
+    if (position != blocked.begin() && (position - 1)->y >= position->x - ANGLE_EPSILON) {
+        (position - 1)->y = std::max((position - 1)->y, position->y);
+        position = blocked.erase(position) - 1;
+    }
+    auto last = position + 1;
+    while (last != blocked.end() && last->x <= position->y + ANGLE_EPSILON) {
+        position->y = std::max(position->y, last->y);
+        last++;
+    }
+    blocked.erase(position + 1, last);
+}
+
+void MazePVS::compressRow(const uint8_t* row, const std::vector<uint32_t>& nonzero, size_t bytes,
+    std::vector<uint8_t>& out) {
+    // Nenulový bajt beze změny, běh nulových bajtů = 0 a délka (max 255)
+    auto zeros = [&out](size_t count) {
+        while (count > 0) {
+            size_t run = std::min<size_t>(count, 255);
+            out.push_back(0);
+            out.push_back(static_cast<uint8_t>(run));
+            count -= run;
+        }
+        };
+    size_t position = 0;
+    for (uint32_t index : nonzero) {
+        zeros(index - position);
+        out.push_back(row[index]);
+        position = index + 1;
+    }
+    zeros(bytes - position);
+}
+
+void MazePVS::decompressRow(const uint8_t* in, uint8_t* row, size_t bytes) {
+    for (size_t i = 0; i < bytes;) {
+        if (*in != 0) {
+            row[i++] = *in++;
+            continue;
+        }
+        uint8_t run = in[1];
+        in += 2;
+        std::memset(row + i, 0, run);
+        i += run;
+    }
+}
+
+const std::vector<uint32_t>& MazePVS::visibleFrom(int from) {
+    if (from != cached_cell) {
+        cached_cell = from;
+        std::vector<uint8_t> row(row_bytes);
+        decompressRow(&data[offsets[from]], row.data(), row_bytes);
+        // Bit i bajtu i / 8 = bit i slova i / 32 (little endian, stejně jako na GPU)
+        cached_row.resize(row_bytes / 4);
+        std::memcpy(cached_row.data(), row.data(), row_bytes);
+    }
+    return cached_row;
+}
+
+bool MazePVS::isVisible(int from, int to) {
+    const std::vector<uint32_t>& row = visibleFrom(from);
+    return (row[to >> 5] >> (to & 31)) & 1u;
+}
+
+bool MazePVS::isBoxVisible(int from, const glm::vec3& box_min, const glm::vec3& box_max, float wall_top) {
+    if (box_max.y > wall_top) {
+        return true;
+    }
+    int min_x = static_cast<int>(std::floor(box_min.x + 0.5f));
+    int min_y = static_cast<int>(std::floor(box_min.z + 0.5f));
+    int max_x = static_cast<int>(std::floor(box_max.x + 0.5f));
+    int max_y = static_cast<int>(std::floor(box_max.z + 0.5f));
+    if (min_x < 0 || min_y < 0 || max_x >= grid_width || max_y >= grid_height) {
+        return true;
+    }
+    for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+            if (isVisible(from, y * grid_width + x)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
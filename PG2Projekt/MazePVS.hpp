@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Potenciálně viditelná množina (PVS) pro bludiště na pravidelné mřížce. Buňka (x, y) je čtverec
+// se středem ve world (x, 0, y) o straně 1 (stejně jako kostky zdí), zdi jsou neprůhledné.
+// Pro každou volnou buňku se předpočítá (vícevláknově), které buňky mohou být vidět z kteréhokoli
+// jejího bodu. Hranice buňky se rozdělí na úseky; ze středu úseku se mřížka prochází podle vzdálenosti
+// a buňka je vidět, pokud její úhlový interval celý nezakrývají bližší zdi (vrhání paprsků do všech
+// směrů naráz). Aby výsledek platil pro celý úsek (poloměr r), zdi se zmenší a cílové buňky zvětší
+// o r - posun oka o r odpovídá posunu celé úsečky pohledu. Množina je tedy konzervativní
+// (nadmnožina skutečně viditelných buněk, až na zaokrouhlení při slučování intervalů sousedních zdí).
+// Výsledek je bitová množina komprimovaná RLE nulových bajtů.
+// Platí pro oko pod horní hranou zdí - nad nimi je vidět přes zdi a PVS se nepoužije.
+class MazePVS {
+public:
+    static constexpr int NO_CELL = -1;
+
+    // walls[y * width + x] != 0 = zeď
+    void build(int width, int height, const std::vector<uint8_t>& walls);
+    void clear();
+
+    bool empty() const { return offsets.empty(); }
+    int width() const { return grid_width; }
+    int height() const { return grid_height; }
+
+    // Buňka pod world pozicí (NO_CELL = mimo mřížku)
+    int cellAt(float x, float z) const;
+    bool isWall(int cell) const { return cell != NO_CELL && walls[cell] != 0; }
+
+    // Viditelné buňky z buňky from - bit i slova i / 32 (rozbalené, poslední buňka se drží v cache)
+    const std::vector<uint32_t>& visibleFrom(int from);
+    bool isVisible(int from, int to);
+    // Je objekt s world obalem vidět z buňky from? Objekt vyčnívající nad wall_top nebo mimo
+    // mřížku je vidět vždy (přes zdi); jinak stačí jedna viditelná buňka pod jeho obalem.
+    bool isBoxVisible(int from, const glm::vec3& box_min, const glm::vec3& box_max, float wall_top);
+
+    size_t compressedBytes() const { return data.size(); }
+
+private:
+    // Úseky na každé hraně buňky (stačí hranice - úsečka z vnitřního bodu do jiné buňky
+    // prochází hranicí zdrojové buňky); víc úseků = menší r a těsnější množina, delší výpočet
+    static constexpr int EDGE_SAMPLES = 8;
+    static constexpr double EDGE_RADIUS = 0.5 / EDGE_SAMPLES; // r - polovina délky úseku
+    // Tolerance slučování intervalů - štěrbina užší než zaokrouhlovací chyba mezi sousedními zdmi není průhled
+    static constexpr double ANGLE_EPSILON = 1e-9;
+    static constexpr double FULL_TURN = 4.0; // rozsah pseudoAngle
+
+    // Pracovní data jednoho vlákna pro průchod z bodu
+    struct Sweep {
+        std::vector<uint32_t> queued_stamp;  // buňka už je ve frontě pro aktuální bod, pokud == stamp
+        uint32_t stamp{ 0 };
+        std::vector<int> frontier;           // buňky zpracovávané vzdálenosti
+        std::vector<int> next_frontier;      // následníci jejích viditelných buněk
+        std::vector<glm::dvec2> blocked;     // sjednocení úhlových intervalů zdí (seřazené, disjunktní)
+        std::vector<glm::dvec2> ring_walls;  // intervaly zdí aktuální vzdálenosti (přidají se po ní)
+        std::vector<glm::dvec2> behind_x;    // blocked + tvar právě zpracované zdi pro části za ní v ose x
+        std::vector<glm::dvec2> behind_y;    // ... v ose y (markNeighbours)
+        std::vector<uint8_t> row;            // viditelné buňky zdrojové buňky (bity)
+        std::vector<uint32_t> touched;       // nenulové bajty row
+
+        bool marked(int cell) const { return (row[cell >> 3] >> (cell & 7)) & 1u; }
+        void mark(int cell) {
+            uint8_t& byte = row[cell >> 3];
+            if (byte == 0) {
+                touched.push_back(static_cast<uint32_t>(cell >> 3));
+            }
+            byte |= 1u << (cell & 7);
+        }
+    };
+
+    int grid_width{ 0 };
+    int grid_height{ 0 };
+    size_t row_bytes{ 0 };
+    std::vector<uint8_t> walls;
+    std::vector<uint8_t> data;      // komprimované řádky za sebou
+    std::vector<uint32_t> offsets;  // začátek řádku buňky v data (+ konec posledního)
+
+    int cached_cell{ NO_CELL };
+    std::vector<uint32_t> cached_row;
+
+    // Buňky viditelné z úseku se středem point (souřadnice mřížky, buňka x pokrývá [x, x + 1])
+    // na hranici buňky from -> sweep.row
+    void castFrom(const glm::dvec2& point, int from, Sweep& sweep) const;
+    // Sousedé viditelné buňky (x, y), jejichž rozšíření o r zasahuje do její viditelné části
+    void markNeighbours(const glm::dvec2& point, int x, int y, Sweep& sweep) const;
+    static double pseudoAngle(const glm::dvec2& direction);
+    // Úhlový interval souvislého tvaru s danými rohy (rozvinutý, začátek v [0, FULL_TURN));
+    // reference = bod tvaru, vůči kterému se úhly rozvinou
+    static glm::dvec2 pointsInterval(const glm::dvec2& point, const glm::dvec2& reference,
+        const glm::dvec2* corners, int count);
+    static glm::dvec2 boxInterval(const glm::dvec2& point, const glm::dvec2& low, const glm::dvec2& high);
+    // Interval zmenšené zdi (x, y) s pruhy k sousedním zdem ve směru x a/nebo y
+    glm::dvec2 wallInterval(const glm::dvec2& point, int x, int y, bool bridges_x, bool bridges_y) const;
+    static bool covered(const std::vector<glm::dvec2>& blocked, const glm::dvec2& interval);
+    static void block(std::vector<glm::dvec2>& blocked, const glm::dvec2& interval);
+
+    // RLE nulových bajtů; nonzero = seřazené indexy nenulových bajtů (ostatní jsou nulové)
+    static void compressRow(const uint8_t* row, const std::vector<uint32_t>& nonzero, size_t bytes,
+        std::vector<uint8_t>& out);
+    static void decompressRow(const uint8_t* in, uint8_t* row, size_t bytes);
+};
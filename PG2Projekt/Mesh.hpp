@@ -1,23 +1,188 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <glm/glm.hpp> 
 #include <glm/ext.hpp>
 #include "assets.hpp"
 #include "ShaderProgram.hpp"
+#include "VertexFormat.hpp"
+#include "GeometryPool.hpp"
+#include "Texture.hpp"
+
+// Jedna úroveň detailu - souvislý úsek v index bufferu geometrie
+struct MeshLod {
+    size_t first_index{ 0 };
+    size_t index_count{ 0 };
+    float error{ 0.0f }; // horní odhad geometrické chyby oproti plnému rozlišení (jednotky meshe)
+};
+
+// Geometrie meshe na GPU - úsek ve sdílených bufferech GeometryPool, sdílená přes std::shared_ptr,
+// takže více meshů se stejnými daty (např. kostky bludiště) má jednu alokaci.
+// Data vrcholů a indexů se po nahrání na CPU nedrží.
+struct MeshGeometry {
+    size_t vertex_count{ 0 };
+    size_t index_count{ 0 };
+    // Formát vrcholů (plné floaty nebo kvantizovaný packed_vertex) - určuje sdílený VAO
+    VertexFormat format{ VertexFormat::Float };
+    // Typ indexů na GPU - 16bitové, pokud se všechny indexy vejdou
+    GLenum index_type{ GL_UNSIGNED_INT };
+    // Obalový kvádr v lokálních souřadnicích
+    glm::vec3 bounds_min{ 0.0f };
+    glm::vec3 bounds_max{ 0.0f };
+    // Obalová koule v lokálních souřadnicích (střed obalového kvádru)
+    glm::vec3 sphere_center{ 0.0f };
+    float sphere_radius{ 0.0f };
+    // Úrovně detailu (LOD 0 = plné rozlišení); všechny sdílí vrcholy, liší se úsekem indexů
+    std::vector<MeshLod> lods;
+
+    // Umístění v mega-bufferu (offsety se mohou změnit při defragmentaci)
+    GeometryAllocation* allocation{ nullptr };
+
+    // lods = úseky v indices; prázdné = jediná úroveň přes všechny indexy
+    MeshGeometry(std::vector<vertex> const& vertices, std::vector<GLuint> const& indices,
+        std::vector<MeshLod> const& lods = {}, VertexFormat format = VertexFormat::Float) :
+        vertex_count(vertices.size()),
+        index_count(indices.size()),
+        format(format),
+        index_type(indexTypeFor(vertices.size())),
+        lods(lods)
+    {
+        computeBounds(vertices, bounds_min, bounds_max);
+        sphere_center = (bounds_min + bounds_max) * 0.5f;
+        sphere_radius = computeSphereRadius(vertices, sphere_center);
+        if (this->lods.empty()) {
+            this->lods.push_back({ 0, index_count, 0.0f });
+        }
+
+        // Kvantizace vrcholů do obalového kvádru
+        std::vector<packed_vertex> packed;
+        const void* vertex_data = vertices.data();
+        if (format == VertexFormat::Quantized) {
+            packed = packVertices(vertices, bounds_min, bounds_max);
+            vertex_data = packed.data();
+        }
+
+        // 16bitové indexy, pokud to počet vrcholů dovolí
+        if (index_type == GL_UNSIGNED_SHORT) {
+            std::vector<GLushort> short_indices(indices.begin(), indices.end());
+            upload(vertex_data, short_indices.data());
+        }
+        else {
+            upload(vertex_data, indices.data());
+        }
+    }
+
+    // Geometrie z již připravených dat (např. namapovaná binární cache) - žádná práce po vrcholech,
+    // vrcholy musí být ve formátu format a indexy v typu index_type
+    MeshGeometry(VertexFormat format, const void* vertex_data, size_t vertex_count,
+        const void* index_data, size_t index_count, GLenum index_type,
+        glm::vec3 const& bounds_min, glm::vec3 const& bounds_max, std::vector<MeshLod> const& lods = {}) :
+        vertex_count(vertex_count),
+        index_count(index_count),
+        format(format),
+        index_type(index_type),
+        bounds_min(bounds_min),
+        bounds_max(bounds_max),
+        lods(lods)
+    {
+        // Bez průchodu vrcholy - koule opsaná obalovému kvádru
+        sphere_center = (bounds_min + bounds_max) * 0.5f;
+        sphere_radius = glm::length(bounds_max - bounds_min) * 0.5f;
+        if (this->lods.empty()) {
+            this->lods.push_back({ 0, index_count, 0.0f });
+        }
+        upload(vertex_data, index_data);
+    }
+
+    // Uvolnění místa v mega-bufferu, když geometrii už nikdo nepoužívá
+    ~MeshGeometry() {
+        GeometryPool::getInstance()->release(allocation);
+        allocation = nullptr;
+    }
+
+    // Vlastní alokaci - kopírování není povoleno
+    MeshGeometry(const MeshGeometry&) = delete;
+    MeshGeometry& operator=(const MeshGeometry&) = delete;
+
+    // Velikost dat na GPU v bajtech
+    size_t gpuBytes() const {
+        return vertex_count * vertexStride(format) + index_count * indexSize();
+    }
+
+    // Velikost jednoho indexu v bajtech
+    size_t indexSize() const {
+        return index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    }
+
+    // Offset první položky dané úrovně detailu ve sdíleném index bufferu (pro glDraw*)
+    const void* indexOffset(const MeshLod& level) const {
+        return reinterpret_cast<const void*>(allocation->index_offset + level.first_index * indexSize());
+    }
+
+    // Dekódování kvantizovaných pozic v shaderu: pozice = uPosOffset + aPos * uPosScale
+    glm::vec3 positionOffset() const {
+        return format == VertexFormat::Quantized ? bounds_min : glm::vec3(0.0f);
+    }
+    glm::vec3 positionScale() const {
+        return format == VertexFormat::Quantized ? bounds_max - bounds_min : glm::vec3(1.0f);
+    }
+
+    // Nejmenší typ indexů, do kterého se vejdou indexy pro daný počet vrcholů
+    static GLenum indexTypeFor(size_t vertex_count) {
+        return vertex_count <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    static void computeBounds(std::vector<vertex> const& vertices, glm::vec3& out_min, glm::vec3& out_max) {
+        if (vertices.empty()) {
+            out_min = out_max = glm::vec3(0.0f);
+            return;
+        }
+        out_min = out_max = vertices[0].position;
+        for (const auto& v : vertices) {
+            out_min = glm::min(out_min, v.position);
+            out_max = glm::max(out_max, v.position);
+        }
+    }
+
+    // Poloměr koule se středem center, která obsahuje všechny vrcholy (těsnější než opsaná kvádru)
+    static float computeSphereRadius(std::vector<vertex> const& vertices, glm::vec3 const& center) {
+        float radius_squared = 0.0f;
+        for (const auto& v : vertices) {
+            glm::vec3 d = v.position - center;
+            radius_squared = std::max(radius_squared, glm::dot(d, d));
+        }
+        return std::sqrt(radius_squared);
+    }
+
+private:
+    // Nahrání do sdílených bufferů (atributy nastavuje sdílený VAO formátu v GeometryPool)
+    void upload(const void* vertex_data, const void* index_data) {
+        allocation = GeometryPool::getInstance()->allocate(format,
+            vertex_data, vertex_count * vertexStride(format),
+            index_data, index_count * indexSize());
+    }
+};
 
 class Mesh {
 public:
-    // mesh data
-    std::vector<vertex> vertices;
-    std::vector<GLuint> indices;
+    // mesh data (sdílená geometrie)
+    std::shared_ptr<MeshGeometry> geometry;
     glm::vec3 origin{};
     glm::vec3 orientation{};
-    GLuint texture_id{ 0 }; // texture id=0  means no texture
+    std::shared_ptr<Texture> texture; // nullptr = bez textury; sdílená (viz ResourceManager)
+    int texture_layer{ -1 }; // >= 0: texture je GL_TEXTURE_2D_ARRAY a mesh používá tuto vrstvu
     GLenum primitive_type = GL_POINT;
     ShaderProgram shader;
 
+    // Aktuální úroveň detailu (viz Model::selectLod) a plynulý přechod z předchozí
+    size_t lod{ 0 };
+    size_t previous_lod{ 0 };
+    float lod_fade{ 1.0f }; // 1 = přechod dokončen
+
     // mesh material
     glm::vec4 ambient_material{ 1.0f }; //white, non-transparent 
     glm::vec4 diffuse_material{ 1.0f }; //white, non-transparent 
@@ -27,120 +192,164 @@ public:
     // indirect (indexed) draw 
     Mesh(GLenum primitive_type, ShaderProgram shader, std::vector<vertex> const& vertices,
         std::vector<GLuint> const& indices, glm::vec3 const& origin,
-        glm::vec3 const& orientation, GLuint const texture_id = 0) :
+        glm::vec3 const& orientation, std::shared_ptr<Texture> texture = nullptr) :
+        Mesh(primitive_type, shader, std::make_shared<MeshGeometry>(vertices, indices),
+            origin, orientation, std::move(texture))
+    {
+    }
+
+    // Mesh nad již existující (sdílenou) geometrií
+    Mesh(GLenum primitive_type, ShaderProgram shader, std::shared_ptr<MeshGeometry> geometry,
+        glm::vec3 const& origin, glm::vec3 const& orientation, std::shared_ptr<Texture> texture = nullptr) :
         primitive_type(primitive_type),
         shader(shader),
-        vertices(vertices),
-        indices(indices),
+        geometry(std::move(geometry)),
         origin(origin),
         orientation(orientation),
-        texture_id(texture_id)
+        texture(std::move(texture))
     {
-        // Vytvoen VAO
-        glCreateVertexArrays(1, &VAO);
-
-        // Vytvoen VBO a nahrn dat vrchol
-        glCreateBuffers(1, &VBO);
-        glNamedBufferData(VBO, vertices.size() * sizeof(vertex), vertices.data(), GL_STATIC_DRAW);
-
-        // Vytvoen EBO a nahrn index
-        glCreateBuffers(1, &EBO);
-        glNamedBufferData(EBO, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
-        // Nastaven atribut
-        // Pozice vrcholu
-        GLint position_attrib_location = glGetAttribLocation(shader.getID(), "aPos");
-        if (position_attrib_location >= 0) {
-            glEnableVertexArrayAttrib(VAO, position_attrib_location);
-            glVertexArrayAttribFormat(VAO, position_attrib_location, 3, GL_FLOAT, GL_FALSE,
-                offsetof(vertex, position));
-            glVertexArrayAttribBinding(VAO, position_attrib_location, 0);
-        }
-
-        // Normla vrcholu
-        GLint normal_attrib_location = glGetAttribLocation(shader.getID(), "aNorm");
-        if (normal_attrib_location >= 0) {
-            glEnableVertexArrayAttrib(VAO, normal_attrib_location);
-            glVertexArrayAttribFormat(VAO, normal_attrib_location, 3, GL_FLOAT, GL_FALSE,
-                offsetof(vertex, normal));
-            glVertexArrayAttribBinding(VAO, normal_attrib_location, 0);
-        }
+    }
 
-        // Texturov koordinty
-        GLint tex_attrib_location = glGetAttribLocation(shader.getID(), "aTex");
-        if (tex_attrib_location >= 0) {
-            glEnableVertexArrayAttrib(VAO, tex_attrib_location);
-            glVertexArrayAttribFormat(VAO, tex_attrib_location, 2, GL_FLOAT, GL_FALSE,
-                offsetof(vertex, texCoord));
-            glVertexArrayAttribBinding(VAO, tex_attrib_location, 0);
+    // Výměna programu (jiná varianta, viz ShaderPermutations) - handly uniforem se zjistí znovu při vykreslení
+    void setShader(const ShaderProgram& program) {
+        if (shader.getID() != program.getID()) {
+            shader = program;
         }
-
-        // Propojen VAO s VBO a EBO
-        glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(vertex));
-        glVertexArrayElementBuffer(VAO, EBO);
     }
 
-    // Metoda draw s vchozmi hodnotami pro argumenty
+    // Metoda draw s výchozími hodnotami pro argumenty
     void draw(glm::vec3 const& offset = glm::vec3(0.0f), glm::vec3 const& rotation = glm::vec3(0.0f)) const {
-        if (VAO == 0) {
-            std::cerr << "VAO not initialized!\n";
+        if (!geometry || !geometry->allocation) {
+            std::cerr << "Geometry not initialized!\n";
+            return;
+        }
+        // Program se ještě sestavuje - vykreslení se přeskočí
+        if (!shader.ready()) {
             return;
         }
 
-        // Aktivace textury, pokud existuje
-        if (texture_id != 0) {
-            // Nastaven textury na jednotku 0
-            glBindTextureUnit(0, texture_id);
+        bindMaterial();
 
-            // Pedn sla texturov jednotky do shaderu
-            GLint tex_loc = glGetUniformLocation(shader.getID(), "tex0");
-            if (tex_loc >= 0) {
-                glUniform1i(tex_loc, 0);
-            }
+        // Vykreslení meshe - při přechodu mezi LOD obě úrovně s doplňkovým ditheringem
+        // (sdílený VAO formátu - stejný pro všechny meshe, bez unbindu)
+        GeometryPool::getInstance()->bind(geometry->format);
+        if (lod_fade < 1.0f && previous_lod != lod) {
+            setLodFade(lod_fade - 1.0f);
+            drawLod(previous_lod);
         }
+        setLodFade(lod_fade);
+        drawLod(lod);
+    }
 
-        // Nastaven diffuse_material do shaderu
-        GLint diffuse_color_loc = glGetUniformLocation(shader.getID(), "u_diffuse_color");
-        if (diffuse_color_loc >= 0) {
-            glUniform4fv(diffuse_color_loc, 1, glm::value_ptr(diffuse_material));
+    // Instancované vykreslení - matice jednotlivých instancí si shader čte sám (SSBO)
+    void drawInstanced(GLsizei instance_count) const {
+        if (!geometry || !geometry->allocation) {
+            std::cerr << "Geometry not initialized!\n";
+            return;
+        }
+        if (instance_count <= 0 || !shader.ready()) {
+            return;
         }
 
-        // Vykreslen meshe
-        glBindVertexArray(VAO);
-        glDrawElements(primitive_type, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0); // Unbind VAO
+        bindMaterial();
+
+        GeometryPool::getInstance()->bind(geometry->format);
+        const MeshLod& level = geometry->lods[0];
+        glDrawElementsInstancedBaseVertex(primitive_type, static_cast<GLsizei>(level.index_count), geometry->index_type,
+            geometry->indexOffset(level), instance_count, geometry->allocation->baseVertex());
     }
 
-    void clear(void) {
-        // Uvolnn textury
-        if (texture_id != 0) {
-            glDeleteTextures(1, &texture_id);
-            texture_id = 0;
+    // Příprava na vykreslení jinou cestou (multi-draw indirect, viz GpuCuller) - materiál, textura
+    // a sdílený VAO formátu; false = geometrie nebo program ještě nejsou k dispozici
+    bool bindForDraw() const {
+        if (!geometry || !geometry->allocation || !shader.ready()) {
+            return false;
         }
+        bindMaterial();
+        GeometryPool::getInstance()->bind(geometry->format);
+        return true;
+    }
 
+    void clear(void) {
+        // Uvolnění textury - GL objekt se smaže, až ji nepoužívá žádný mesh (může být sdílená)
+        texture.reset();
+        texture_layer = -1;
         primitive_type = GL_POINT;
-        vertices.clear();
-        indices.clear();
         origin = glm::vec3(0.0f);
         orientation = glm::vec3(0.0f);
 
-        // Uvolnn OpenGL objekt
-        if (VAO != 0) {
-            glDeleteVertexArrays(1, &VAO);
-            VAO = 0;
+        // Uvolnění geometrie - místo v mega-bufferu se uvolní, až ji nepoužívá žádný mesh
+        geometry.reset();
+    }
+
+private:
+    // Uniformy materiálu - handly se zjistí jednou, jakmile je program sestavený (ve shaderu nemusí všechny existovat)
+    struct MaterialUniforms {
+        Uniform<int> tex0, tex_array, tex_layer, use_tex_array, quantized;
+        Uniform<glm::vec4> diffuse_color;
+        Uniform<glm::vec3> pos_offset, pos_scale;
+        Uniform<float> lod_fade;
+    };
+    mutable MaterialUniforms uniforms;
+    mutable GLuint uniforms_program{ 0 }; // program, pro který platí handly (0 = zatím nezjištěné)
+
+    void resolveUniforms() const {
+        uniforms_program = shader.getID();
+        uniforms.tex0 = shader.uniform<int>("tex0");
+        uniforms.tex_array = shader.uniform<int>("texArray");
+        uniforms.tex_layer = shader.uniform<int>("uTexLayer");
+        uniforms.use_tex_array = shader.uniform<int>("uUseTexArray");
+        uniforms.quantized = shader.uniform<int>("uQuantized");
+        uniforms.diffuse_color = shader.uniform<glm::vec4>("u_diffuse_color");
+        uniforms.pos_offset = shader.uniform<glm::vec3>("uPosOffset");
+        uniforms.pos_scale = shader.uniform<glm::vec3>("uPosScale");
+        uniforms.lod_fade = shader.uniform<float>("uLodFade");
+    }
+
+    // Vykreslení jedné úrovně detailu (VAO musí být navázané)
+    void drawLod(size_t level_index) const {
+        const MeshLod& level = geometry->lods[std::min(level_index, geometry->lods.size() - 1)];
+        glDrawElementsBaseVertex(primitive_type, static_cast<GLsizei>(level.index_count), geometry->index_type,
+            geometry->indexOffset(level), geometry->allocation->baseVertex());
+    }
+
+    // Dithered cross-fade v directional.frag: kladná hodnota = fragment zůstane, je-li práh < fade,
+    // záporná = doplněk (zůstanou fragmenty, které nová úroveň zahodí), 1 = bez ditheringu
+    void setLodFade(float fade) const {
+        shader.set(uniforms.lod_fade, fade);
+    }
+
+    // Nastavení textury, materiálu a dekódování formátu vrcholů do shaderu (společné pro draw i drawInstanced)
+    void bindMaterial() const {
+        if (uniforms_program != shader.getID()) {
+            resolveUniforms();
+        }
+
+        // Aktivace textury, pokud existuje
+        bool texture_array = texture && texture_layer >= 0;
+        if (texture_array) {
+            // Pole textur na jednotce 1 (vrstvu u instancí určují data instance)
+            GLState::getInstance()->bindTextureUnit(1, texture->id);
+            shader.set(uniforms.tex_array, 1);
+            shader.set(uniforms.tex_layer, texture_layer);
         }
-        if (VBO != 0) {
-            glDeleteBuffers(1, &VBO);
-            VBO = 0;
+        else if (texture) {
+            // Nastavení textury na jednotku 0
+            GLState::getInstance()->bindTextureUnit(0, texture->id);
+
+            // Předání čísla texturové jednotky do shaderu
+            shader.set(uniforms.tex0, 0);
         }
-        if (EBO != 0) {
-            glDeleteBuffers(1, &EBO);
-            EBO = 0;
+        shader.set(uniforms.use_tex_array, texture_array);
+
+        // Nastavení diffuse_material do shaderu
+        shader.set(uniforms.diffuse_color, diffuse_material);
+
+        // Kvantizované vrcholy - shader dekóduje pozice a oktaedrické normály
+        if (uniforms.quantized.valid()) {
+            shader.set(uniforms.quantized, geometry->format == VertexFormat::Quantized);
+            shader.set(uniforms.pos_offset, geometry->positionOffset());
+            shader.set(uniforms.pos_scale, geometry->positionScale());
         }
     }
-
-private:
-    // OpenGL buffer IDs
-    // ID = 0 is reserved (i.e. uninitalized)
-    unsigned int VAO{ 0 }, VBO{ 0 }, EBO{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "MeshCache.hpp"
+#include "Mesh.hpp"
+#include "ResourceManager.hpp"
+
+const std::filesystem::path MeshCache::CACHE_DIRECTORY = "cache/meshes";
+
+namespace {
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Rozložení vrcholu pro daný formát - záznam s jiným rozložením je neplatný
+void describeVertexLayout(MeshCacheHeader& header, VertexFormat format) {
+    header.vertex_format = static_cast<uint32_t>(format);
+    header.vertex_stride = static_cast<uint32_t>(vertexStride(format));
+    header.attribute_count = 3;
+    if (format == VertexFormat::Quantized) {
+        header.attributes[0] = { 0, 3, GL_UNSIGNED_SHORT, static_cast<uint32_t>(offsetof(packed_vertex, position)) };
+        header.attributes[1] = { 1, 2, GL_SHORT, static_cast<uint32_t>(offsetof(packed_vertex, normal)) };
+        header.attributes[2] = { 2, 2, GL_HALF_FLOAT, static_cast<uint32_t>(offsetof(packed_vertex, texCoord)) };
+    }
+    else {
+        header.attributes[0] = { 0, 3, GL_FLOAT, static_cast<uint32_t>(offsetof(vertex, position)) };
+        header.attributes[1] = { 1, 3, GL_FLOAT, static_cast<uint32_t>(offsetof(vertex, normal)) };
+        header.attributes[2] = { 2, 2, GL_FLOAT, static_cast<uint32_t>(offsetof(vertex, texCoord)) };
+    }
+    header.attributes[3] = { 0, 0, 0, 0 };
+}
+
+} // namespace
+
+uint64_t MeshCache::hashBytes(const void* data, size_t size) {
+    return fnv1a(data, size);
+}
+
+bool MeshCache::sourceInfo(const std::filesystem::path& source, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = std::filesystem::file_size(source, ec);
+    if (ec) {
+        return false;
+    }
+    auto time = std::filesystem::last_write_time(source, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+bool MeshCache::refreshSourceTime(MappedFile& file, const std::filesystem::path& path, size_t mtime_offset, int64_t mtime) {
+    // Do namapovaného souboru nelze na Windows zapisovat - mapování se na zápis zavře
+    file.close();
+    {
+        std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (stream) {
+            stream.seekp(static_cast<std::streamoff>(mtime_offset));
+            stream.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+        }
+        if (!stream) {
+            std::cerr << "Cache: cannot update source time in " << path.filename().string() << std::endl;
+        }
+    }
+    return file.open(path);
+}
+
+std::filesystem::path MeshCache::cachePath(const std::filesystem::path& source, const std::string& variant) {
+    std::string key = ResourceManager::pathKey(source) + variant;
+    std::ostringstream name;
+    name << source.stem().string() << "-" << std::hex << std::setw(16) << std::setfill('0')
+        << fnv1a(key.data(), key.size()) << ".pgmesh";
+    return CACHE_DIRECTORY / name.str();
+}
+
+uint64_t MeshCache::hashFile(const std::filesystem::path& path) {
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        return 0;
+    }
+    return fnv1a(file.data(), file.size());
+}
+
+bool MeshCache::load(const std::filesystem::path& source, const std::string& variant, MeshCacheEntry& out) {
+    std::filesystem::path path = cachePath(source, variant);
+    if (!std::filesystem::exists(path) || !out.file.open(path)) {
+        return false;
+    }
+
+    if (out.file.size() < sizeof(MeshCacheHeader)) {
+        out.file.close();
+        return false;
+    }
+    MeshCacheHeader header;
+    std::memcpy(&header, out.file.data(), sizeof(header));
+
+    // Verze a rozložení vrcholu musí odpovídat aktuálnímu programu
+    MeshCacheHeader expected{};
+    describeVertexLayout(expected, static_cast<VertexFormat>(header.vertex_format));
+    if (header.magic != MeshCacheHeader::MAGIC || header.version != MeshCacheHeader::VERSION ||
+        header.vertex_format > static_cast<uint32_t>(VertexFormat::Quantized) ||
+        header.vertex_stride != expected.vertex_stride || header.attribute_count != expected.attribute_count ||
+        std::memcmp(header.attributes, expected.attributes, sizeof(expected.attributes)) != 0) {
+        std::cout << "Mesh cache " << path.filename().string() << ": incompatible format, rebuilding" << std::endl;
+        out.file.close();
+        return false;
+    }
+
+    // Typ indexů musí odpovídat počtu vrcholů a LOD rozsahy musí ležet v indexovém bufferu
+    bool lods_valid = header.lod_count <= MeshCacheHeader::MAX_LODS &&
+        (header.index_type == GL_UNSIGNED_SHORT || header.index_type == GL_UNSIGNED_INT) &&
+        header.index_type == MeshGeometry::indexTypeFor(header.vertex_count);
+    for (uint32_t i = 0; lods_valid && i < header.lod_count; i++) {
+        lods_valid = static_cast<uint64_t>(header.lods[i].first_index) + header.lods[i].index_count <= header.index_count;
+    }
+    if (!lods_valid) {
+        std::cerr << "Mesh cache " << path.filename().string() << ": invalid LOD table, rebuilding" << std::endl;
+        out.file.close();
+        return false;
+    }
+
+    size_t index_size = header.index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    if (header.vertex_offset + static_cast<uint64_t>(header.vertex_count) * header.vertex_stride > out.file.size() ||
+        header.index_offset + static_cast<uint64_t>(header.index_count) * index_size > out.file.size()) {
+        std::cerr << "Mesh cache " << path.filename().string() << ": truncated file, rebuilding" << std::endl;
+        out.file.close();
+        return false;
+    }
+
+    // Zastaralost - velikost + čas změny; při neshodě času (např. po checkoutu) rozhoduje hash obsahu
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    if (!sourceInfo(source, source_size, source_mtime) || source_size != header.source_size) {
+        out.file.close();
+        return false;
+    }
+    if (source_mtime != header.source_mtime) {
+        if (hashFile(source) != header.source_hash) {
+            std::cout << "Mesh cache " << path.filename().string() << ": source changed, rebuilding" << std::endl;
+            out.file.close();
+            return false;
+        }
+        if (!refreshSourceTime(out.file, path, offsetof(MeshCacheHeader, source_mtime), source_mtime)) {
+            return false;
+        }
+    }
+
+    out.header = reinterpret_cast<const MeshCacheHeader*>(out.file.data());
+    out.format = static_cast<VertexFormat>(header.vertex_format);
+    out.vertices = out.file.data() + header.vertex_offset;
+    out.indices = out.file.data() + header.index_offset;
+    return true;
+}
+
+std::vector<MeshLod> MeshCacheEntry::lods() const {
+    std::vector<MeshLod> result;
+    for (uint32_t i = 0; i < header->lod_count; i++) {
+        result.push_back({ header->lods[i].first_index, header->lods[i].index_count, header->lods[i].error });
+    }
+    return result;
+}
+
+bool MeshCache::store(const std::filesystem::path& source, const std::string& variant,
+    const std::vector<vertex>& vertices, const std::vector<GLuint>& indices, const std::vector<MeshLod>& lods,
+    VertexFormat format) {
+    MeshCacheHeader header{};
+    header.magic = MeshCacheHeader::MAGIC;
+    header.version = MeshCacheHeader::VERSION;
+    if (!sourceInfo(source, header.source_size, header.source_mtime)) {
+        return false;
+    }
+    header.source_hash = hashFile(source);
+    describeVertexLayout(header, format);
+
+    header.vertex_count = static_cast<uint32_t>(vertices.size());
+    header.index_count = static_cast<uint32_t>(indices.size());
+    header.index_type = MeshGeometry::indexTypeFor(vertices.size());
+    header.vertex_offset = alignUp(sizeof(MeshCacheHeader), 16);
+    header.index_offset = alignUp(header.vertex_offset + vertices.size() * header.vertex_stride, 16);
+
+    glm::vec3 bounds_min, bounds_max;
+    MeshGeometry::computeBounds(vertices, bounds_min, bounds_max);
+
+    // Data vrcholů v cílovém formátu
+    std::vector<packed_vertex> packed;
+    const void* vertex_data = vertices.data();
+    if (format == VertexFormat::Quantized) {
+        packed = packVertices(vertices, bounds_min, bounds_max);
+        vertex_data = packed.data();
+    }
+    std::memcpy(header.bounds_min, &bounds_min, sizeof(header.bounds_min));
+    std::memcpy(header.bounds_max, &bounds_max, sizeof(header.bounds_max));
+
+    header.lod_count = static_cast<uint32_t>(std::min<size_t>(lods.size(), MeshCacheHeader::MAX_LODS));
+    for (uint32_t i = 0; i < header.lod_count; i++) {
+        header.lods[i] = { static_cast<uint32_t>(lods[i].first_index), static_cast<uint32_t>(lods[i].index_count), lods[i].error, 0 };
+    }
+
+    std::filesystem::path path = cachePath(source, variant);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Zápis do dočasného souboru a přejmenování - rozepsaný soubor se nikdy nenačte
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Mesh cache: cannot write " << temp_path.string() << std::endl;
+            return false;
+        }
+
+        const char zeros[16] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(zeros, header.vertex_offset - sizeof(header));
+        file.write(static_cast<const char*>(vertex_data), vertices.size() * header.vertex_stride);
+        file.write(zeros, header.index_offset - (header.vertex_offset + vertices.size() * header.vertex_stride));
+        if (header.index_type == GL_UNSIGNED_SHORT) {
+            std::vector<GLushort> short_indices(indices.begin(), indices.end());
+            file.write(reinterpret_cast<const char*>(short_indices.data()), short_indices.size() * sizeof(GLushort));
+        }
+        else {
+            file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(GLuint));
+        }
+        if (!file) {
+            std::cerr << "Mesh cache: write failed " << temp_path.string() << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "Mesh cache: cannot replace " << path.string() << ": " << ec.message() << std::endl;
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
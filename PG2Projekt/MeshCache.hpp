@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "assets.hpp"
+#include "MappedFile.hpp"
+#include "Mesh.hpp"
+#include "VertexFormat.hpp"
+
+// Binární cache importovaných meshů (*.pgmesh) - data ve stejném tvaru, v jakém jdou na GPU,
+// takže další spuštění soubor jen namapuje a předá bufferům bez práce po vrcholech.
+//
+// Rozložení souboru: MeshCacheHeader | vrcholy (vertex_stride * vertex_count) | indexy (index_size * index_count)
+// Indexy všech úrovní detailu jsou za sebou, úseky popisuje tabulka lods v hlavičce.
+
+// Popis jednoho atributu vrcholu v souboru
+struct MeshCacheAttribute {
+    uint32_t semantic;   // 0 = pozice, 1 = normála, 2 = texturové koordináty
+    uint32_t components; // počet složek
+    uint32_t type;       // GL typ složky (GL_FLOAT, ...)
+    uint32_t offset;     // offset ve vrcholu v bajtech
+};
+
+// Úsek indexů jedné úrovně detailu
+struct MeshCacheLod {
+    uint32_t first_index;
+    uint32_t index_count;
+    float error;
+    uint32_t reserved;
+};
+
+struct MeshCacheHeader {
+    static constexpr uint32_t MAGIC = 0x48534D50; // "PMSH"
+    static constexpr uint32_t VERSION = 3;
+    static constexpr uint32_t MAX_ATTRIBUTES = 4;
+    static constexpr uint32_t MAX_LODS = 8;
+
+    uint32_t magic;
+    uint32_t version;
+
+    // Zdrojový soubor - při shodě velikosti a času změny se obsah nehashuje
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t source_hash;
+
+    // Rozložení vrcholu
+    uint32_t vertex_format; // VertexFormat
+    uint32_t vertex_stride;
+    uint32_t attribute_count;
+    MeshCacheAttribute attributes[MAX_ATTRIBUTES];
+
+    // Data
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t index_type; // GL_UNSIGNED_SHORT / GL_UNSIGNED_INT
+    uint32_t reserved;
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+
+    // Obalový kvádr
+    float bounds_min[3];
+    float bounds_max[3];
+
+    // Úrovně detailu
+    uint32_t lod_count;
+    MeshCacheLod lods[MAX_LODS];
+};
+
+// Namapovaný platný záznam v cache - ukazatele míří přímo do souboru
+struct MeshCacheEntry {
+    MappedFile file;
+    const MeshCacheHeader* header{ nullptr };
+    VertexFormat format{ VertexFormat::Float };
+    const void* vertices{ nullptr }; // ve formátu format
+    const void* indices{ nullptr };
+
+    // Tabulka úrovní detailu z hlavičky
+    std::vector<MeshLod> lods() const;
+};
+
+class MeshCache {
+public:
+    // Adresář s cache (relativně k pracovnímu adresáři)
+    static const std::filesystem::path CACHE_DIRECTORY;
+
+    // Soubor v cache pro daný zdroj a variantu importu (např. volby optimalizace)
+    static std::filesystem::path cachePath(const std::filesystem::path& source, const std::string& variant);
+
+    // Namapování záznamu - false, pokud neexistuje, je jiné verze/rozložení nebo je zdroj novější
+    static bool load(const std::filesystem::path& source, const std::string& variant, MeshCacheEntry& out);
+
+    // Uložení importovaných dat (vrcholy i indexy se uloží ve formátu, který půjde na GPU)
+    static bool store(const std::filesystem::path& source, const std::string& variant,
+        const std::vector<vertex>& vertices, const std::vector<GLuint>& indices, const std::vector<MeshLod>& lods,
+        VertexFormat format);
+
+    // FNV-1a hash obsahu souboru (0, pokud soubor nelze přečíst)
+    static uint64_t hashFile(const std::filesystem::path& path);
+    static uint64_t hashBytes(const void* data, size_t size);
+
+    // Velikost a čas změny zdrojového souboru (pro kontrolu zastaralosti záznamů v cache)
+    static bool sourceInfo(const std::filesystem::path& source, uint64_t& size, int64_t& mtime);
+
+    // Zápis nového času změny zdroje do hlavičky záznamu (na offset mtime_offset) po ověření hashem,
+    // aby se zdroj při dalším spuštění znovu nehashoval. Záznam se pro zápis odmapuje a znovu namapuje;
+    // false = soubor už nelze namapovat (chyba zápisu jen zopakuje hashování příště).
+    static bool refreshSourceTime(MappedFile& file, const std::filesystem::path& path, size_t mtime_offset, int64_t mtime);
+};
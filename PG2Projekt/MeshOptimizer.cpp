@@ -0,0 +1,339 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <glm/glm.hpp>
+#include "MeshOptimizer.hpp"
+
+VertexCacheStats analyzeVertexCache(const std::vector<GLuint>& indices, size_t vertex_count, unsigned int cache_size) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertex_count == 0) {
+        return stats;
+    }
+
+    // FIFO cache: vrchol je v cache, pokud byl vložen před méně než cache_size vloženími
+    std::vector<size_t> timestamps(vertex_count, 0);
+    size_t time = cache_size + 1;
+    size_t misses = 0;
+
+    for (GLuint index : indices) {
+        if (time - timestamps[index] > cache_size) {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / vertex_count;
+    return stats;
+}
+
+namespace {
+
+// Parametry skórování podle Forsytha
+const int FORSYTH_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRI_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cache_position, int remaining_triangles) {
+    if (remaining_triangles == 0) {
+        return -1.0f; // Vrchol už není potřeba
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // Vrcholy posledního trojúhelníku mají pevné skóre (aby se nepreferoval stejný trojúhelník)
+            score = LAST_TRI_SCORE;
+        }
+        else {
+            const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cache_position - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    // Bonus za malý počet zbývajících trojúhelníků - vrchol se vyplatí "dokončit"
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining_triangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+} // namespace
+
+void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertex_count) {
+    // Degenerované trojúhelníky (opakovaný index) nic nevykreslí - vyřadí se předem, jinak by se
+    // stejný vrchol vložil do LRU cache víckrát a vytlačil platné záznamy
+    size_t kept = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        GLuint a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a != b && b != c && a != c) {
+            indices[kept++] = a;
+            indices[kept++] = b;
+            indices[kept++] = c;
+        }
+    }
+    indices.resize(kept);
+
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // Seznamy trojúhelníků pro každý vrchol (CSR - offsety + data)
+    std::vector<int> remaining(vertex_count, 0);
+    for (GLuint index : indices) {
+        remaining[index]++;
+    }
+    std::vector<size_t> offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<size_t> vertex_triangles(indices.size());
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (int c = 0; c < 3; c++) {
+            GLuint v = indices[t * 3 + c];
+            vertex_triangles[fill[v]++] = t;
+        }
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_scores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    for (size_t t = 0; t < triangle_count; t++) {
+        triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+    }
+
+    std::vector<GLuint> cache;
+    std::vector<GLuint> new_cache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    // Počáteční trojúhelník - nejlepší skóre ze všech
+    size_t best = std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin();
+    size_t scan_position = 0; // pro hledání dalšího nevykresleného trojúhelníku, když cache nic nenabízí
+
+    for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        if (best == SIZE_MAX) {
+            // Cache neobsahuje žádný použitelný trojúhelník - vezmeme nejlepší ze zbývajících
+            float best_score = -1.0f;
+            for (size_t t = scan_position; t < triangle_count; t++) {
+                if (!emitted[t] && triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best = t;
+                }
+            }
+            while (scan_position < triangle_count && emitted[scan_position]) {
+                scan_position++;
+            }
+        }
+
+        // Vydání trojúhelníku
+        emitted[best] = true;
+        const GLuint* tri = &indices[best * 3];
+        result.insert(result.end(), tri, tri + 3);
+
+        // Aktualizace LRU cache - vrcholy trojúhelníku jdou na začátek
+        new_cache.clear();
+        for (int c = 0; c < 3; c++) {
+            GLuint v = tri[c];
+            new_cache.push_back(v);
+            remaining[v]--;
+
+            // Odebrání trojúhelníku ze seznamu vrcholu (přesun na konec aktivní části)
+            size_t begin = offsets[v];
+            size_t end = begin + remaining[v] + 1;
+            for (size_t i = begin; i < end; i++) {
+                if (vertex_triangles[i] == best) {
+                    std::swap(vertex_triangles[i], vertex_triangles[end - 1]);
+                    break;
+                }
+            }
+        }
+        for (GLuint v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache.push_back(v);
+            }
+        }
+
+        // Vrcholy, které vypadly z cache, ztrácí bonus za pozici
+        for (size_t i = FORSYTH_CACHE_SIZE; i < new_cache.size(); i++) {
+            cache_position[new_cache[i]] = -1;
+            vertex_scores[new_cache[i]] = vertexScore(-1, remaining[new_cache[i]]);
+        }
+        if (new_cache.size() > FORSYTH_CACHE_SIZE) {
+            new_cache.resize(FORSYTH_CACHE_SIZE);
+        }
+        cache.swap(new_cache);
+
+        // Přepočet skóre vrcholů v cache a jejich trojúhelníků, výběr dalšího nejlepšího
+        for (size_t i = 0; i < cache.size(); i++) {
+            cache_position[cache[i]] = static_cast<int>(i);
+            vertex_scores[cache[i]] = vertexScore(static_cast<int>(i), remaining[cache[i]]);
+        }
+
+        best = SIZE_MAX;
+        float best_score = -1.0f;
+        for (GLuint v : cache) {
+            for (size_t i = offsets[v]; i < offsets[v] + remaining[v]; i++) {
+                size_t t = vertex_triangles[i];
+                float score = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+                triangle_scores[t] = score;
+                if (score > best_score) {
+                    best_score = score;
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<vertex>& vertices, float threshold) {
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+    const unsigned int cache_size = 16;
+
+    // 1. Tvrdé hranice shluků - trojúhelník, jehož žádný vrchol není v cache (skok v pořadí)
+    std::vector<size_t> timestamps(vertices.size(), 0);
+    size_t time = cache_size + 1;
+    std::vector<size_t> hard_boundaries;
+    for (size_t t = 0; t < triangle_count; t++) {
+        int misses = 0;
+        for (int c = 0; c < 3; c++) {
+            GLuint v = indices[t * 3 + c];
+            if (time - timestamps[v] > cache_size) {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3) {
+            hard_boundaries.push_back(t);
+        }
+    }
+    hard_boundaries.push_back(triangle_count);
+
+    // 2. Měkké hranice - shluk se dál dělí, dokud jeho ACMR (s prázdnou cache) nepřekročí
+    //    threshold * ACMR celého tvrdého shluku
+    std::vector<size_t> boundaries;
+    for (size_t h = 0; h + 1 < hard_boundaries.size(); h++) {
+        size_t start = hard_boundaries[h];
+        size_t end = hard_boundaries[h + 1];
+
+        std::vector<GLuint> cluster(indices.begin() + start * 3, indices.begin() + end * 3);
+        float cluster_acmr = analyzeVertexCache(cluster, vertices.size(), cache_size).acmr;
+
+        boundaries.push_back(start);
+        time += cache_size + 1; // reset cache
+        size_t sub_start = start;
+        size_t sub_misses = 0;
+        for (size_t t = start; t < end; t++) {
+            for (int c = 0; c < 3; c++) {
+                GLuint v = indices[t * 3 + c];
+                if (time - timestamps[v] > cache_size) {
+                    timestamps[v] = time++;
+                    sub_misses++;
+                }
+            }
+            float sub_acmr = static_cast<float>(sub_misses) / (t - sub_start + 1);
+            if (t + 1 < end && sub_acmr <= cluster_acmr * threshold) {
+                boundaries.push_back(t + 1);
+                sub_start = t + 1;
+                sub_misses = 0;
+                time += cache_size + 1;
+            }
+        }
+    }
+    boundaries.push_back(triangle_count);
+
+    // 3. Pro každý shluk těžiště a průměrná normála (vážené plochou)
+    glm::vec3 mesh_center(0.0f);
+    float mesh_area = 0.0f;
+    struct Cluster {
+        size_t start, end;
+        float sort_key;
+    };
+    std::vector<Cluster> clusters;
+    std::vector<glm::vec3> centroids;
+    std::vector<glm::vec3> normals;
+    for (size_t b = 0; b + 1 < boundaries.size(); b++) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area_sum = 0.0f;
+        for (size_t t = boundaries[b]; t < boundaries[b + 1]; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(n);
+            centroid += (p0 + p1 + p2) * (area / 3.0f);
+            normal += n;
+            area_sum += area;
+        }
+        mesh_center += centroid;
+        mesh_area += area_sum;
+        centroids.push_back(area_sum > 0.0f ? centroid / area_sum : vertices[indices[boundaries[b] * 3]].position);
+        float length = glm::length(normal);
+        normals.push_back(length > 0.0f ? normal / length : glm::vec3(0.0f));
+        clusters.push_back({ boundaries[b], boundaries[b + 1], 0.0f });
+    }
+    if (mesh_area > 0.0f) {
+        mesh_center /= mesh_area;
+    }
+
+    // 4. Shluky orientované ven ze středu meshe jdou první - typicky zakrývají ty vnitřní
+    for (size_t c = 0; c < clusters.size(); c++) {
+        clusters[c].sort_key = glm::dot(centroids[c] - mesh_center, normals[c]);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for (const auto& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+    }
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<vertex>& vertices, std::vector<GLuint>& indices) {
+    const GLuint unused = static_cast<GLuint>(-1);
+    std::vector<GLuint> remap(vertices.size(), unused);
+    std::vector<vertex> result;
+    result.reserve(vertices.size());
+
+    // Vrcholy v pořadí prvního použití; nepoužité vrcholy vypadnou
+    for (GLuint& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<GLuint>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+void optimizeMesh(std::vector<vertex>& vertices, std::vector<GLuint>& indices, const std::string& name) {
+    VertexCacheStats before = analyzeVertexCache(indices, vertices.size());
+
+    optimizeVertexCache(indices, vertices.size());
+    VertexCacheStats after_cache = analyzeVertexCache(indices, vertices.size());
+
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+    VertexCacheStats after = analyzeVertexCache(indices, vertices.size());
+
+    std::cout << "Mesh optimization " << name << ": ACMR " << before.acmr << " -> " << after_cache.acmr
+        << " (vertex cache) -> " << after.acmr << " (overdraw), ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+}
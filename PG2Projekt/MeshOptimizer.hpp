@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "assets.hpp"
+
+// Statistika post-transform vertex cache
+struct VertexCacheStats {
+    float acmr{ 0.0f }; // Average Cache Miss Ratio - průměrný počet transformovaných vrcholů na trojúhelník (0.5 - 3.0)
+    float atvr{ 0.0f }; // Average Transformed Vertex Ratio - transformace na jeden unikátní vrchol (ideálně 1.0)
+};
+
+// Simulace FIFO vertex cache dané velikosti nad index bufferem
+VertexCacheStats analyzeVertexCache(const std::vector<GLuint>& indices, size_t vertex_count, unsigned int cache_size = 16);
+
+// Přeuspořádání trojúhelníků pro maximální využití vertex cache (algoritmus Toma Forsytha);
+// degenerované trojúhelníky se vyřadí
+void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertex_count);
+
+// Přeuspořádání shluků trojúhelníků pro menší overdraw (shluky orientované ven z meshe jdou první);
+// threshold = o kolik se smí zhoršit ACMR kvůli jemnějšímu dělení na shluky
+void optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<vertex>& vertices, float threshold = 1.05f);
+
+// Přeuspořádání vrcholů podle prvního použití v index bufferu (lokalita při čtení vrcholů)
+void optimizeVertexFetch(std::vector<vertex>& vertices, std::vector<GLuint>& indices);
+
+// Celá optimalizace (cache -> overdraw -> fetch) s výpisem ACMR/ATVR před a po
+void optimizeMesh(std::vector<vertex>& vertices, std::vector<GLuint>& indices, const std::string& name);
@@ -0,0 +1,266 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "MeshSimplifier.hpp"
+
+namespace {
+
+// Symetrická matice 4x4 kvadriky (10 prvků)
+struct Quadric {
+    double a00{ 0 }, a01{ 0 }, a02{ 0 }, a03{ 0 };
+    double a11{ 0 }, a12{ 0 }, a13{ 0 };
+    double a22{ 0 }, a23{ 0 };
+    double a33{ 0 };
+
+    // Kvadrika roviny n.p + d = 0 (n normalizovaná) - hodnota = čtverec vzdálenosti od roviny
+    static Quadric fromPlane(const glm::dvec3& n, double d) {
+        Quadric q;
+        q.a00 = n.x * n.x; q.a01 = n.x * n.y; q.a02 = n.x * n.z; q.a03 = n.x * d;
+        q.a11 = n.y * n.y; q.a12 = n.y * n.z; q.a13 = n.y * d;
+        q.a22 = n.z * n.z; q.a23 = n.z * d;
+        q.a33 = d * d;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+        a11 += o.a11; a12 += o.a12; a13 += o.a13;
+        a22 += o.a22; a23 += o.a23;
+        a33 += o.a33;
+        return *this;
+    }
+
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double result = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+            + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+            + a22 * z * z + 2 * a23 * z
+            + a33;
+        return std::max(result, 0.0);
+    }
+};
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t words[3];
+        std::memcpy(words, &p, sizeof(words));
+        return (words[0] * 73856093u) ^ (words[1] * 19349663u) ^ (words[2] * 83492791u);
+    }
+};
+
+struct Collapse {
+    GLuint from;  // vrchol, který zanikne
+    GLuint to;    // vrchol, do kterého se slije
+    double cost;
+};
+
+} // namespace
+
+std::vector<GLuint> simplifyMesh(const std::vector<vertex>& vertices, const std::vector<GLuint>& indices,
+    size_t target_index_count, float& out_error) {
+    out_error = 0.0f;
+    std::vector<GLuint> result(indices);
+    if (result.size() <= target_index_count || vertices.empty()) {
+        return result;
+    }
+
+    // 1. Vrcholy se stejnou pozicí (švy normál/UV) sdílí jedno "pozicové" id
+    std::vector<GLuint> position_id(vertices.size());
+    std::vector<GLuint> wedge_count;
+    std::vector<glm::vec3> positions;
+    {
+        std::unordered_map<glm::vec3, GLuint, PositionHash> unique;
+        unique.reserve(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++) {
+            auto inserted = unique.emplace(vertices[v].position, static_cast<GLuint>(positions.size()));
+            if (inserted.second) {
+                positions.push_back(vertices[v].position);
+                wedge_count.push_back(0);
+            }
+            position_id[v] = inserted.first->second;
+            wedge_count[inserted.first->second]++;
+        }
+    }
+    const size_t position_count = positions.size();
+
+    // 2. Zamčené vrcholy - švy atributů a hranice sítě (hrana s jediným trojúhelníkem)
+    std::vector<bool> locked(position_count, false);
+    for (size_t p = 0; p < position_count; p++) {
+        locked[p] = wedge_count[p] > 1;
+    }
+    {
+        std::unordered_map<uint64_t, int> edge_use;
+        edge_use.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint64_t a = position_id[result[i + e]];
+                uint64_t b = position_id[result[i + (e + 1) % 3]];
+                edge_use[std::min(a, b) << 32 | std::max(a, b)]++;
+            }
+        }
+        for (const auto& edge : edge_use) {
+            if (edge.second == 1) {
+                locked[edge.first >> 32] = true;
+                locked[edge.first & 0xffffffffu] = true;
+            }
+        }
+    }
+
+    // 3. Kvadriky rovin všech trojúhelníků
+    std::vector<Quadric> quadrics(position_count);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        GLuint p0 = position_id[result[i]], p1 = position_id[result[i + 1]], p2 = position_id[result[i + 2]];
+        glm::dvec3 a(positions[p0]), b(positions[p1]), c(positions[p2]);
+        glm::dvec3 n = glm::cross(b - a, c - a);
+        double length = glm::length(n);
+        if (length <= 0.0) {
+            continue;
+        }
+        n /= length;
+        Quadric q = Quadric::fromPlane(n, -glm::dot(n, a));
+        quadrics[p0] += q;
+        quadrics[p1] += q;
+        quadrics[p2] += q;
+    }
+
+    double max_cost = 0.0;
+    std::vector<GLuint> remap(vertices.size());
+    std::vector<bool> touched(position_count);
+    std::vector<size_t> triangle_offsets(position_count + 1);
+    std::vector<size_t> vertex_triangles;
+    std::vector<Collapse> collapses;
+
+    // 4. Průchody - v každém se slije nezávislá množina nejlevnějších hran
+    while (result.size() > target_index_count) {
+        const size_t triangle_count = result.size() / 3;
+
+        // Trojúhelníky kolem každé pozice (CSR)
+        std::fill(triangle_offsets.begin(), triangle_offsets.end(), 0);
+        for (GLuint index : result) {
+            triangle_offsets[position_id[index] + 1]++;
+        }
+        for (size_t p = 0; p < position_count; p++) {
+            triangle_offsets[p + 1] += triangle_offsets[p];
+        }
+        vertex_triangles.resize(result.size());
+        {
+            std::vector<size_t> fill(triangle_offsets.begin(), triangle_offsets.end() - 1);
+            for (size_t t = 0; t < triangle_count; t++) {
+                for (int c = 0; c < 3; c++) {
+                    vertex_triangles[fill[position_id[result[t * 3 + c]]]++] = t;
+                }
+            }
+        }
+
+        // Kandidáti - každá hrana v levnějším povoleném směru
+        collapses.clear();
+        for (size_t t = 0; t < triangle_count; t++) {
+            for (int e = 0; e < 3; e++) {
+                GLuint v0 = result[t * 3 + e];
+                GLuint v1 = result[t * 3 + (e + 1) % 3];
+                GLuint p0 = position_id[v0], p1 = position_id[v1];
+                if (p0 > p1) {
+                    continue; // každá (vnitřní) hrana jen jednou
+                }
+
+                Collapse best{ 0, 0, -1.0 };
+                if (!locked[p0]) {
+                    Quadric q = quadrics[p0];
+                    q += quadrics[p1];
+                    best = { v0, v1, q.evaluate(positions[p1]) };
+                }
+                if (!locked[p1]) {
+                    Quadric q = quadrics[p0];
+                    q += quadrics[p1];
+                    double cost = q.evaluate(positions[p0]);
+                    if (best.cost < 0.0 || cost < best.cost) {
+                        best = { v1, v0, cost };
+                    }
+                }
+                if (best.cost >= 0.0) {
+                    collapses.push_back(best);
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+            [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        for (size_t v = 0; v < vertices.size(); v++) {
+            remap[v] = static_cast<GLuint>(v);
+        }
+        std::fill(touched.begin(), touched.end(), false);
+
+        // Každé slití odebere (typicky) dva trojúhelníky
+        size_t triangles_to_remove = (result.size() - target_index_count) / 3;
+        size_t removed = 0;
+        size_t accepted = 0;
+
+        for (const auto& collapse : collapses) {
+            if (removed >= triangles_to_remove) {
+                break;
+            }
+            GLuint from = position_id[collapse.from];
+            GLuint to = position_id[collapse.to];
+            if (touched[from] || touched[to]) {
+                continue;
+            }
+
+            // Kontrola převrácení trojúhelníků kolem zanikajícího vrcholu
+            bool flips = false;
+            for (size_t i = triangle_offsets[from]; i < triangle_offsets[from + 1] && !flips; i++) {
+                size_t t = vertex_triangles[i];
+                GLuint p[3] = { position_id[result[t * 3]], position_id[result[t * 3 + 1]], position_id[result[t * 3 + 2]] };
+                if (p[0] == to || p[1] == to || p[2] == to) {
+                    continue; // trojúhelník zanikne
+                }
+                glm::vec3 before = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+                for (auto& id : p) {
+                    if (id == from) {
+                        id = to;
+                    }
+                }
+                glm::vec3 after = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips) {
+                continue;
+            }
+
+            // Přijetí - sousedé se v tomto průchodu už nemění (kontroly výše zůstávají platné)
+            for (size_t i = triangle_offsets[from]; i < triangle_offsets[from + 1]; i++) {
+                size_t t = vertex_triangles[i];
+                for (int c = 0; c < 3; c++) {
+                    touched[position_id[result[t * 3 + c]]] = true;
+                }
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[to] += quadrics[from];
+            max_cost = std::max(max_cost, collapse.cost);
+            removed += 2;
+            accepted++;
+        }
+
+        if (accepted == 0) {
+            break; // nic dalšího nelze slít
+        }
+
+        // Přemapování indexů a odstranění degenerovaných trojúhelníků
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            GLuint a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            GLuint pa = position_id[a], pb = position_id[b], pc = position_id[c];
+            if (pa == pb || pb == pc || pa == pc) {
+                continue;
+            }
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    out_error = static_cast<float>(std::sqrt(max_cost));
+    return result;
+}
@@ -0,0 +1,14 @@
+﻿#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include "assets.hpp"
+
+// Zjednodušení trojúhelníkové sítě metodou Quadric Error Metrics (Garland & Heckbert).
+// Používá se half-edge collapse - vrchol se slije do existujícího souseda, takže pole vrcholů
+// zůstává stejné a jednotlivé LOD úrovně se liší jen index bufferem (sdílí jeden VBO).
+//
+// Vrcholy na hranici sítě a na švech atributů (stejná pozice, jiná normála/UV) se nepřesouvají.
+// out_error = horní odhad vzdálenosti zjednodušené plochy od původní (v jednotkách meshe).
+std::vector<GLuint> simplifyMesh(const std::vector<vertex>& vertices, const std::vector<GLuint>& indices,
+    size_t target_index_count, float& out_error);
@@ -0,0 +1,229 @@
+﻿#include "MipGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE2 je na x64 vždy k dispozici, na x86 podle přepínače /arch
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PG2_MIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Parametry Kaiserova okna - poloměr v pixelech cílové úrovně a tvar okna
+constexpr float KAISER_RADIUS = 2.0f;
+constexpr float KAISER_BETA = 4.0f;
+
+// Modifikovaná Besselova funkce prvního druhu řádu 0 (řada)
+float besselI0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    float half = x * 0.5f;
+    for (int k = 1; k < 32; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-8f) {
+            break;
+        }
+    }
+    return sum;
+}
+
+float sinc(float x) {
+    if (std::abs(x) < 1e-5f) {
+        return 1.0f;
+    }
+    float px = 3.14159265358979f * x;
+    return std::sin(px) / px;
+}
+
+// Váhy jednoho výstupního pixelu (indexy vstupu jsou už ořezané na okraj)
+struct FilterTaps {
+    std::vector<int> index;
+    std::vector<float> weight;
+};
+
+// Taps pro zmenšení jedné osy source -> destination
+std::vector<FilterTaps> kaiserTaps(int source, int destination) {
+    std::vector<FilterTaps> taps(destination);
+    const float scale = static_cast<float>(source) / destination;
+    const float support = KAISER_RADIUS * scale;
+    const float norm = 1.0f / besselI0(KAISER_BETA);
+
+    for (int i = 0; i < destination; i++) {
+        float center = (i + 0.5f) * scale;
+        int first = static_cast<int>(std::floor(center - support));
+        int last = static_cast<int>(std::ceil(center + support));
+
+        float total = 0.0f;
+        for (int j = first; j <= last; j++) {
+            float t = (j + 0.5f - center) / scale; // vzdálenost v pixelech cílové úrovně
+            if (std::abs(t) >= KAISER_RADIUS) {
+                continue;
+            }
+            float r = t / KAISER_RADIUS;
+            float w = sinc(t) * besselI0(KAISER_BETA * std::sqrt(1.0f - r * r)) * norm;
+            int index = std::clamp(j, 0, source - 1);
+
+            // Ořezané indexy na okraji se sloučí do jednoho tapu
+            if (!taps[i].index.empty() && taps[i].index.back() == index) {
+                taps[i].weight.back() += w;
+            }
+            else {
+                taps[i].index.push_back(index);
+                taps[i].weight.push_back(w);
+            }
+            total += w;
+        }
+        for (float& w : taps[i].weight) {
+            w /= total;
+        }
+    }
+    return taps;
+}
+
+// Jeden pixel 2x2 průměru (ořezané souřadnice pro rozměr 1)
+inline void boxPixel(const RgbaImage& source, int x0, int x1, int y0, int y1, uint8_t* out) {
+    const uint8_t* a = &source.pixels[(static_cast<size_t>(y0) * source.width + x0) * 4];
+    const uint8_t* b = &source.pixels[(static_cast<size_t>(y0) * source.width + x1) * 4];
+    const uint8_t* c = &source.pixels[(static_cast<size_t>(y1) * source.width + x0) * 4];
+    const uint8_t* d = &source.pixels[(static_cast<size_t>(y1) * source.width + x1) * 4];
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+    }
+}
+
+} // namespace
+
+const char* mipFilterName(MipFilter filter) {
+    switch (filter) {
+    case MipFilter::Kaiser:
+        return "kaiser";
+    default:
+        return "box";
+    }
+}
+
+RgbaImage downsampleBox(const RgbaImage& source) {
+    RgbaImage level;
+    level.width = std::max(1, source.width / 2);
+    level.height = std::max(1, source.height / 2);
+    level.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+    for (int y = 0; y < level.height; y++) {
+        int y0 = std::min(2 * y, source.height - 1);
+        int y1 = std::min(2 * y + 1, source.height - 1);
+        const uint8_t* row0 = &source.pixels[static_cast<size_t>(y0) * source.width * 4];
+        const uint8_t* row1 = &source.pixels[static_cast<size_t>(y1) * source.width * 4];
+        uint8_t* out = &level.pixels[static_cast<size_t>(y) * level.width * 4];
+
+        int x = 0;
+#ifdef PG2_MIP_SSE2
+        // 4 vstupní pixely z každého řádku -> 2 výstupní pixely, součty v 16 bitech
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(2);
+        for (; x + 2 <= level.width && 2 * x + 4 <= source.width; x += 2) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));   // pixely 0, 1
+            __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));  // pixely 2, 3
+            left = _mm_add_epi16(left, _mm_srli_si128(left, 8));
+            right = _mm_add_epi16(right, _mm_srli_si128(right, 8));
+            __m128i sum = _mm_unpacklo_epi64(left, right);
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, sum));
+        }
+#endif
+        for (; x < level.width; x++) {
+            int x0 = std::min(2 * x, source.width - 1);
+            int x1 = std::min(2 * x + 1, source.width - 1);
+            boxPixel(source, x0, x1, y0, y1, out + x * 4);
+        }
+    }
+    return level;
+}
+
+RgbaImage downsampleKaiser(const RgbaImage& source) {
+    RgbaImage level;
+    level.width = std::max(1, source.width / 2);
+    level.height = std::max(1, source.height / 2);
+    level.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+    const std::vector<FilterTaps> taps_x = kaiserTaps(source.width, level.width);
+    const std::vector<FilterTaps> taps_y = kaiserTaps(source.height, level.height);
+
+    // Separabilní filtr: vodorovný průchod do float mezivýsledku (level.width x source.height),
+    // pak svislý průchod do výsledku. Jeden pixel RGBA = jeden 4složkový vektor.
+    std::vector<float> temp(static_cast<size_t>(level.width) * source.height * 4);
+
+    for (int y = 0; y < source.height; y++) {
+        const uint8_t* row = &source.pixels[static_cast<size_t>(y) * source.width * 4];
+        float* out = &temp[static_cast<size_t>(y) * level.width * 4];
+        for (int x = 0; x < level.width; x++) {
+            const FilterTaps& t = taps_x[x];
+#ifdef PG2_MIP_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            __m128 sum = _mm_setzero_ps();
+            for (size_t k = 0; k < t.index.size(); k++) {
+                __m128i p = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(row + t.index[k] * 4));
+                p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(p), _mm_set1_ps(t.weight[k])));
+            }
+            _mm_storeu_ps(out + x * 4, sum);
+#else
+            float sum[4] = {};
+            for (size_t k = 0; k < t.index.size(); k++) {
+                const uint8_t* p = row + t.index[k] * 4;
+                for (int c = 0; c < 4; c++) {
+                    sum[c] += p[c] * t.weight[k];
+                }
+            }
+            std::copy(sum, sum + 4, out + x * 4);
+#endif
+        }
+    }
+
+    for (int y = 0; y < level.height; y++) {
+        const FilterTaps& t = taps_y[y];
+        uint8_t* out = &level.pixels[static_cast<size_t>(y) * level.width * 4];
+        for (int x = 0; x < level.width; x++) {
+#ifdef PG2_MIP_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (size_t k = 0; k < t.index.size(); k++) {
+                const float* p = &temp[(static_cast<size_t>(t.index[k]) * level.width + x) * 4];
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(t.weight[k])));
+            }
+            // Zaokrouhlení a saturace do 0..255 (záporné laloky sincu)
+            __m128i value = _mm_cvtps_epi32(sum);
+            value = _mm_packs_epi32(value, value);
+            value = _mm_packus_epi16(value, value);
+            *reinterpret_cast<int*>(out + x * 4) = _mm_cvtsi128_si32(value);
+#else
+            float sum[4] = {};
+            for (size_t k = 0; k < t.index.size(); k++) {
+                const float* p = &temp[(static_cast<size_t>(t.index[k]) * level.width + x) * 4];
+                for (int c = 0; c < 4; c++) {
+                    sum[c] += p[c] * t.weight[k];
+                }
+            }
+            for (int c = 0; c < 4; c++) {
+                out[x * 4 + c] = static_cast<uint8_t>(std::clamp(std::lround(sum[c]), 0L, 255L));
+            }
+#endif
+        }
+    }
+    return level;
+}
+
+std::vector<RgbaImage> buildMipChain(RgbaImage base, MipFilter filter) {
+    std::vector<RgbaImage> chain;
+    chain.push_back(std::move(base));
+
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        // Kaiser potřebuje aspoň pár pixelů na tap - nejmenší úrovně stačí průměrovat
+        bool kaiser = filter == MipFilter::Kaiser && chain.back().width >= 4 && chain.back().height >= 4;
+        chain.push_back(kaiser ? downsampleKaiser(chain.back()) : downsampleBox(chain.back()));
+    }
+    return chain;
+}
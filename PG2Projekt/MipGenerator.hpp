@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Obrázek RGBA8 (pořadí kanálů R, G, B, A) - mip úrovně na CPU a vstup kompresoru
+struct RgbaImage {
+    int width{ 0 };
+    int height{ 0 };
+    std::vector<uint8_t> pixels; // width * height * 4
+};
+
+// Filtr pro zmenšení na další mip úroveň
+enum class MipFilter : uint32_t {
+    Box = 0,    // průměr 2x2 (stejný výsledek jako glGenerateMipmap)
+    Kaiser = 1, // okénkovaný sinc (Kaiser, 8 tapů) - ostřejší mipmapy bez aliasingu
+};
+
+const char* mipFilterName(MipFilter filter);
+
+// Zmenšení na polovinu v obou osách (liché rozměry se zaokrouhlí dolů, minimálně 1)
+RgbaImage downsampleBox(const RgbaImage& source);
+RgbaImage downsampleKaiser(const RgbaImage& source);
+
+// Mip řetězec až do 1x1 (úroveň 0 = vstup)
+std::vector<RgbaImage> buildMipChain(RgbaImage base, MipFilter filter = MipFilter::Box);
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <filesystem>
 #include <string>
 #include <vector> 
@@ -7,77 +8,115 @@
 #include "assets.hpp"
 #include "Mesh.hpp"
 #include "ShaderProgram.hpp"
-#include "OBJloader.hpp"
+#include "ResourceManager.hpp"
+#include "TextureStreamer.hpp"
 
 class Model {
 public:
     std::vector<Mesh> meshes;
     std::string name;
 
-    // Transforman vlastnosti
+    // Transformační vlastnosti
     glm::vec3 origin{ 0.0f, 0.0f, 0.0f };
-    glm::vec3 orientation{ 0.0f, 0.0f, 0.0f };  // v radinech
+    glm::vec3 orientation{ 0.0f, 0.0f, 0.0f };  // v radiánech
     glm::vec3 scale{ 1.0f, 1.0f, 1.0f };
-    glm::mat4 local_model_matrix{ 1.0f }; // identita (dn transformace)
+    glm::mat4 local_model_matrix{ 1.0f }; // identita (žádná transformace)
 
-    // Pznak transparence - TOTO JE PIDNO PRO KOL 1
+    // Příznak transparence - TOTO JE PŘIDÁNO PRO ÚKOL 1
     bool transparent{ false };
 
     ShaderProgram shader;
 
-    Model(const std::filesystem::path& filename, ShaderProgram shader) {
+    // Obalový kvádr a koule všech meshů v lokálních souřadnicích (spočítané při vytvoření, viz updateBounds)
+    glm::vec3 bounds_min{ 0.0f };
+    glm::vec3 bounds_max{ 0.0f };
+    glm::vec3 sphere_center{ 0.0f };
+    float sphere_radius{ 0.0f };
+
+    // Výběr úrovně detailu - max. povolená chyba v pixelech a plynulý přechod (dithered cross-fade)
+    float lod_pixel_error{ 1.0f };
+    bool lod_crossfade{ true };
+    static constexpr float LOD_FADE_TIME = 0.3f; // délka přechodu v sekundách
+
+    Model(const std::filesystem::path& filename, ShaderProgram shader, const MeshImportOptions& options = MeshImportOptions()) {
         this->shader = shader;
         this->name = filename.stem().string();
 
-        // Naten OBJ souboru
-        std::vector<glm::vec3> vertices;
-        std::vector<glm::vec2> uvs;
-        std::vector<glm::vec3> normals;
-        bool res = loadOBJ(filename.string(), vertices, uvs, normals);
-        if (!res) {
-            throw std::runtime_error("Failed to load OBJ file: " + filename.string());
-        }
+        // Geometrie přes ResourceManager - každý OBJ soubor se načte a nahraje na GPU jen jednou
+        std::shared_ptr<MeshGeometry> geometry = ResourceManager::getInstance()->getMeshGeometry(filename, options);
 
-        // Pevod natench dat do formtu, kter pouv nae struktura vertex
-        std::vector<vertex> mesh_vertices;
-        for (size_t i = 0; i < vertices.size(); i++) {
-            vertex v;
-            v.position = vertices[i];
-            if (i < uvs.size()) {
-                v.texCoord = uvs[i];
-            }
-            else {
-                v.texCoord = glm::vec2(0.0f);
-            }
-            if (i < normals.size()) {
-                v.normal = normals[i];
+        // Vytvoření meshe
+        Mesh mesh(GL_TRIANGLES, shader, geometry, glm::vec3(0.0f), glm::vec3(0.0f));
+        meshes.push_back(mesh);
+        updateBounds();
+    }
+
+    // Model nad již načtenou geometrií (např. z AssetLoaderu)
+    Model(const std::string& name, ShaderProgram shader, std::shared_ptr<MeshGeometry> geometry) {
+        this->shader = shader;
+        this->name = name;
+
+        Mesh mesh(GL_TRIANGLES, shader, std::move(geometry), glm::vec3(0.0f), glm::vec3(0.0f));
+        meshes.push_back(mesh);
+        updateBounds();
+    }
+
+    // Sjednocení obalů geometrií meshů (po změně meshes je nutné zavolat znovu)
+    void updateBounds() {
+        bool first = true;
+        for (const auto& mesh : meshes) {
+            if (!mesh.geometry) {
+                continue;
             }
-            else {
-                v.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+            bounds_min = first ? mesh.geometry->bounds_min : glm::min(bounds_min, mesh.geometry->bounds_min);
+            bounds_max = first ? mesh.geometry->bounds_max : glm::max(bounds_max, mesh.geometry->bounds_max);
+            first = false;
+        }
+
+        // Koule se středem kvádru, která obsahuje koule všech meshů
+        sphere_center = (bounds_min + bounds_max) * 0.5f;
+        sphere_radius = 0.0f;
+        for (const auto& mesh : meshes) {
+            if (mesh.geometry) {
+                sphere_radius = std::max(sphere_radius,
+                    glm::distance(sphere_center, mesh.geometry->sphere_center) + mesh.geometry->sphere_radius);
             }
-            mesh_vertices.push_back(v);
         }
+    }
 
-        // Vytvoen index - jednoduch sekvenn indexovn
-        std::vector<GLuint> indices;
-        for (GLuint i = 0; i < mesh_vertices.size(); i++) {
-            indices.push_back(i);
+    // Obalový kvádr ve world space - osově zarovnaný obal transformovaného lokálního kvádru (Arvo)
+    void getWorldBounds(glm::vec3& out_min, glm::vec3& out_max) const {
+        glm::mat4 model_matrix = getModelMatrix();
+        glm::vec3 translation = glm::vec3(model_matrix[3]);
+        out_min = out_max = translation;
+        for (int column = 0; column < 3; column++) {
+            glm::vec3 a = glm::vec3(model_matrix[column]) * bounds_min[column];
+            glm::vec3 b = glm::vec3(model_matrix[column]) * bounds_max[column];
+            out_min += glm::min(a, b);
+            out_max += glm::max(a, b);
         }
+    }
 
-        // Vytvoen meshe
-        Mesh mesh(GL_TRIANGLES, shader, mesh_vertices, indices, glm::vec3(0.0f), glm::vec3(0.0f));
-        meshes.push_back(mesh);
+    // Výběr varianty programu pro model i všechny jeho meshe (kopie jen při změně)
+    void setShader(const ShaderProgram& program) {
+        if (shader.getID() == program.getID()) {
+            return;
+        }
+        shader = program;
+        for (auto& mesh : meshes) {
+            mesh.setShader(program);
+        }
     }
 
     // update position etc. based on running time
     void update(const float delta_t) {
-        // Zde mete implementovat automatick animace
-        // Nap.: orientation.y += 1.0f * delta_t; // oten kolem Y osy
+        // Zde můžete implementovat automatické animace
+        // Např.: orientation.y += 1.0f * delta_t; // otáčení kolem Y osy
     }
 
-    // Metoda pro zskn model matice
+    // Metoda pro získání model matice
     glm::mat4 getModelMatrix() const {
-        // Vpoet kompletn transforman matice
+        // Výpočet kompletní transformační matice
         glm::mat4 t = glm::translate(glm::mat4(1.0f), origin);
         glm::mat4 rx = glm::rotate(glm::mat4(1.0f), orientation.x, glm::vec3(1.0f, 0.0f, 0.0f));
         glm::mat4 ry = glm::rotate(glm::mat4(1.0f), orientation.y, glm::vec3(0.0f, 1.0f, 0.0f));
@@ -87,21 +126,101 @@ public:
         return local_model_matrix * s * rz * ry * rx * t;
     }
 
+    // Normálová matice (inverze transpozice model matice) - počítá se jednou na CPU, ne pro každý vrchol
+    glm::mat3 getNormalMatrix() const {
+        return glm::mat3(glm::transpose(glm::inverse(getModelMatrix())));
+    }
+
+    // Výběr LOD každého meshe podle promítnuté geometrické chyby (projekce + vzdálenost od kamery)
+    void selectLod(glm::mat4 const& projection, glm::vec3 const& camera_position, float viewport_height, float delta_t) {
+        glm::mat4 model_matrix = getModelMatrix();
+        float max_scale = std::max(glm::length(glm::vec3(model_matrix[0])),
+            std::max(glm::length(glm::vec3(model_matrix[1])), glm::length(glm::vec3(model_matrix[2]))));
+
+        for (auto& mesh : meshes) {
+            if (!mesh.geometry || mesh.geometry->lods.size() < 2) {
+                continue;
+            }
+            const MeshGeometry& geometry = *mesh.geometry;
+
+            // Vzdálenost kamery od obalové koule
+            glm::vec3 center = glm::vec3(model_matrix * glm::vec4((geometry.bounds_min + geometry.bounds_max) * 0.5f, 1.0f));
+            float radius = glm::length(geometry.bounds_max - geometry.bounds_min) * 0.5f * max_scale;
+            float distance = std::max(glm::distance(camera_position, center) - radius, 0.1f);
+
+            // Kolik pixelů má jednotka světa v této vzdálenosti
+            float pixels_per_unit = projection[1][1] * viewport_height * 0.5f / distance;
+
+            // Nejhrubší úroveň, jejíž chyba je pod prahem
+            size_t level = 0;
+            for (size_t i = 1; i < geometry.lods.size(); i++) {
+                if (geometry.lods[i].error * max_scale * pixels_per_unit > lod_pixel_error) {
+                    break;
+                }
+                level = i;
+            }
+
+            // Hystereze - návrat k detailnější úrovni až při zřetelném překročení prahu
+            if (level < mesh.lod && geometry.lods[mesh.lod].error * max_scale * pixels_per_unit < lod_pixel_error * 1.2f) {
+                level = mesh.lod;
+            }
+
+            if (level != mesh.lod) {
+                mesh.previous_lod = mesh.lod;
+                mesh.lod = level;
+                mesh.lod_fade = lod_crossfade ? 0.0f : 1.0f;
+            }
+            else if (mesh.lod_fade < 1.0f) {
+                mesh.lod_fade = std::min(1.0f, mesh.lod_fade + delta_t / LOD_FADE_TIME);
+            }
+        }
+    }
+
+    // Požadavek na rozlišení streamovaných textur podle velikosti meshe na obrazovce
+    void requestTextureDetail(glm::mat4 const& projection, glm::vec3 const& camera_position, float viewport_height) {
+        glm::mat4 model_matrix = getModelMatrix();
+        float max_scale = std::max(glm::length(glm::vec3(model_matrix[0])),
+            std::max(glm::length(glm::vec3(model_matrix[1])), glm::length(glm::vec3(model_matrix[2]))));
+
+        for (auto& mesh : meshes) {
+            if (!mesh.texture || !mesh.texture->streaming || !mesh.geometry) {
+                continue;
+            }
+            const MeshGeometry& geometry = *mesh.geometry;
+
+            // Průměr obalové koule v pixelech
+            glm::vec3 center = glm::vec3(model_matrix * glm::vec4((geometry.bounds_min + geometry.bounds_max) * 0.5f, 1.0f));
+            float radius = glm::length(geometry.bounds_max - geometry.bounds_min) * 0.5f * max_scale;
+            float distance = std::max(glm::distance(camera_position, center) - radius, 0.1f);
+            float screen_pixels = 2.0f * radius * projection[1][1] * viewport_height * 0.5f / distance;
+
+            TextureStreamer::getInstance()->request(*mesh.texture, screen_pixels);
+        }
+    }
+
     void draw(glm::vec3 const& offset = glm::vec3(0.0f),
         glm::vec3 const& rotation = glm::vec3(0.0f),
         glm::vec3 const& scale_change = glm::vec3(1.0f)) {
 
+        // Program se ještě sestavuje (asynchronní překlad) - model se v tomto snímku nevykreslí
+        if (!shader.ready()) {
+            return;
+        }
+
         // Aktivace shaderu
         shader.activate();
 
-        // Vykreslen vech mesh
+        // Vykreslení všech meshů
         for (auto& mesh : meshes) {
             mesh.draw();
         }
     }
 
-    // Peten draw s pmm zadnm model matice
+    // Přetížený draw s přímým zadáním model matice
     void draw(glm::mat4 const& model_matrix) {
+        if (!shader.ready()) {
+            return;
+        }
         shader.activate();
         for (auto& mesh : meshes) {
             mesh.draw();
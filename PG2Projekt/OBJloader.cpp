@@ -3,10 +3,17 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <thread>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include "OBJloader.hpp"
+#include "MappedFile.hpp"
 
-bool loadOBJ(
+bool loadOBJ_legacy(
     const std::string& path,
     std::vector<glm::vec3>& out_vertices,
     std::vector<glm::vec2>& out_uvs,
@@ -14,25 +21,25 @@ bool loadOBJ(
 ) {
     std::cout << "Loading OBJ file: " << path << std::endl;
 
-    // Vyitn vstupnch vektor
+    // Vyčištění výstupních vektorů
     out_vertices.clear();
     out_uvs.clear();
     out_normals.clear();
 
-    // Doasn vektory pro natn
+    // Dočasné vektory pro načítání
     std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
     std::vector<glm::vec3> temp_vertices;
     std::vector<glm::vec2> temp_uvs;
     std::vector<glm::vec3> temp_normals;
 
-    // Oteven souboru
+    // Otevření souboru
     std::ifstream file(path);
     if (!file.is_open()) {
         std::cerr << "Impossible to open the file: " << path << std::endl;
         return false;
     }
 
-    // Natn souboru po dcch
+    // Načítání souboru po řádcích
     std::string line;
     while (std::getline(file, line)) {
         std::istringstream iss(line);
@@ -46,42 +53,42 @@ bool loadOBJ(
             temp_vertices.push_back(vertex);
         }
         else if (prefix == "vt") {
-            // Texturovac koordinty
+            // Texturovací koordináty
             glm::vec2 uv;
             iss >> uv.x >> uv.y;
             temp_uvs.push_back(uv);
         }
         else if (prefix == "vn") {
-            // Normla
+            // Normála
             glm::vec3 normal;
             iss >> normal.x >> normal.y >> normal.z;
             temp_normals.push_back(normal);
         }
         else if (prefix == "f") {
-            // Ploka (trojhelnk)
+            // Ploška (trojúhelník)
             unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
             char slash;
 
-            // Parsovn formtu "f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3"
+            // Parsování formátu "f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3"
             for (int i = 0; i < 3; i++) {
                 iss >> vertexIndex[i] >> slash >> uvIndex[i] >> slash >> normalIndex[i];
 
-                // Konverze z 1-based na 0-based indexovn
+                // Konverze z 1-based na 0-based indexování
                 vertexIndices.push_back(vertexIndex[i] - 1);
                 uvIndices.push_back(uvIndex[i] - 1);
                 normalIndices.push_back(normalIndex[i] - 1);
             }
         }
-        // Ignorujeme ostatn typy dk (komente, nzvy skupin atd.)
+        // Ignorujeme ostatní typy řádků (komentáře, názvy skupin atd.)
     }
 
-    // Zpracovn indexovanch dat do linernho pole
+    // Zpracování indexovaných dat do lineárního pole
     for (unsigned int i = 0; i < vertexIndices.size(); i++) {
         unsigned int vertexIndex = vertexIndices[i];
         unsigned int uvIndex = uvIndices[i];
         unsigned int normalIndex = normalIndices[i];
 
-        // Kontrola platnosti index
+        // Kontrola platnosti indexů
         if (vertexIndex >= temp_vertices.size() ||
             uvIndex >= temp_uvs.size() ||
             normalIndex >= temp_normals.size()) {
@@ -96,4 +103,389 @@ bool loadOBJ(
 
     std::cout << "OBJ loaded successfully: " << out_vertices.size() << " vertices" << std::endl;
     return true;
-}
\ No newline at end of file
+}
+
+namespace {
+
+// Hodnota indexu, který v plošce chybí (např. vt v "f 1//3")
+constexpr int OBJ_MISSING = std::numeric_limits<int>::min();
+
+// Bity masky relativních indexů
+constexpr uint8_t REL_V = 1, REL_VT = 2, REL_VN = 4;
+
+// Výsledek parsování jednoho bloku souboru
+struct ObjChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjIndex> corners;
+    // Pro každý roh maska složek se zápornými (relativními) indexy - ty se po sloučení
+    // bloků posunou o počet prvků ve všech předchozích blocích
+    std::vector<uint8_t> relative;
+    bool error{ false };
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// Načtení jednoho čísla (from_chars nepřijímá úvodní '+')
+template <typename T>
+inline const char* parseNumber(const char* p, const char* end, T& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') {
+        p++;
+    }
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return nullptr;
+    }
+    return result.ptr;
+}
+
+// Roh plošky ve tvaru v, v/vt, v//vn nebo v/vt/vn
+inline const char* parseCorner(const char* p, const char* end, int& v, int& vt, int& vn) {
+    v = vt = vn = OBJ_MISSING;
+    p = parseNumber(p, end, v);
+    if (!p) {
+        return nullptr;
+    }
+    if (p < end && *p == '/') {
+        p++;
+        if (p < end && *p != '/') {
+            p = parseNumber(p, end, vt);
+            if (!p) {
+                return nullptr;
+            }
+        }
+        if (p < end && *p == '/') {
+            p = parseNumber(p + 1, end, vn);
+            if (!p) {
+                return nullptr;
+            }
+        }
+    }
+    return p;
+}
+
+// Převod indexu z OBJ (1-based, záporné = relativní) na 0-based index v rámci bloku
+inline bool resolveIndex(int& index, int local_count, uint8_t bit, uint8_t& relative) {
+    if (index == OBJ_MISSING) {
+        return true;
+    }
+    if (index > 0) {
+        index -= 1;
+        return true;
+    }
+    if (index < 0) {
+        index += local_count;
+        relative |= bit;
+        return true;
+    }
+    return false; // index 0 není v OBJ platný
+}
+
+void parseChunk(const char* begin, const char* end, ObjChunk& chunk) {
+    std::vector<ObjIndex> polygon;
+    std::vector<uint8_t> polygon_relative;
+
+    const char* line = begin;
+    while (line < end && !chunk.error) {
+        const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (!eol) {
+            eol = end;
+        }
+        const char* p = skipBlanks(line, eol);
+        size_t length = eol - p;
+
+        if (length > 1 && p[0] == 'v' && isBlank(p[1])) {
+            // Vrchol
+            glm::vec3 position;
+            p = parseNumber(p + 2, eol, position.x);
+            if (p) p = parseNumber(p, eol, position.y);
+            if (p) p = parseNumber(p, eol, position.z);
+            if (!p) {
+                chunk.error = true;
+                break;
+            }
+            chunk.positions.push_back(position);
+        }
+        else if (length > 2 && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+            // Texturovací koordináty (případná třetí složka se ignoruje)
+            glm::vec2 uv;
+            p = parseNumber(p + 3, eol, uv.x);
+            if (p) p = parseNumber(p, eol, uv.y);
+            if (!p) {
+                chunk.error = true;
+                break;
+            }
+            chunk.uvs.push_back(uv);
+        }
+        else if (length > 2 && p[0] == 'v' && p[1] == 'n' && isBlank(p[2])) {
+            // Normála
+            glm::vec3 normal;
+            p = parseNumber(p + 3, eol, normal.x);
+            if (p) p = parseNumber(p, eol, normal.y);
+            if (p) p = parseNumber(p, eol, normal.z);
+            if (!p) {
+                chunk.error = true;
+                break;
+            }
+            chunk.normals.push_back(normal);
+        }
+        else if (length > 1 && p[0] == 'f' && isBlank(p[1])) {
+            // Ploška s libovolným počtem rohů
+            polygon.clear();
+            polygon_relative.clear();
+            p += 2;
+            while (true) {
+                p = skipBlanks(p, eol);
+                if (p >= eol || *p == '#') {
+                    break;
+                }
+                ObjIndex corner;
+                uint8_t relative = 0;
+                p = parseCorner(p, eol, corner.v, corner.vt, corner.vn);
+                if (!p || corner.v == OBJ_MISSING ||
+                    !resolveIndex(corner.v, static_cast<int>(chunk.positions.size()), REL_V, relative) ||
+                    !resolveIndex(corner.vt, static_cast<int>(chunk.uvs.size()), REL_VT, relative) ||
+                    !resolveIndex(corner.vn, static_cast<int>(chunk.normals.size()), REL_VN, relative)) {
+                    chunk.error = true;
+                    break;
+                }
+                polygon.push_back(corner);
+                polygon_relative.push_back(relative);
+            }
+
+            // Triangulace vějířem (pro trojúhelník jen zkopíruje rohy)
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i]);
+                chunk.corners.push_back(polygon[i + 1]);
+                chunk.relative.push_back(polygon_relative[0]);
+                chunk.relative.push_back(polygon_relative[i]);
+                chunk.relative.push_back(polygon_relative[i + 1]);
+            }
+        }
+        // Ostatní typy řádků (komentáře, o, g, s, usemtl...) ignorujeme
+
+        line = eol + 1;
+    }
+}
+
+// Převod na výsledný index: posun relativních indexů, kontrola rozsahu, -1 pro chybějící složku
+inline bool finishIndex(int& index, bool relative, int base, size_t count) {
+    if (index == OBJ_MISSING) {
+        index = -1;
+        return true;
+    }
+    if (relative) {
+        index += base;
+    }
+    return index >= 0 && static_cast<size_t>(index) < count;
+}
+
+} // namespace
+
+bool parseOBJ(const std::string& path, ObjData& out, unsigned int thread_count) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    out.positions.clear();
+    out.uvs.clear();
+    out.normals.clear();
+    out.corners.clear();
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Impossible to open the file: " << path << std::endl;
+        return false;
+    }
+    const char* data = file.data();
+    const char* data_end = data + file.size();
+
+    // Počet bloků - podle počtu jader, ale bloky ne menší než 64 KB
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t max_chunks = std::max<size_t>(1, file.size() / (64 * 1024));
+    size_t chunk_count = std::min<size_t>(thread_count, max_chunks);
+
+    // Rozdělení souboru na bloky zarovnané na konce řádků
+    std::vector<std::pair<const char*, const char*>> ranges;
+    const char* chunk_begin = data;
+    for (size_t i = 0; i < chunk_count && chunk_begin < data_end; i++) {
+        const char* chunk_end = data_end;
+        if (i + 1 < chunk_count) {
+            chunk_end = std::min(data_end, chunk_begin + file.size() / chunk_count);
+            const char* newline = static_cast<const char*>(std::memchr(chunk_end, '\n', data_end - chunk_end));
+            chunk_end = newline ? newline + 1 : data_end;
+        }
+        ranges.emplace_back(chunk_begin, chunk_end);
+        chunk_begin = chunk_end;
+    }
+
+    // Paralelní parsování - první blok zpracuje volající vlákno
+    std::vector<ObjChunk> chunks(ranges.size());
+    std::vector<std::thread> workers;
+    auto work = [&](size_t i) {
+        try {
+            parseChunk(ranges[i].first, ranges[i].second, chunks[i]);
+        }
+        catch (const std::exception&) {
+            chunks[i].error = true;
+        }
+    };
+    for (size_t i = 1; i < ranges.size(); i++) {
+        workers.emplace_back(work, i);
+    }
+    if (!ranges.empty()) {
+        work(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Sloučení bloků
+    size_t total_positions = 0, total_uvs = 0, total_normals = 0, total_corners = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.error) {
+            std::cerr << "Invalid line in OBJ file: " << path << std::endl;
+            return false;
+        }
+        total_positions += chunk.positions.size();
+        total_uvs += chunk.uvs.size();
+        total_normals += chunk.normals.size();
+        total_corners += chunk.corners.size();
+    }
+    out.positions.reserve(total_positions);
+    out.uvs.reserve(total_uvs);
+    out.normals.reserve(total_normals + total_corners / 3);
+    out.corners.reserve(total_corners);
+
+    int base_v = 0, base_vt = 0, base_vn = 0;
+    for (const auto& chunk : chunks) {
+        out.positions.insert(out.positions.end(), chunk.positions.begin(), chunk.positions.end());
+        out.uvs.insert(out.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        out.normals.insert(out.normals.end(), chunk.normals.begin(), chunk.normals.end());
+
+        for (size_t i = 0; i < chunk.corners.size(); i++) {
+            ObjIndex corner = chunk.corners[i];
+            uint8_t relative = chunk.relative[i];
+            // Pozice je povinná, UV a normála mohou chybět
+            if (corner.v == OBJ_MISSING ||
+                !finishIndex(corner.v, relative & REL_V, base_v, total_positions) ||
+                !finishIndex(corner.vt, relative & REL_VT, base_vt, total_uvs) ||
+                !finishIndex(corner.vn, relative & REL_VN, base_vn, total_normals)) {
+                std::cerr << "Invalid index in OBJ file: " << path << std::endl;
+                return false;
+            }
+            out.corners.push_back(corner);
+        }
+
+        base_v += static_cast<int>(chunk.positions.size());
+        base_vt += static_cast<int>(chunk.uvs.size());
+        base_vn += static_cast<int>(chunk.normals.size());
+    }
+
+    // Plošky bez normál - dopočítáme normálu plošky
+    for (size_t t = 0; t + 2 < out.corners.size(); t += 3) {
+        ObjIndex* tri = &out.corners[t];
+        if (tri[0].vn >= 0 && tri[1].vn >= 0 && tri[2].vn >= 0) {
+            continue;
+        }
+        glm::vec3 edge1 = out.positions[tri[1].v] - out.positions[tri[0].v];
+        glm::vec3 edge2 = out.positions[tri[2].v] - out.positions[tri[0].v];
+        glm::vec3 normal = glm::cross(edge1, edge2);
+        float length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        int normal_index = static_cast<int>(out.normals.size());
+        out.normals.push_back(normal);
+        for (int c = 0; c < 3; c++) {
+            if (tri[c].vn < 0) {
+                tri[c].vn = normal_index;
+            }
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "OBJ parsed: " << path << " (" << out.corners.size() / 3 << " triangles, "
+        << ranges.size() << " chunks, "
+        << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms)" << std::endl;
+    return true;
+}
+
+bool loadOBJ(
+    const std::string& path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals
+) {
+    out_vertices.clear();
+    out_uvs.clear();
+    out_normals.clear();
+
+    ObjData data;
+    if (!parseOBJ(path, data)) {
+        return false;
+    }
+
+    // Zpracování indexovaných dat do lineárního pole
+    out_vertices.reserve(data.corners.size());
+    out_uvs.reserve(data.corners.size());
+    out_normals.reserve(data.corners.size());
+    for (const auto& corner : data.corners) {
+        out_vertices.push_back(data.positions[corner.v]);
+        out_uvs.push_back(corner.vt >= 0 ? data.uvs[corner.vt] : glm::vec2(0.0f));
+        out_normals.push_back(data.normals[corner.vn]);
+    }
+    return true;
+}
+
+void benchmarkOBJ(const std::string& path, int iterations) {
+    using clock = std::chrono::high_resolution_clock;
+    iterations = std::max(1, iterations);
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    size_t legacy_count = 0, new_count = 0;
+    bool legacy_ok = true, new_ok = true;
+
+    // Loadery vypisují průběh - během měření výstup potlačíme
+    std::ostringstream sink;
+    std::streambuf* cout_buffer = std::cout.rdbuf(sink.rdbuf());
+
+    auto legacy_start = clock::now();
+    for (int i = 0; i < iterations; i++) {
+        legacy_ok = loadOBJ_legacy(path, vertices, uvs, normals) && legacy_ok;
+        legacy_count = vertices.size();
+    }
+    auto legacy_end = clock::now();
+
+    for (int i = 0; i < iterations; i++) {
+        new_ok = loadOBJ(path, vertices, uvs, normals) && new_ok;
+        new_count = vertices.size();
+    }
+    auto new_end = clock::now();
+
+    std::cout.rdbuf(cout_buffer);
+
+    double legacy_ms = std::chrono::duration<double, std::milli>(legacy_end - legacy_start).count() / iterations;
+    double new_ms = std::chrono::duration<double, std::milli>(new_end - legacy_end).count() / iterations;
+
+    std::cout << "OBJ benchmark: " << path << " (" << iterations << " iterations)" << std::endl;
+    std::cout << "  legacy loadOBJ: " << legacy_ms << " ms" << (legacy_ok ? "" : " (FAILED)")
+        << ", " << legacy_count << " vertices" << std::endl;
+    std::cout << "  parallel loadOBJ: " << new_ms << " ms" << (new_ok ? "" : " (FAILED)")
+        << ", " << new_count << " vertices, " << std::thread::hardware_concurrency() << " threads" << std::endl;
+    if (new_ms > 0.0) {
+        std::cout << "  speedup: " << legacy_ms / new_ms << "x" << std::endl;
+    }
+}
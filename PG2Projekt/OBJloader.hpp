@@ -8,9 +8,42 @@
 #include <glm/glm.hpp>
 #include "assets.hpp"
 
+// Index rohu plošky do polí pozic / UV / normál (0-based, -1 = složka chybí)
+struct ObjIndex {
+    int v{ -1 };
+    int vt{ -1 };
+    int vn{ -1 };
+};
+
+// Indexovaná data OBJ souboru - plošky jsou triangulované (3 rohy na trojúhelník)
+struct ObjData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjIndex> corners;
+};
+
+// Rychlý parser: soubor se namapuje do paměti, rozdělí na bloky zarovnané na konce řádků
+// a bloky se parsují paralelně (std::from_chars). Podporuje záporné (relativní) indexy,
+// n-úhelníky (triangulace vějířem) a plošky bez vt/vn (chybějící normály se dopočítají).
+// thread_count = 0 -> podle počtu jader
+bool parseOBJ(const std::string& path, ObjData& out, unsigned int thread_count = 0);
+
+// Neindexovaný výstup (3 vrcholy na trojúhelník) - postavený nad parseOBJ
 bool loadOBJ(
     const std::string& path,
     std::vector<glm::vec3>& out_vertices,
     std::vector<glm::vec2>& out_uvs,
     std::vector<glm::vec3>& out_normals
-);
\ No newline at end of file
+);
+
+// Původní implementace (getline + istringstream) - ponechaná pro srovnání v benchmarku
+bool loadOBJ_legacy(
+    const std::string& path,
+    std::vector<glm::vec3>& out_vertices,
+    std::vector<glm::vec2>& out_uvs,
+    std::vector<glm::vec3>& out_normals
+);
+
+// Benchmark nového parseru proti původní implementaci (spouští se z main: --bench-obj <soubor> [opakování])
+void benchmarkOBJ(const std::string& path, int iterations = 10);
@@ -223,11 +223,7 @@ void ParticleSystem::Update(float deltaTime) {
     }
 }
 
-void ParticleSystem::Draw() {
-    // Nastavení potřebných OpenGL stavů
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
+void ParticleSystem::Submit(RenderQueue& queue) {
     // Vykreslení všech aktivních částic
     for (const auto& p : particles) {
         if (p.active) {
@@ -246,15 +242,11 @@ void ParticleSystem::Draw() {
 
                         model = glm::scale(model, fragment.scale);
 
-                        // Nastavení modelové matice ve shaderu
-                        shader.setUniform("uM_m", model);
-
                         // Nastavení průhlednosti
                         glm::vec4 color = glm::vec4(0.8f, 0.2f, 0.2f, fragment.alpha); // Červená barva pro fragmenty
-                        shader.setUniform("u_diffuse_color", color);
 
-                        // Vykreslení modelu částice
-                        particleModel->draw();
+                        // Zařazení modelu částice (blending a pořadí podle hloubky řeší fronta)
+                        queue.submit(RenderPass::Transparent, shader, particleModel, model, color);
                     }
                 }
             }
@@ -270,19 +262,12 @@ void ParticleSystem::Draw() {
 
                 model = glm::scale(model, p.scale);
 
-                // Nastavení modelové matice ve shaderu
-                shader.setUniform("uM_m", model);
-
                 // Nastavení průhlednosti
                 glm::vec4 color = glm::vec4(0.2f, 0.4f, 0.9f, p.alpha); // Modrá barva pro hlavní částice
-                shader.setUniform("u_diffuse_color", color);
 
-                // Vykreslení modelu částice
-                particleModel->draw();
+                // Zařazení modelu částice
+                queue.submit(RenderPass::Transparent, shader, particleModel, model, color);
             }
         }
     }
-
-    // Obnovení původních nastavení OpenGL
-    glDisable(GL_BLEND);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include "ShaderProgram.hpp"
 #include "Model.hpp"
+#include "RenderQueue.hpp"
 
 // Třída reprezentující jednu částici fontány
 class Particle {
@@ -73,8 +74,8 @@ public:
     // Aktualizuje všechny částice
     void Update(float deltaTime);
 
-    // Vykreslí všechny částice
-    void Draw();
+    // Zařadí všechny částice do fronty vykreslení (průhledný průchod)
+    void Submit(RenderQueue& queue);
 
     // Exploduj částici při dopadu
     void ExplodeParticle(int index);
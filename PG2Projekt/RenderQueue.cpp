@@ -0,0 +1,209 @@
+﻿#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <glm/gtc/matrix_inverse.hpp>
+#include "GLState.hpp"
+#include "GpuCuller.hpp"
+#include "InstanceBatch.hpp"
+#include "Model.hpp"
+
+void RenderQueue::begin(const glm::vec3& camera_position, float max_depth) {
+    items.clear();
+    entries.clear();
+    // Sloty platí jen pro snímek - uvolněný objekt, jehož adresu nebo GL jméno dostane nový,
+    // nezdědí starý slot a mapy nerostou přes opakovaná načtení
+    for (auto& map : slots) {
+        map.clear();
+    }
+    this->camera_position = camera_position;
+    this->max_depth = std::max(max_depth, 1e-3f);
+}
+
+uint32_t RenderQueue::slot(int kind, uint64_t object, int bits) {
+    if (object == 0) {
+        return 0;
+    }
+    auto& map = slots[kind];
+    auto found = map.find(object);
+    if (found != map.end()) {
+        return found->second;
+    }
+    // 0 je vyhrazená pro "žádný", po vyčerpání rozsahu se čísla opakují (jen horší řazení, ne chyba)
+    uint32_t value = static_cast<uint32_t>(map.size() % ((1u << bits) - 1)) + 1;
+    map.emplace(object, value);
+    return value;
+}
+
+uint64_t RenderQueue::makeKey(RenderPass pass, uint32_t program, uint32_t texture, uint32_t mesh, float distance) const {
+    const uint64_t depth_max = (1ull << DEPTH_BITS) - 1;
+    uint64_t depth = static_cast<uint64_t>(std::clamp(distance / max_depth, 0.0f, 1.0f) * depth_max);
+
+    uint64_t state = (static_cast<uint64_t>(program) << (TEXTURE_BITS + MESH_BITS)) |
+        (static_cast<uint64_t>(texture) << MESH_BITS) | mesh;
+    uint64_t key = static_cast<uint64_t>(pass) << 62;
+    if (pass == RenderPass::Transparent) {
+        // Vzdálenější dřív - hloubka obrácená a nad stavem
+        key |= (depth_max - depth) << (PROGRAM_BITS + TEXTURE_BITS + MESH_BITS);
+        key |= state;
+    }
+    else {
+        key |= state << DEPTH_BITS;
+        key |= depth;
+    }
+    return key;
+}
+
+void RenderQueue::push(RenderPass pass, const RenderItem& item, const void* texture, const void* mesh, float distance) {
+    uint64_t key = makeKey(pass, slot(0, item.program->getID(), PROGRAM_BITS),
+        slot(1, reinterpret_cast<uintptr_t>(texture), TEXTURE_BITS),
+        slot(2, reinterpret_cast<uintptr_t>(mesh), MESH_BITS), distance);
+    entries.push_back({ key, static_cast<uint32_t>(items.size()) });
+    items.push_back(item);
+}
+
+void RenderQueue::submit(RenderPass pass, const ShaderProgram& program, Model* model,
+    const glm::mat4& model_matrix, const glm::vec4& color) {
+    if (!model || model->meshes.empty()) {
+        return;
+    }
+    RenderItem item;
+    item.model = model;
+    item.program = &program;
+    item.model_matrix = model_matrix;
+    item.color = color;
+
+    const Mesh& mesh = model->meshes[0];
+    float distance = glm::distance(camera_position, glm::vec3(model_matrix[3]));
+    push(pass, item, mesh.texture.get(), mesh.geometry.get(), distance);
+}
+
+void RenderQueue::submit(RenderPass pass, const ShaderProgram& program, InstanceBatch* batch) {
+    if (!batch || batch->size() == 0) {
+        return;
+    }
+    RenderItem item;
+    item.batch = batch;
+    item.program = &program;
+
+    // Instance jsou rozeseté po scéně - řadí se jen podle stavu
+    const Mesh& mesh = batch->prototypeModel()->meshes[0];
+    push(pass, item, mesh.texture.get(), mesh.geometry.get(), 0.0f);
+}
+
+void RenderQueue::submit(RenderPass pass, const ShaderProgram& program, GpuCuller* culler) {
+    if (!culler || culler->objectCount() == 0) {
+        return;
+    }
+    RenderItem item;
+    item.culler = culler;
+    item.program = &program;
+
+    const Mesh& mesh = culler->prototypeModel()->meshes[0];
+    push(pass, item, mesh.texture.get(), mesh.geometry.get(), 0.0f);
+}
+
+void RenderQueue::radixSort() {
+    scratch.resize(entries.size());
+    SortEntry* source = entries.data();
+    SortEntry* target = scratch.data();
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (size_t i = 0; i < entries.size(); i++) {
+            counts[(source[i].key >> shift) & 0xFF]++;
+        }
+        // Všechny položky mají stejný bajt - průchod by nic nezměnil
+        if (counts[(source[0].key >> shift) & 0xFF] == entries.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (size_t i = 0; i < entries.size(); i++) {
+            target[counts[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+        std::swap(source, target);
+    }
+
+    if (source != entries.data()) {
+        std::copy(source, source + entries.size(), entries.data());
+    }
+}
+
+void RenderQueue::applyPass(RenderPass pass) {
+    GLState* state = GLState::getInstance();
+    switch (pass) {
+    case RenderPass::Opaque:
+        state->setBlend(false);
+        state->setDepthMask(true);
+        state->setDepthTest(true);
+        break;
+    case RenderPass::Transparent:
+        state->setBlend(true);
+        state->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        state->setDepthMask(false);
+        state->setDepthTest(true);
+        break;
+    }
+}
+
+void RenderQueue::execute() {
+    program_switches = 0;
+    if (entries.empty()) {
+        return;
+    }
+    radixSort();
+
+    // Handly uniforem objektu - zjistí se jen při změně programu
+    const ShaderProgram* program = nullptr;
+    Uniform<glm::mat4> model_uniform;
+    Uniform<glm::mat3> normal_uniform;
+    int pass = -1;
+
+    for (const SortEntry& entry : entries) {
+        const RenderItem& item = items[entry.index];
+
+        int item_pass = static_cast<int>(entry.key >> 62);
+        if (item_pass != pass) {
+            pass = item_pass;
+            applyPass(static_cast<RenderPass>(pass));
+        }
+
+        if (item.program != program) {
+            // Různé objekty mohou sdílet jeden GL program - počítá se jen skutečná změna
+            if (!program || item.program->getID() != program->getID()) {
+                program_switches++;
+            }
+            program = item.program;
+            model_uniform = program->uniform<glm::mat4>("uM_m");
+            normal_uniform = program->uniform<glm::mat3>("uN_m");
+        }
+
+        if (item.batch) {
+            item.batch->setShader(*program);
+            item.batch->draw();
+            continue;
+        }
+        if (item.culler) {
+            item.culler->draw(*program);
+            continue;
+        }
+
+        item.model->setShader(*program);
+        program->set(model_uniform, item.model_matrix);
+        if (normal_uniform.valid()) {
+            program->set(normal_uniform, glm::mat3(glm::inverseTranspose(item.model_matrix)));
+        }
+        for (auto& mesh : item.model->meshes) {
+            mesh.diffuse_material = item.color;
+        }
+        item.model->draw();
+    }
+
+    // Výchozí stav pro zbytek snímku (text, menu)
+    applyPass(RenderPass::Opaque);
+}
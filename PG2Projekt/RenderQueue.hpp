@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "ShaderProgram.hpp"
+
+class Model;
+class InstanceBatch;
+class GpuCuller;
+
+// Průchody v pořadí vykreslení (nejvyšší bity klíče)
+enum class RenderPass : uint8_t {
+    Opaque = 0,      // bez blendingu, zápis hloubky, zepředu dozadu
+    Transparent = 1  // blending, bez zápisu hloubky, zezadu dopředu
+};
+
+// Jedno vykreslení ve frontě - model s vlastní maticí a barvou, instancovaná skupina,
+// nebo objekty ořezané na GPU (multi-draw indirect).
+// Barva se předá jako diffuse materiál meshů modelu (Mesh ji nastaví do u_diffuse_color).
+struct RenderItem {
+    Model* model{ nullptr };
+    InstanceBatch* batch{ nullptr };
+    GpuCuller* culler{ nullptr };
+    const ShaderProgram* program{ nullptr };
+    glm::mat4 model_matrix{ 1.0f };
+    glm::vec4 color{ 1.0f };
+};
+
+// Fronta vykreslení s 64bitovými řadicími klíči. Klíč skládá průchod, program, texturu, mesh
+// a kvantovanou hloubku tak, aby seřazení klíčů dalo pořadí s nejmenším počtem změn stavu:
+//   Opaque:       pass(2) | program(10) | textura(14) | mesh(14) | hloubka(24)   - zepředu dozadu
+//   Transparent:  pass(2) | ~hloubka(24) | program(10) | textura(14) | mesh(14)  - zezadu dopředu
+// Řazení je LSD radix sort po bajtech (bajty stejné u všech položek se přeskočí).
+class RenderQueue {
+public:
+    // Začátek snímku - vyprázdnění fronty, pozice kamery a rozsah hloubky pro kvantování
+    void begin(const glm::vec3& camera_position, float max_depth);
+
+    void submit(RenderPass pass, const ShaderProgram& program, Model* model,
+        const glm::mat4& model_matrix, const glm::vec4& color);
+    void submit(RenderPass pass, const ShaderProgram& program, InstanceBatch* batch);
+    void submit(RenderPass pass, const ShaderProgram& program, GpuCuller* culler);
+
+    // Seřazení klíčů a vykreslení s minimem přechodů stavu (program, textury, blending, hloubka)
+    void execute();
+
+    size_t size() const { return items.size(); }
+    // Počet skutečných přepnutí GL programu v posledním execute()
+    uint32_t programSwitches() const { return program_switches; }
+
+private:
+    static constexpr int PROGRAM_BITS = 10;
+    static constexpr int TEXTURE_BITS = 14;
+    static constexpr int MESH_BITS = 14;
+    static constexpr int DEPTH_BITS = 24;
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index; // do items
+    };
+
+    std::vector<RenderItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch; // pomocné pole radix sortu
+
+    // Malá čísla pro programy (GL jméno), textury a meshe (ukazatel) - pro klíč jsou moc velké.
+    // Přidělují se v pořadí odeslání a v begin() se zahodí (řazení potřebuje jen shodu v rámci snímku).
+    std::unordered_map<uint64_t, uint32_t> slots[3];
+
+    glm::vec3 camera_position{ 0.0f };
+    float max_depth{ 1.0f };
+    uint32_t program_switches{ 0 };
+
+    uint32_t slot(int kind, uint64_t object, int bits);
+    uint64_t makeKey(RenderPass pass, uint32_t program, uint32_t texture, uint32_t mesh, float distance) const;
+    void push(RenderPass pass, const RenderItem& item, const void* texture, const void* mesh, float distance);
+
+    void radixSort();
+    static void applyPass(RenderPass pass);
+};
@@ -0,0 +1,403 @@
+﻿#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <iomanip>
+#include <glm/glm.hpp>
+#include <opencv2/opencv.hpp>
+#include "ResourceManager.hpp"
+#include "OBJloader.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshCache.hpp"
+#include "MeshSimplifier.hpp"
+#include "TextureStreamer.hpp"
+
+ResourceManager* ResourceManager::instance = nullptr;
+
+namespace {
+
+// Hash vrcholu podle bitové reprezentace všech složek
+struct VertexHash {
+    size_t operator()(const vertex& v) const {
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(&v);
+        size_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(vertex) / sizeof(uint32_t); i++) {
+            hash = (hash ^ words[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const vertex& a, const vertex& b) const {
+        return std::memcmp(&a, &b, sizeof(vertex)) == 0;
+    }
+};
+
+} // namespace
+
+void ResourceManager::deduplicateVertices(const ObjData& obj, std::vector<vertex>& out_vertices, std::vector<GLuint>& out_indices) {
+    out_vertices.clear();
+    out_indices.clear();
+    out_indices.reserve(obj.corners.size());
+    out_vertices.reserve(obj.corners.size() / 2);
+
+    std::unordered_map<vertex, GLuint, VertexHash, VertexEqual> unique;
+    unique.reserve(obj.corners.size());
+
+    for (const auto& corner : obj.corners) {
+        vertex v;
+        v.position = obj.positions[corner.v];
+        v.normal = obj.normals[corner.vn];
+        v.texCoord = corner.vt >= 0 ? obj.uvs[corner.vt] : glm::vec2(0.0f);
+
+        auto inserted = unique.emplace(v, static_cast<GLuint>(out_vertices.size()));
+        if (inserted.second) {
+            out_vertices.push_back(v);
+        }
+        out_indices.push_back(inserted.first->second);
+    }
+}
+
+ResourceManager* ResourceManager::getInstance() {
+    if (!instance) {
+        instance = new ResourceManager();
+    }
+    return instance;
+}
+
+std::string ResourceManager::pathKey(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    if (ec) {
+        canonical = path.lexically_normal();
+    }
+    return canonical.generic_string();
+}
+
+std::string ResourceManager::meshKey(const std::filesystem::path& path, const MeshImportOptions& options) {
+    // Klíč = cesta + volby importu (VAO je sdílený pro formát vrcholů, na shaderu nezáleží)
+    return pathKey(path) + options.key();
+}
+
+std::shared_ptr<MeshGeometry> ResourceManager::findMeshGeometry(const std::filesystem::path& path,
+    const MeshImportOptions& options) {
+    meshRequests++;
+    auto it = meshCache.find(meshKey(path, options));
+    if (it != meshCache.end()) {
+        return it->second.lock();
+    }
+    return nullptr;
+}
+
+std::shared_ptr<MeshGeometry> ResourceManager::getMeshGeometry(const std::filesystem::path& path,
+    const MeshImportOptions& options) {
+    if (auto geometry = findMeshGeometry(path, options)) {
+        return geometry;
+    }
+
+    MeshImportData data;
+    importMeshData(path, options, data);
+    return addMeshGeometry(path, options, data);
+}
+
+std::shared_ptr<MeshGeometry> ResourceManager::addMeshGeometry(const std::filesystem::path& path,
+    const MeshImportOptions& options, MeshImportData& data) {
+    std::shared_ptr<MeshGeometry> geometry;
+    if (data.from_cache) {
+        // Namapovaná binární cache - data jdou rovnou do GPU bufferů
+        const MeshCacheHeader& header = *data.cached.header;
+        geometry = std::make_shared<MeshGeometry>(data.cached.format, data.cached.vertices, header.vertex_count,
+            data.cached.indices, header.index_count, header.index_type,
+            glm::vec3(header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]),
+            glm::vec3(header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]),
+            data.cached.lods());
+        data.cached.file.close();
+        cacheHits++;
+    }
+    else {
+        geometry = std::make_shared<MeshGeometry>(data.vertices, data.indices, data.lods, data.format);
+    }
+
+    meshCache[meshKey(path, options)] = geometry;
+    meshLoads++;
+    return geometry;
+}
+
+void ResourceManager::importMeshData(const std::filesystem::path& path, const MeshImportOptions& options, MeshImportData& out) {
+    // Binární cache - soubor se jen namapuje
+    if (MeshCache::load(path, options.key(), out.cached)) {
+        const MeshCacheHeader& header = *out.cached.header;
+        std::cout << "Mesh " << path.filename().string() << ": " << header.vertex_count << " vertices, "
+            << header.index_count << " indices from cache" << std::endl;
+        out.from_cache = true;
+        return;
+    }
+
+    // Načtení OBJ souboru (indexovaná data)
+    ObjData obj;
+    if (!parseOBJ(path.string(), obj)) {
+        throw std::runtime_error("Failed to load OBJ file: " + path.string());
+    }
+
+    // Deduplikace vrcholů - stejná trojice pozice/normála/UV dostane jeden index
+    std::vector<vertex>& mesh_vertices = out.vertices;
+    std::vector<GLuint>& indices = out.indices;
+    deduplicateVertices(obj, mesh_vertices, indices);
+
+    double ratio = mesh_vertices.empty() ? 1.0 : static_cast<double>(indices.size()) / mesh_vertices.size();
+    std::cout << "Mesh " << path.filename().string() << ": " << indices.size() << " corners -> "
+        << mesh_vertices.size() << " unique vertices (dedup ratio " << ratio << "x, "
+        << (mesh_vertices.size() <= 65536 ? 16 : 32) << "-bit indices)" << std::endl;
+
+    // Volitelná optimalizace pořadí trojúhelníků a vrcholů
+    if (options.optimize) {
+        optimizeMesh(mesh_vertices, indices, path.filename().string());
+    }
+
+    // Úrovně detailu - každá další se zjednoduší z předchozí, indexy se připojí za sebe
+    out.lods.clear();
+    out.lods.push_back({ 0, indices.size(), 0.0f });
+    if (options.lod_levels > 1) {
+        generateLods(mesh_vertices, indices, out.lods, options, path.filename().string());
+    }
+
+    // Uložení pro další spuštění
+    out.format = options.quantize ? VertexFormat::Quantized : VertexFormat::Float;
+    MeshCache::store(path, options.key(), mesh_vertices, indices, out.lods, out.format);
+}
+
+void ResourceManager::generateLods(const std::vector<vertex>& vertices, std::vector<GLuint>& indices,
+    std::vector<MeshLod>& lods, const MeshImportOptions& options, const std::string& name) {
+    std::vector<GLuint> level(indices);
+    float error = 0.0f;
+
+    std::cout << "Mesh " << name << " LODs: " << level.size() / 3;
+    for (int i = 1; i < options.lod_levels && lods.size() < MeshCacheHeader::MAX_LODS; i++) {
+        float level_error = 0.0f;
+        size_t target = static_cast<size_t>(level.size() * options.lod_ratio) / 3 * 3;
+        std::vector<GLuint> simplified = simplifyMesh(vertices, level, target, level_error);
+
+        // Síť už nejde rozumně zjednodušit (zamčené hrany, malý mesh)
+        if (simplified.empty() || simplified.size() > level.size() * 0.9) {
+            break;
+        }
+        if (options.optimize) {
+            optimizeVertexCache(simplified, vertices.size());
+        }
+
+        // Chyba se sčítá - úroveň vznikla z předchozí, ne z plného rozlišení
+        error += level_error;
+        lods.push_back({ indices.size(), simplified.size(), error });
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+        level.swap(simplified);
+
+        std::cout << " -> " << level.size() / 3 << " (err " << error << ")";
+    }
+    std::cout << " triangles" << std::endl;
+}
+
+std::string ResourceManager::textureKey(const std::filesystem::path& path, const TextureOptions& options) {
+    return pathKey(path) + options.key();
+}
+
+std::shared_ptr<Texture> ResourceManager::findTexture(const std::filesystem::path& path, const TextureOptions& options) {
+    textureRequests++;
+    auto it = textureCache.find(textureKey(path, options));
+    if (it != textureCache.end()) {
+        if (auto texture = it->second.lock()) {
+            textureHits++;
+            return texture;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Texture> ResourceManager::getTexture(const std::filesystem::path& path, const TextureOptions& options) {
+    if (auto texture = findTexture(path, options)) {
+        return texture;
+    }
+
+    TextureImportData data;
+    loadTextureData(path, options, data);
+    return addTexture(path, options, data);
+}
+
+void ResourceManager::normalizeImage(cv::Mat& image) {
+    // 16bitové kanály (např. box.png) -> 8 bitů
+    if (image.depth() == CV_16U) {
+        cv::Mat converted;
+        image.convertTo(converted, CV_8U, 1.0 / 257.0);
+        image = converted;
+    }
+    if (image.channels() == 1) {
+        cv::Mat converted;
+        cv::cvtColor(image, converted, cv::COLOR_GRAY2BGR);
+        image = converted;
+    }
+}
+
+void ResourceManager::loadTextureData(const std::filesystem::path& path, const TextureOptions& options, TextureImportData& out) {
+    const TextureCompression compression = options.compression;
+
+    // Zkomprimovaná data z předchozího spuštění - jen namapování souboru
+    if (compression != TextureCompression::None && TextureCache::load(path, options.compressionKey(), out.cached)) {
+        const TextureCacheHeader& header = *out.cached.header;
+        for (uint32_t level = 0; level < header.level_count; level++) {
+            out.levels.push_back({ std::max(1, static_cast<int>(header.pixel_width >> level)),
+                std::max(1, static_cast<int>(header.pixel_height >> level)),
+                out.cached.levelData(level), static_cast<size_t>(header.levels[level].byte_length) });
+        }
+        out.from_cache = true;
+        std::cout << "Texture " << path.filename().string() << ": " << compressionName(compression) << " "
+            << header.pixel_width << "x" << header.pixel_height << " from cache" << std::endl;
+        return;
+    }
+
+    cv::Mat image = cv::imread(path.string(), cv::IMREAD_UNCHANGED);
+    if (image.empty()) {
+        throw std::runtime_error("Nelze načíst texturu ze souboru: " + path.string());
+    }
+    prepareTextureData(image, options, out, path.filename().string());
+
+    if (compression != TextureCompression::None) {
+        TextureCache::store(path, options.compressionKey(), compression, out.levels[0].width, out.levels[0].height,
+            out.compressed);
+    }
+}
+
+void ResourceManager::prepareTextureData(const cv::Mat& source, const TextureOptions& options, TextureImportData& out,
+    const std::string& name) {
+    cv::Mat image = source;
+    normalizeImage(image);
+
+    RgbaImage rgba;
+    rgba.width = image.cols;
+    rgba.height = image.rows;
+    rgba.pixels.resize(static_cast<size_t>(rgba.width) * rgba.height * 4);
+    cv::Mat rgba_mat(image.rows, image.cols, CV_8UC4, rgba.pixels.data());
+    cv::cvtColor(image, rgba_mat, image.channels() == 4 ? cv::COLOR_BGRA2RGBA : cv::COLOR_BGR2RGBA);
+
+    // Mip řetězec na CPU (na GL vlákně se pak nic negeneruje)
+    if (options.mipmaps) {
+        out.mips = buildMipChain(std::move(rgba), options.mip_filter);
+    }
+    else {
+        out.mips.push_back(std::move(rgba));
+    }
+
+    if (options.compression == TextureCompression::None) {
+        for (const auto& level : out.mips) {
+            out.levels.push_back({ level.width, level.height, level.pixels.data(), level.pixels.size() });
+        }
+        return;
+    }
+
+    // Komprese: bloky BCn pro každou úroveň (paralelně po řádcích bloků)
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    size_t raw_bytes = 0, compressed_bytes = 0;
+    for (const auto& level : out.mips) {
+        out.compressed.push_back(compressImage(level, options.compression));
+        raw_bytes += level.pixels.size();
+        compressed_bytes += out.compressed.back().size();
+    }
+    for (size_t i = 0; i < out.mips.size(); i++) {
+        out.levels.push_back({ out.mips[i].width, out.mips[i].height, out.compressed[i].data(), out.compressed[i].size() });
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::cout << "Texture " << name << ": " << compressionName(options.compression) << " "
+        << out.mips[0].width << "x" << out.mips[0].height << ", " << out.mips.size() << " levels, "
+        << raw_bytes / 1024 << " KB -> " << compressed_bytes / 1024 << " KB in "
+        << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms" << std::endl;
+
+    // Nekomprimované úrovně už nejsou potřeba
+    out.mips.clear();
+}
+
+std::shared_ptr<Texture> ResourceManager::addTexture(const std::filesystem::path& path, const TextureOptions& options,
+    TextureImportData& data) {
+    std::shared_ptr<Texture> texture;
+    if (options.streaming) {
+        // Data všech úrovní (namapovaná cache / mipmapy v RAM) zůstávají u textury pro pozdější nahrávání
+        auto source = std::make_shared<TextureImportData>(std::move(data));
+        texture = std::make_shared<Texture>(path.filename().string(), source->levels, options, source);
+        TextureStreamer::getInstance()->add(texture);
+    }
+    else {
+        texture = std::make_shared<Texture>(path.filename().string(), data.levels, options);
+        data.cached.file.close();
+    }
+    textureCache[textureKey(path, options)] = texture;
+    textureLoads++;
+    return texture;
+}
+
+std::shared_ptr<Texture> ResourceManager::addTextureArray(const std::filesystem::path& path, const TextureOptions& options,
+    std::vector<TextureImportData>& layers) {
+    std::vector<std::vector<TextureLevelData>> layer_levels;
+    for (const auto& layer : layers) {
+        layer_levels.push_back(layer.levels);
+    }
+    auto texture = std::make_shared<Texture>(path.filename().string(), layer_levels, options);
+    textureCache[textureKey(path, options)] = texture;
+    textureLoads++;
+    return texture;
+}
+
+void ResourceManager::printTextureReport() const {
+    static const char* separator = "  ------------------------------------------------------------";
+    size_t total = 0;
+    std::cout << "Textures:" << std::endl;
+    std::cout << "  " << std::left << std::setw(20) << "name" << std::setw(16) << "size" << std::setw(8) << "format"
+        << std::setw(8) << "mips" << std::setw(12) << "KB" << "refs" << std::endl;
+    std::cout << separator << std::endl;
+    for (const auto& entry : textureCache) {
+        auto texture = entry.second.lock();
+        if (!texture) {
+            continue;
+        }
+        std::string size = std::to_string(texture->width) + "x" + std::to_string(texture->height);
+        if (texture->layers > 1) {
+            size += "x" + std::to_string(texture->layers);
+        }
+        // Streamovaná textura: nahrané / všechny úrovně
+        std::string mips = std::to_string(texture->levels);
+        if (texture->streaming) {
+            mips = std::to_string(texture->levels - texture->resident_level) + "/" + mips;
+        }
+        std::cout << "  " << std::setw(20) << texture->name << std::setw(16) << size
+            << std::setw(8) << compressionName(texture->compression) << std::setw(8) << mips << std::setw(12) << texture->gpuBytes() / 1024
+            << texture.use_count() - 1 << std::endl;
+        total += texture->gpuBytes();
+    }
+    std::cout << separator << std::endl;
+    std::cout << std::right << "  total " << total / 1024 << " KB" << std::endl;
+}
+
+void ResourceManager::printStats() const {
+    size_t liveMeshes = 0;
+    size_t gpuBytes = 0;
+    for (const auto& entry : meshCache) {
+        if (auto geometry = entry.second.lock()) {
+            liveMeshes++;
+            gpuBytes += geometry->gpuBytes();
+        }
+    }
+
+    size_t liveTextures = 0;
+    size_t textureBytes = 0;
+    for (const auto& entry : textureCache) {
+        if (auto texture = entry.second.lock()) {
+            liveTextures++;
+            textureBytes += texture->gpuBytes();
+        }
+    }
+
+    std::cout << "Resources: " << meshLoads << " mesh loads for " << meshRequests << " requests ("
+        << liveMeshes << " live, " << gpuBytes / 1024 << " KB on GPU, " << cacheHits << " from binary cache), "
+        << textureLoads << " texture loads for " << textureRequests << " requests ("
+        << textureHits << " hits, " << liveTextures << " live, " << textureBytes / 1024 << " KB on GPU)" << std::endl;
+}
@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <GL/glew.h>
+#include <opencv2/opencv.hpp>
+#include "Mesh.hpp"
+#include "Texture.hpp"
+#include "OBJloader.hpp"
+#include "MeshCache.hpp"
+#include "TextureCache.hpp"
+#include "ShaderProgram.hpp"
+
+// Volitelné kroky při importu meshe (součást klíče cache - stejný soubor
+// s jinými volbami je jiná geometrie)
+struct MeshImportOptions {
+    // Přeuspořádání indexů/vrcholů pro vertex cache, overdraw a fetch (MeshOptimizer)
+    bool optimize{ false };
+    // Počet úrovní detailu včetně plného rozlišení (1 = bez LOD) a poměr trojúhelníků mezi úrovněmi
+    int lod_levels{ 1 };
+    float lod_ratio{ 0.5f };
+    // Kompaktní formát vrcholů (packed_vertex, 16 B místo 32 B) - pro statickou geometrii
+    bool quantize{ false };
+
+    std::string key() const {
+        std::string key = optimize ? "|opt" : "";
+        if (quantize) {
+            key += "|q16";
+        }
+        if (lod_levels > 1) {
+            key += "|lod=" + std::to_string(lod_levels) + "x" + std::to_string(lod_ratio);
+        }
+        return key;
+    }
+};
+
+// Výsledek importu meshe na CPU (bez GL volání - může vzniknout na pracovním vlákně)
+struct MeshImportData {
+    bool from_cache{ false };
+    MeshCacheEntry cached; // platné, pokud from_cache
+
+    VertexFormat format{ VertexFormat::Float };
+    std::vector<vertex> vertices;
+    std::vector<GLuint> indices;
+    std::vector<MeshLod> lods;
+};
+
+// Výsledek načtení textury na CPU (bez GL volání - může vzniknout na pracovním vlákně)
+// - celý mip řetězec je hotový, GL vlákno ho jen nahraje
+struct TextureImportData {
+    std::vector<RgbaImage> mips; // nekomprimované úrovně RGBA8
+
+    // Zkomprimovaná textura - namapovaná z cache nebo právě zkomprimovaná
+    bool from_cache{ false };
+    TextureCacheEntry cached;
+    std::vector<std::vector<uint8_t>> compressed;
+
+    std::vector<TextureLevelData> levels; // ukazují do mips, cached nebo compressed
+};
+
+// Správce sdílených zdrojů - každý soubor (OBJ, textura) se načte a nahraje na GPU jen jednou.
+// Meshe jsou klíčované cestou + volbami importu (geometrie leží ve sdílených bufferech GeometryPool),
+// vrací se std::shared_ptr, takže místo na GPU se uvolní, až je nepoužívá žádný model.
+class ResourceManager {
+private:
+    static ResourceManager* instance;
+
+    ResourceManager() = default;
+
+    // Cache geometrií - weak_ptr, aby cache sama nedržela buffery naživu
+    std::unordered_map<std::string, std::weak_ptr<MeshGeometry>> meshCache;
+    // Cache textur (cesta + volby -> textura) - weak_ptr, textura se smaže s posledním uživatelem
+    std::unordered_map<std::string, std::weak_ptr<Texture>> textureCache;
+
+    // Statistiky
+    size_t meshRequests{ 0 };
+    size_t meshLoads{ 0 };
+    size_t cacheHits{ 0 };
+    size_t textureRequests{ 0 };
+    size_t textureLoads{ 0 };
+    size_t textureHits{ 0 };
+
+
+public:
+    static ResourceManager* getInstance();
+
+    // Normalizovaný klíč pro cestu k souboru
+    static std::string pathKey(const std::filesystem::path& path);
+
+    // Řetězec zjednodušených úrovní (QEM) připojený za indexy plného rozlišení
+    static void generateLods(const std::vector<vertex>& vertices, std::vector<GLuint>& indices,
+        std::vector<MeshLod>& lods, const MeshImportOptions& options, const std::string& name);
+
+    // Převod OBJ dat na kompaktní pole vrcholů + skutečný index buffer (hash deduplikace)
+    static void deduplicateVertices(const ObjData& obj, std::vector<vertex>& out_vertices, std::vector<GLuint>& out_indices);
+
+    static std::string meshKey(const std::filesystem::path& path, const MeshImportOptions& options);
+
+    // Geometrie pro daný OBJ soubor - při opakovaném požadavku vrací stejné GPU buffery (synchronně)
+    std::shared_ptr<MeshGeometry> getMeshGeometry(const std::filesystem::path& path,
+        const MeshImportOptions& options = MeshImportOptions());
+
+    // Už načtená geometrie - nullptr, pokud ještě není v cache
+    std::shared_ptr<MeshGeometry> findMeshGeometry(const std::filesystem::path& path, const MeshImportOptions& options);
+
+    // CPU část importu (binární cache nebo parsování OBJ + zpracování) - bezpečné volat z pracovního vlákna
+    static void importMeshData(const std::filesystem::path& path, const MeshImportOptions& options, MeshImportData& out);
+
+    // GL část importu - nahrání dat do GeometryPool a vložení do cache (jen GL vlákno)
+    std::shared_ptr<MeshGeometry> addMeshGeometry(const std::filesystem::path& path,
+        const MeshImportOptions& options, MeshImportData& data);
+
+    static std::string textureKey(const std::filesystem::path& path, const TextureOptions& options);
+
+    // Textura podle cesty a voleb - každý soubor se dekóduje a nahraje jen jednou (synchronně)
+    std::shared_ptr<Texture> getTexture(const std::filesystem::path& path,
+        const TextureOptions& options = TextureOptions());
+
+    // Už nahraná textura - nullptr, pokud ještě není v cache
+    std::shared_ptr<Texture> findTexture(const std::filesystem::path& path, const TextureOptions& options = TextureOptions());
+
+    // CPU část načtení (dekódování obrázku, případně komprese / cache) - bezpečné volat z pracovního vlákna
+    static void loadTextureData(const std::filesystem::path& path, const TextureOptions& options, TextureImportData& out);
+
+    // Obrázek OpenCV (BGR/BGRA/šedotónový, 8 nebo 16 bitů) -> RGBA8 mip řetězec (SIMD filtr),
+    // případně komprese BCn. Také pro textury vytvořené v paměti; name slouží jen pro výpis.
+    static void prepareTextureData(const cv::Mat& image, const TextureOptions& options, TextureImportData& out,
+        const std::string& name);
+
+    // Převod obrázku OpenCV na 8bitový BGR/BGRA (16bitové PNG, šedotónové obrázky)
+    static void normalizeImage(cv::Mat& image);
+
+    // GL část - nahrání připravených úrovní a vložení do cache (jen GL vlákno).
+    // Pro textury vytvořené v paměti je path jen jméno (klíč cache).
+    std::shared_ptr<Texture> addTexture(const std::filesystem::path& path, const TextureOptions& options, TextureImportData& data);
+    // Pole textur (vrstvy stejné velikosti) pod daným jménem
+    std::shared_ptr<Texture> addTextureArray(const std::filesystem::path& path, const TextureOptions& options,
+        std::vector<TextureImportData>& layers);
+
+    // Výpis všech živých textur (rozměr, formát, paměť, počet uživatelů)
+    void printTextureReport() const;
+
+    // Výpis statistik (unikátní assety vs. počet požadavků, paměť na GPU)
+    void printStats() const;
+};
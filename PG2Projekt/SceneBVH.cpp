@@ -0,0 +1,319 @@
+﻿#include "SceneBVH.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include "Model.hpp"
+
+// SSE2 je na x64 vždy k dispozici, na x86 podle přepínače /arch
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PG2_BVH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void SceneBVH::insert(Model* model) {
+    if (!model) {
+        return;
+    }
+    Object object;
+    object.model = model;
+    objects.push_back(object);
+    dirty = true;
+}
+
+void SceneBVH::remove(Model* model) {
+    auto found = std::find_if(objects.begin(), objects.end(),
+        [model](const Object& object) { return object.model == model; });
+    if (found == objects.end()) {
+        return;
+    }
+    *found = objects.back();
+    objects.pop_back();
+    dirty = true;
+}
+
+void SceneBVH::clear() {
+    objects.clear();
+    nodes.clear();
+    dirty = false;
+    refits_since_build = 0;
+    last_stats = CullStats();
+}
+
+bool SceneBVH::transformChanged(const Object& object) {
+    const Model& model = *object.model;
+    return model.origin != object.origin || model.orientation != object.orientation ||
+        model.scale != object.scale || model.local_model_matrix != object.local_model_matrix;
+}
+
+void SceneBVH::captureTransform(Object& object) {
+    const Model& model = *object.model;
+    object.origin = model.origin;
+    object.orientation = model.orientation;
+    object.scale = model.scale;
+    object.local_model_matrix = model.local_model_matrix;
+    model.getWorldBounds(object.bounds_min, object.bounds_max);
+}
+
+void SceneBVH::update() {
+    if (dirty) {
+        build();
+        return;
+    }
+
+    for (auto& object : objects) {
+        if (!transformChanged(object)) {
+            continue;
+        }
+        captureTransform(object);
+        refit(object.node, object.slot, object.bounds_min, object.bounds_max);
+        refits_since_build++;
+    }
+
+    // Upravované kvádry se nafukují (potomci se od sebe vzdálí) - po tolika úpravách,
+    // kolik je objektů, se strom příště postaví znovu
+    if (refits_since_build > std::max<size_t>(objects.size(), MIN_REFITS_BEFORE_REBUILD)) {
+        dirty = true;
+    }
+}
+
+void SceneBVH::build() {
+    nodes.clear();
+    dirty = false;
+    refits_since_build = 0;
+    if (objects.empty()) {
+        return;
+    }
+
+    for (auto& object : objects) {
+        captureTransform(object);
+    }
+    order.resize(objects.size());
+    std::iota(order.begin(), order.end(), 0u);
+    buildNode(0, order.size(), NO_PARENT, 0);
+}
+
+size_t SceneBVH::splitRange(size_t begin, size_t end) {
+    // Nejdelší osa středů kvádrů, dělení v mediánu
+    glm::vec3 centroid_min(FLT_MAX), centroid_max(-FLT_MAX);
+    for (size_t i = begin; i < end; i++) {
+        const Object& object = objects[order[i]];
+        glm::vec3 centroid = (object.bounds_min + object.bounds_max) * 0.5f;
+        centroid_min = glm::min(centroid_min, centroid);
+        centroid_max = glm::max(centroid_max, centroid);
+    }
+    glm::vec3 extent = centroid_max - centroid_min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    size_t mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [this, axis](uint32_t a, uint32_t b) {
+            return objects[a].bounds_min[axis] + objects[a].bounds_max[axis] <
+                objects[b].bounds_min[axis] + objects[b].bounds_max[axis];
+        });
+    return mid;
+}
+
+uint32_t SceneBVH::buildNode(size_t begin, size_t end, uint32_t parent, uint32_t parent_slot) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].parent = parent;
+    nodes[index].parent_slot = parent_slot;
+    for (uint32_t slot = 0; slot < 4; slot++) {
+        nodes[index].child[slot] = EMPTY;
+        setSlot(nodes[index], slot, glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX));
+    }
+
+    // Až 4 skupiny - do 4 objektů každý zvlášť, jinak dvojí dělení v mediánu
+    size_t count = end - begin;
+    size_t bounds[5];
+    size_t groups = std::min<size_t>(count, 4);
+    if (count <= 4) {
+        for (size_t i = 0; i <= count; i++) {
+            bounds[i] = begin + i;
+        }
+    }
+    else {
+        size_t mid = splitRange(begin, end);
+        bounds[0] = begin;
+        bounds[1] = splitRange(begin, mid);
+        bounds[2] = mid;
+        bounds[3] = splitRange(mid, end);
+        bounds[4] = end;
+    }
+
+    for (size_t group = 0; group < groups; group++) {
+        uint32_t slot = static_cast<uint32_t>(group);
+        if (bounds[group + 1] - bounds[group] == 1) {
+            uint32_t object_index = order[bounds[group]];
+            Object& object = objects[object_index];
+            object.node = index;
+            object.slot = slot;
+            nodes[index].child[slot] = LEAF | object_index;
+            setSlot(nodes[index], slot, object.bounds_min, object.bounds_max);
+        }
+        else {
+            // nodes se může realokovat - přístup až po návratu přes index
+            uint32_t child = buildNode(bounds[group], bounds[group + 1], index, slot);
+            glm::vec3 child_min, child_max;
+            nodeBounds(nodes[child], child_min, child_max);
+            nodes[index].child[slot] = child;
+            setSlot(nodes[index], slot, child_min, child_max);
+        }
+    }
+    return index;
+}
+
+void SceneBVH::setSlot(Node& node, uint32_t slot, const glm::vec3& box_min, const glm::vec3& box_max) {
+    node.min_x[slot] = box_min.x;
+    node.min_y[slot] = box_min.y;
+    node.min_z[slot] = box_min.z;
+    node.max_x[slot] = box_max.x;
+    node.max_y[slot] = box_max.y;
+    node.max_z[slot] = box_max.z;
+}
+
+void SceneBVH::nodeBounds(const Node& node, glm::vec3& out_min, glm::vec3& out_max) const {
+    out_min = glm::vec3(FLT_MAX);
+    out_max = glm::vec3(-FLT_MAX);
+    for (uint32_t slot = 0; slot < 4; slot++) {
+        if (node.child[slot] == EMPTY) {
+            continue;
+        }
+        out_min = glm::min(out_min, glm::vec3(node.min_x[slot], node.min_y[slot], node.min_z[slot]));
+        out_max = glm::max(out_max, glm::vec3(node.max_x[slot], node.max_y[slot], node.max_z[slot]));
+    }
+}
+
+void SceneBVH::refit(uint32_t node, uint32_t slot, const glm::vec3& box_min, const glm::vec3& box_max) {
+    glm::vec3 current_min = box_min;
+    glm::vec3 current_max = box_max;
+    while (node != NO_PARENT) {
+        Node& current = nodes[node];
+        setSlot(current, slot, current_min, current_max);
+        nodeBounds(current, current_min, current_max);
+        slot = current.parent_slot;
+        node = current.parent;
+    }
+}
+
+void SceneBVH::collect(uint32_t child, std::vector<Model*>& visible) {
+    if (child & LEAF) {
+        visible.push_back(objects[child & ~LEAF].model);
+        return;
+    }
+    for (uint32_t next : nodes[child].child) {
+        if (next != EMPTY) {
+            collect(next, visible);
+        }
+    }
+}
+
+void SceneBVH::cull(const Frustum& frustum, std::vector<Model*>& visible) {
+    visible.clear();
+    if (dirty) {
+        build();
+    }
+    CullStats stats;
+
+    // Pro každou rovinu je p-vrchol (nejdál ve směru normály) vybraný podle znamének normály -
+    // stejně pro všechny 4 kvádry uzlu, takže výběr je mimo SIMD smyčku
+    bool positive[6][3];
+    for (int p = 0; p < 6; p++) {
+        for (int axis = 0; axis < 3; axis++) {
+            positive[p][axis] = frustum.planes[p][axis] > 0.0f;
+        }
+    }
+
+    // Test 4 kvádrů uzlu proti jehlanu - bit i v outside: kvádr i je celý za některou rovinou,
+    // bit i v partial: kvádr i protíná některou rovinu (jinak je celý uvnitř)
+#ifdef PG2_BVH_SSE2
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+    for (int p = 0; p < 6; p++) {
+        plane_x[p] = _mm_set1_ps(frustum.planes[p].x);
+        plane_y[p] = _mm_set1_ps(frustum.planes[p].y);
+        plane_z[p] = _mm_set1_ps(frustum.planes[p].z);
+        plane_w[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    auto testNode = [&](const Node& node, int& outside, int& partial) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 box_min[3] = { _mm_load_ps(node.min_x), _mm_load_ps(node.min_y), _mm_load_ps(node.min_z) };
+        const __m128 box_max[3] = { _mm_load_ps(node.max_x), _mm_load_ps(node.max_y), _mm_load_ps(node.max_z) };
+        __m128 outside_mask = zero;
+        __m128 partial_mask = zero;
+        for (int p = 0; p < 6; p++) {
+            // p-vrchol a n-vrchol (nejblíž ve směru normály)
+            __m128 px = positive[p][0] ? box_max[0] : box_min[0];
+            __m128 py = positive[p][1] ? box_max[1] : box_min[1];
+            __m128 pz = positive[p][2] ? box_max[2] : box_min[2];
+            __m128 nx = positive[p][0] ? box_min[0] : box_max[0];
+            __m128 ny = positive[p][1] ? box_min[1] : box_max[1];
+            __m128 nz = positive[p][2] ? box_min[2] : box_max[2];
+
+            __m128 far_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], px), _mm_mul_ps(plane_y[p], py)),
+                _mm_add_ps(_mm_mul_ps(plane_z[p], pz), plane_w[p]));
+            __m128 near_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane_x[p], nx), _mm_mul_ps(plane_y[p], ny)),
+                _mm_add_ps(_mm_mul_ps(plane_z[p], nz), plane_w[p]));
+            outside_mask = _mm_or_ps(outside_mask, _mm_cmplt_ps(far_distance, zero));
+            partial_mask = _mm_or_ps(partial_mask, _mm_cmplt_ps(near_distance, zero));
+        }
+        outside = _mm_movemask_ps(outside_mask);
+        partial = _mm_movemask_ps(partial_mask);
+    };
+#else
+    auto testNode = [&](const Node& node, int& outside, int& partial) {
+        const float* box_min[3] = { node.min_x, node.min_y, node.min_z };
+        const float* box_max[3] = { node.max_x, node.max_y, node.max_z };
+        outside = 0;
+        partial = 0;
+        for (int p = 0; p < 6; p++) {
+            const glm::vec4& plane = frustum.planes[p];
+            for (int slot = 0; slot < 4; slot++) {
+                float far_distance = plane.w;
+                float near_distance = plane.w;
+                for (int axis = 0; axis < 3; axis++) {
+                    far_distance += plane[axis] * (positive[p][axis] ? box_max[axis][slot] : box_min[axis][slot]);
+                    near_distance += plane[axis] * (positive[p][axis] ? box_min[axis][slot] : box_max[axis][slot]);
+                }
+                outside |= (far_distance < 0.0f) << slot;
+                partial |= (near_distance < 0.0f) << slot;
+            }
+        }
+    };
+#endif
+
+    stack.clear();
+    if (!nodes.empty()) {
+        stack.push_back(0);
+    }
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        stats.nodes_tested++;
+
+        int outside = 0;
+        int partial = 0;
+        testNode(node, outside, partial);
+
+        for (uint32_t slot = 0; slot < 4; slot++) {
+            uint32_t child = node.child[slot];
+            if (child == EMPTY || (outside & (1 << slot))) {
+                continue;
+            }
+            if (child & LEAF) {
+                visible.push_back(objects[child & ~LEAF].model);
+            }
+            else if (partial & (1 << slot)) {
+                stack.push_back(child);
+            }
+            else {
+                // Celý podstrom uvnitř jehlanu
+                collect(child, visible);
+            }
+        }
+    }
+
+    stats.visible = static_cast<uint32_t>(visible.size());
+    stats.culled = static_cast<uint32_t>(objects.size() - visible.size());
+    last_stats = stats;
+}
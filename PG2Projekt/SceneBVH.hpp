@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.hpp"
+
+class Model;
+
+// Výsledek posledního cull() - pro měření (titulek okna)
+struct CullStats {
+    uint32_t visible{ 0 };
+    uint32_t culled{ 0 };
+    uint32_t nodes_tested{ 0 }; // uzly, jejichž 4 kvádry se testovaly proti rovinám
+};
+
+// Hierarchie obalových kvádrů scény pro ořezání pohledovým jehlanem na CPU. Uzly mají 4 potomky
+// s kvádry uloženými po složkách (SoA), takže jeden uzel se otestuje proti rovině 4 kvádry naráz
+// (SSE2). Podstrom celý uvnitř jehlanu se už netestuje. Posun objektu (origin, orientation, scale)
+// se pozná v update() a jen upraví kvádry na cestě ke kořeni; po mnoha úpravách se strom postaví znovu.
+class SceneBVH {
+public:
+    void insert(Model* model);
+    void remove(Model* model);
+    void clear();
+
+    // Zjištění změněných transformací a úprava stromu - jednou za snímek před cull()
+    void update();
+    // Viditelné modely do visible (obsah se přepíše)
+    void cull(const Frustum& frustum, std::vector<Model*>& visible);
+
+    size_t size() const { return objects.size(); }
+    const CullStats& stats() const { return last_stats; }
+
+private:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+    static constexpr uint32_t LEAF = 0x80000000u; // potomek je objekt (index do objects)
+    static constexpr uint32_t NO_PARENT = 0xFFFFFFFFu;
+    static constexpr size_t MIN_REFITS_BEFORE_REBUILD = 64;
+
+    // Uzel se 4 potomky - kvádry po složkách, prázdné místo má kvádr naruby (vždy mimo jehlan)
+    struct alignas(16) Node {
+        float min_x[4], min_y[4], min_z[4];
+        float max_x[4], max_y[4], max_z[4];
+        uint32_t child[4];
+        uint32_t parent{ NO_PARENT };
+        uint32_t parent_slot{ 0 };
+    };
+
+    struct Object {
+        Model* model{ nullptr };
+        // Transformace, pro kterou platí kvádr
+        glm::vec3 origin{ 0.0f };
+        glm::vec3 orientation{ 0.0f };
+        glm::vec3 scale{ 1.0f };
+        glm::mat4 local_model_matrix{ 1.0f };
+        glm::vec3 bounds_min{ 0.0f };
+        glm::vec3 bounds_max{ 0.0f };
+        // Umístění listu ve stromu
+        uint32_t node{ 0 };
+        uint32_t slot{ 0 };
+    };
+
+    std::vector<Node> nodes; // nodes[0] = kořen
+    std::vector<Object> objects;
+    std::vector<uint32_t> order;  // pomocné pole stavby
+    std::vector<uint32_t> stack;  // pomocné pole průchodu
+    bool dirty{ false };          // nutná nová stavba
+    size_t refits_since_build{ 0 };
+    CullStats last_stats;
+
+    static bool transformChanged(const Object& object);
+    static void captureTransform(Object& object);
+
+    void build();
+    uint32_t buildNode(size_t begin, size_t end, uint32_t parent, uint32_t parent_slot);
+    size_t splitRange(size_t begin, size_t end);
+    void setSlot(Node& node, uint32_t slot, const glm::vec3& box_min, const glm::vec3& box_max);
+    void nodeBounds(const Node& node, glm::vec3& out_min, glm::vec3& out_max) const;
+    void refit(uint32_t node, uint32_t slot, const glm::vec3& box_min, const glm::vec3& box_max);
+    // Všechny objekty podstromu (celý uvnitř jehlanu) bez dalších testů
+    void collect(uint32_t child, std::vector<Model*>& visible);
+};
@@ -0,0 +1,100 @@
+﻿#include "SceneUniforms.hpp"
+
+#include <cstring>
+
+SceneUniforms* SceneUniforms::instance = nullptr;
+
+SceneUniforms* SceneUniforms::getInstance() {
+    if (!instance) {
+        instance = new SceneUniforms();
+    }
+    return instance;
+}
+
+SceneUniforms::SceneUniforms() {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment < 1) {
+        alignment = 256;
+    }
+
+    // Bloky za sebou, každý na zarovnaném offsetu (požadavek glBindBufferRange)
+    const GLsizeiptr sizes[4] = { sizeof(CameraBlock), sizeof(DirectionalLightBlock),
+        sizeof(SpotLightBlock), sizeof(MaterialBlock) };
+    for (int i = 0; i < 4; i++) {
+        offsets[i] = buffer_size;
+        buffer_size += (sizes[i] + alignment - 1) / alignment * alignment;
+    }
+    staging.assign(buffer_size, 0);
+
+    glCreateBuffers(1, &UBO);
+    glNamedBufferStorage(UBO, buffer_size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    for (GLuint binding = 0; binding < 4; binding++) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, UBO, offsets[binding], sizes[binding]);
+    }
+
+    // Výchozí hodnoty (odpovídají dřívějším výchozím hodnotám uniforem v shaderech)
+    CameraBlock& camera = block<CameraBlock>(CAMERA_BINDING);
+    camera.view = camera.projection = camera.view_projection = glm::mat4(1.0f);
+    setDirectionalLight(glm::vec3(0.0f, -1.0f, -1.0f), glm::vec3(0.2f), glm::vec3(0.8f), glm::vec3(1.0f));
+    setMaterial(glm::vec3(0.2f), glm::vec3(1.0f), glm::vec3(1.0f), 32.0f);
+}
+
+SceneUniforms::~SceneUniforms() {
+    if (UBO != 0) {
+        glDeleteBuffers(1, &UBO);
+        UBO = 0;
+    }
+}
+
+void SceneUniforms::setView(const glm::mat4& view, const glm::vec3& camera_position) {
+    CameraBlock& camera = block<CameraBlock>(CAMERA_BINDING);
+    camera.view = view;
+    camera.view_projection = camera.projection * view;
+    camera.position = glm::vec4(camera_position, 1.0f);
+}
+
+void SceneUniforms::setProjection(const glm::mat4& projection) {
+    CameraBlock& camera = block<CameraBlock>(CAMERA_BINDING);
+    camera.projection = projection;
+    camera.view_projection = projection * camera.view;
+}
+
+void SceneUniforms::setDirectionalLight(const glm::vec3& direction, const glm::vec3& ambient,
+    const glm::vec3& diffuse, const glm::vec3& specular) {
+    DirectionalLightBlock& light = block<DirectionalLightBlock>(DIRECTIONAL_LIGHT_BINDING);
+    light.direction = glm::vec4(direction, 0.0f);
+    light.ambient = glm::vec4(ambient, 0.0f);
+    light.diffuse = glm::vec4(diffuse, 0.0f);
+    light.specular = glm::vec4(specular, 0.0f);
+}
+
+void SceneUniforms::setSpotLight(const SpotLight& source) {
+    SpotLightBlock& light = block<SpotLightBlock>(SPOT_LIGHT_BINDING);
+    light.position = glm::vec4(source.GetPosition(), 1.0f);
+    light.direction = glm::vec4(source.GetDirection(), 0.0f);
+    light.ambient = glm::vec4(source.GetAmbient(), 0.0f);
+    light.diffuse = glm::vec4(source.GetDiffuse(), 0.0f);
+    light.specular = glm::vec4(source.GetSpecular(), 0.0f);
+    light.constant = source.GetConstant();
+    light.linear = source.GetLinear();
+    light.quadratic = source.GetQuadratic();
+    light.cut_off = source.GetCutOff();
+    light.outer_cut_off = source.GetOuterCutOff();
+}
+
+void SceneUniforms::setMaterial(const glm::vec3& ambient, const glm::vec3& diffuse, const glm::vec3& specular,
+    float shininess) {
+    MaterialBlock& material = block<MaterialBlock>(MATERIAL_BINDING);
+    material.ambient = glm::vec4(ambient, 0.0f);
+    material.diffuse = glm::vec4(diffuse, 0.0f);
+    material.specular = glm::vec4(specular, 0.0f);
+    material.shininess = shininess;
+}
+
+void SceneUniforms::upload() {
+    if (!dirty) {
+        return;
+    }
+    glNamedBufferSubData(UBO, 0, buffer_size, staging.data());
+    dirty = false;
+}
@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "SpotLight.hpp"
+
+// Uniform bloky sdílené všemi programy (layout std140) - musí odpovídat blokům v shaderech.
+// vec3 jsou uložené jako vec4 (zarovnání std140 na 16 B), w je rezerva.
+
+// binding 0 - kamera (tex.vert, directional.vert, directional.frag)
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
+    glm::vec4 position; // pozice kamery ve world space
+};
+
+// binding 1 - směrové světlo (slunce)
+struct DirectionalLightBlock {
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+// binding 2 - čelová baterka (zapnutí určuje varianta programu SPOT_LIGHT, viz ShaderPermutations)
+struct SpotLightBlock {
+    glm::vec4 position;
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    float constant;
+    float linear;
+    float quadratic;
+    float cut_off;
+    float outer_cut_off;
+    float padding[3];
+};
+
+// binding 3 - výchozí materiál (barva konkrétního objektu zůstává v uniformě u_diffuse_color)
+struct MaterialBlock {
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    float shininess;
+    float padding[3];
+};
+
+static_assert(sizeof(CameraBlock) == 208, "CameraBlock neodpovídá std140");
+static_assert(sizeof(SpotLightBlock) == 112, "SpotLightBlock neodpovídá std140");
+static_assert(sizeof(MaterialBlock) == 64, "MaterialBlock neodpovídá std140");
+
+// Jeden uniform buffer se všemi bloky za snímek. Stav se nastavuje kdykoliv během snímku,
+// na GPU se nahraje jednou (upload) jediným glNamedBufferSubData a všechny programy ho sdílí
+// přes pevné binding pointy - žádné uniformy kamery a světel pro jednotlivé programy.
+class SceneUniforms {
+private:
+    static SceneUniforms* instance;
+
+    SceneUniforms();
+
+    GLuint UBO{ 0 };
+    GLint alignment{ 256 }; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+    // Offsety bloků v bufferu (zarovnané)
+    GLintptr offsets[4]{};
+    GLsizeiptr buffer_size{ 0 };
+    std::vector<unsigned char> staging; // obsah bufferu na CPU
+
+    bool dirty{ true };
+
+    template <typename Block>
+    Block& block(GLuint binding) {
+        dirty = true;
+        return *reinterpret_cast<Block*>(staging.data() + offsets[binding]);
+    }
+
+public:
+    static constexpr GLuint CAMERA_BINDING = 0;
+    static constexpr GLuint DIRECTIONAL_LIGHT_BINDING = 1;
+    static constexpr GLuint SPOT_LIGHT_BINDING = 2;
+    static constexpr GLuint MATERIAL_BINDING = 3;
+
+    static SceneUniforms* getInstance();
+
+    ~SceneUniforms();
+
+    SceneUniforms(const SceneUniforms&) = delete;
+    SceneUniforms& operator=(const SceneUniforms&) = delete;
+
+    void setView(const glm::mat4& view, const glm::vec3& camera_position);
+    void setProjection(const glm::mat4& projection);
+    void setDirectionalLight(const glm::vec3& direction, const glm::vec3& ambient,
+        const glm::vec3& diffuse, const glm::vec3& specular);
+    void setSpotLight(const SpotLight& light);
+    void setMaterial(const glm::vec3& ambient, const glm::vec3& diffuse, const glm::vec3& specular, float shininess);
+
+    // Nahrání změněného stavu (jednou za snímek, před vykreslením)
+    void upload();
+};
@@ -0,0 +1,149 @@
+﻿#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "ShaderCache.hpp"
+#include "MeshCache.hpp"
+
+const std::filesystem::path ShaderCache::CACHE_DIRECTORY = "cache/shaders";
+
+namespace {
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+} // namespace
+
+uint64_t ShaderCache::programKey(const std::vector<std::string>& sources, const std::string& defines) {
+    // Jednotlivé části oddělené nulovým znakem, aby se různá rozdělení nepotkala ve stejném klíči
+    std::string key;
+    for (const auto& source : sources) {
+        key += source;
+        key += '\0';
+    }
+    key += defines;
+    key += '\0';
+    key += glString(GL_VENDOR) + '\0' + glString(GL_RENDERER) + '\0' + glString(GL_VERSION);
+    return MeshCache::hashBytes(key.data(), key.size());
+}
+
+bool ShaderCache::supported() {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::filesystem::path ShaderCache::cachePath(uint64_t key) {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".pgprog";
+    return CACHE_DIRECTORY / name.str();
+}
+
+bool ShaderCache::load(uint64_t key, GLenum& format, std::vector<char>& binary) {
+    std::filesystem::path path = cachePath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        misses++;
+        return false;
+    }
+
+    ShaderCacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::error_code ec;
+    uintmax_t file_size = std::filesystem::file_size(path, ec);
+    if (!file || ec || header.magic != ShaderCacheHeader::MAGIC || header.version != ShaderCacheHeader::VERSION ||
+        header.key != key || header.binary_length == 0 || sizeof(header) + header.binary_length != file_size) {
+        std::cerr << "Shader cache " << path.filename().string() << ": invalid file, recompiling" << std::endl;
+        misses++;
+        return false;
+    }
+
+    binary.resize(header.binary_length);
+    file.read(binary.data(), binary.size());
+    if (!file) {
+        misses++;
+        return false;
+    }
+    format = header.binary_format;
+    return true;
+}
+
+bool ShaderCache::store(uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) {
+        return false;
+    }
+
+    ShaderCacheHeader header{};
+    header.magic = ShaderCacheHeader::MAGIC;
+    header.version = ShaderCacheHeader::VERSION;
+    header.key = key;
+    header.binary_format = format;
+    header.binary_length = static_cast<uint64_t>(length);
+
+    std::filesystem::path path = cachePath(key);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Zápis do dočasného souboru a přejmenování - rozepsaný soubor se nikdy nenačte
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Shader cache: cannot write " << temp_path.string() << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "Shader cache: write failed " << temp_path.string() << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "Shader cache: cannot replace " << path.string() << ": " << ec.message() << std::endl;
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+void ShaderCache::remove(uint64_t key) {
+    std::error_code ec;
+    std::filesystem::remove(cachePath(key), ec);
+}
+
+void ShaderCache::recordHit(double milliseconds) {
+    hits++;
+    hit_ms += milliseconds;
+}
+
+void ShaderCache::recordRejected() {
+    rejected++;
+}
+
+void ShaderCache::recordCompile(double milliseconds) {
+    compile_ms += milliseconds;
+}
+
+void ShaderCache::printStats() {
+    unsigned total = hits + misses + rejected;
+    std::cout << "Shader cache: " << hits << " / " << total << " programs from cache ("
+        << (total > 0 ? 100 * hits / total : 0) << " %), " << misses << " missing, "
+        << rejected << " rejected by driver; binary load " << hit_ms << " ms, compile + link "
+        << compile_ms << " ms" << std::endl;
+}
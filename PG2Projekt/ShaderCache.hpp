@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+// Cache slinkovaných programů (*.pgprog) - výsledek glGetProgramBinary uložený pod klíčem
+// z hashe zdrojových kódů všech stupňů, definic a identifikace ovladače (vendor/renderer/version).
+// Binárka je závislá na ovladači, proto ji ovladač může odmítnout - pak se program přeloží ze zdroje
+// a záznam se přepíše.
+//
+// Rozložení souboru: ShaderCacheHeader | binárka programu (binary_length bajtů)
+
+struct ShaderCacheHeader {
+    static constexpr uint32_t MAGIC = 0x47525050; // "PPRG"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;           // ShaderCache::programKey
+    uint32_t binary_format; // formát z glGetProgramBinary
+    uint32_t reserved;
+    uint64_t binary_length;
+};
+
+class ShaderCache {
+public:
+    static const std::filesystem::path CACHE_DIRECTORY;
+
+    // Klíč programu - zdrojové kódy stupňů v pořadí linkování, definice a řetězce ovladače
+    static uint64_t programKey(const std::vector<std::string>& sources, const std::string& defines);
+
+    // Podporuje ovladač alespoň jeden formát binárky? (GL_NUM_PROGRAM_BINARY_FORMATS)
+    static bool supported();
+
+    // Načtení binárky - false, pokud záznam neexistuje nebo je poškozený
+    static bool load(uint64_t key, GLenum& format, std::vector<char>& binary);
+
+    // Uložení binárky slinkovaného programu (program musí mít GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    static bool store(uint64_t key, GLuint program);
+
+    // Smazání záznamu (ovladač binárku odmítl)
+    static void remove(uint64_t key);
+
+    // Statistika za běh - zásahy, odmítnuté binárky, překlady a jejich čas
+    static void recordHit(double milliseconds);
+    static void recordRejected();
+    static void recordCompile(double milliseconds);
+    static void printStats();
+
+private:
+    static std::filesystem::path cachePath(uint64_t key);
+
+    static inline unsigned hits = 0;
+    static inline unsigned misses = 0;
+    static inline unsigned rejected = 0;
+    static inline double hit_ms = 0.0;
+    static inline double compile_ms = 0.0;
+};
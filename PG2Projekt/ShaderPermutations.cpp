@@ -0,0 +1,51 @@
+﻿#include "ShaderPermutations.hpp"
+
+#include <stdexcept>
+
+ShaderPermutations::ShaderPermutations(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+    const std::vector<std::string>& features) :
+    VS_file(VS_file),
+    FS_file(FS_file),
+    features(features)
+{
+    if (features.size() > 32) {
+        throw std::invalid_argument("ShaderPermutations: too many features");
+    }
+}
+
+const ShaderProgram& ShaderPermutations::get(uint32_t mask) {
+    auto found = variants.find(mask);
+    if (found != variants.end()) {
+        return found->second;
+    }
+
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < features.size(); i++) {
+        if (mask & (1u << i)) {
+            defines.push_back(features[i]);
+        }
+    }
+    return variants.emplace(mask, ShaderProgram::build(VS_file, FS_file, defines)).first->second;
+}
+
+void ShaderPermutations::prebuild(const std::vector<uint32_t>& masks) {
+    for (uint32_t mask : masks) {
+        get(mask);
+    }
+}
+
+bool ShaderPermutations::failed() const {
+    for (const auto& variant : variants) {
+        if (variant.second.failed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShaderPermutations::clear() {
+    for (auto& variant : variants) {
+        variant.second.clear();
+    }
+    variants.clear();
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ShaderProgram.hpp"
+
+// Varianty (permutace) jednoho programu podle funkcí zapnutých při překladu. Bit i masky odpovídá
+// features[i], které se do zdrojů vloží jako "#define". Varianta se přeloží (asynchronně) při prvním
+// požadavku, takže v shaderu místo dynamických větví na uniformách zůstane jen kód použité varianty.
+class ShaderPermutations {
+public:
+    ShaderPermutations() = default;
+    ShaderPermutations(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+        const std::vector<std::string>& features);
+
+    // Varianta pro danou masku funkcí (přeloží se při prvním požadavku, viz ShaderProgram::ready)
+    const ShaderProgram& get(uint32_t mask);
+
+    // Odeslání překladu variant předem - přepnutí stavu scény pak nečeká na překlad
+    void prebuild(const std::vector<uint32_t>& masks);
+
+    // Selhal překlad některé z variant?
+    bool failed() const;
+
+    size_t size() const { return variants.size(); }
+
+    void clear();
+
+private:
+    std::filesystem::path VS_file;
+    std::filesystem::path FS_file;
+    std::vector<std::string> features;
+    std::unordered_map<uint32_t, ShaderProgram> variants; // maska -> program (reference zůstávají platné)
+};
@@ -1,77 +1,336 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
 #include "ShaderProgram.hpp"
+#include "ShaderCache.hpp"
 
 // set uniform according to name 
 // https://docs.gl/gl4/glUniform
 
-ShaderProgram::ShaderProgram(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file)
+ShaderProgram::ShaderProgram(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+	const std::vector<std::string>& defines)
 {
+	buildSync({ VS_file, FS_file }, { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER }, defines,
+		programName(VS_file, FS_file, defines));
+}
+
+ShaderProgram ShaderProgram::compute(const std::filesystem::path& CS_file, const std::vector<std::string>& defines) {
+	std::string name = CS_file.stem().string();
+	if (!defines.empty()) {
+		name += "[" + joinDefines(defines) + "]";
+	}
+	ShaderProgram program;
+	program.buildSync({ CS_file }, { GL_COMPUTE_SHADER }, defines, name);
+	return program;
+}
+
+void ShaderProgram::buildSync(const std::vector<std::filesystem::path>& files, const std::vector<GLenum>& types,
+	const std::vector<std::string>& defines, const std::string& name)
+{
+	auto start = std::chrono::steady_clock::now();
+	uniforms = std::make_shared<UniformTable>();
+
+	std::vector<std::string> sources;
+	for (const auto& file : files) {
+		sources.push_back(loadSource(file));
+	}
+
+	// Binárka z minulého spuštění (klíč = zdroje + definice + ovladač)
+	bool use_cache = ShaderCache::supported();
+	uint64_t key = use_cache ? ShaderCache::programKey(sources, joinDefines(defines)) : 0;
+	for (auto& source : sources) {
+		source = injectDefines(source, defines);
+	}
+	if (use_cache && loadCached(name, key, start)) {
+		return;
+	}
+
 	std::vector<GLuint> shader_ids;
 
-	shader_ids.push_back(compile_shader(VS_file, GL_VERTEX_SHADER));
-	shader_ids.push_back(compile_shader(FS_file, GL_FRAGMENT_SHADER));
+	for (size_t i = 0; i < sources.size(); i++) {
+		shader_ids.push_back(compile_shader(sources[i], files[i], types[i]));
+	}
+
+	ID = link_shader(shader_ids, use_cache);
 
-	ID = link_shader(shader_ids);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	ShaderCache::recordCompile(ms);
+	std::cout << "Shader program " << name << ": compiled in " << ms << " ms" << std::endl;
+	if (use_cache) {
+		ShaderCache::store(key, ID);
+	}
+	reflectUniforms();
 }
 
-void ShaderProgram::setUniform(const std::string& name, const float val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+bool ShaderProgram::loadCached(const std::string& name, uint64_t key, std::chrono::steady_clock::time_point start) {
+	ID = load_binary(key);
+	if (ID == 0) {
+		return false;
 	}
-	glUniform1f(loc, val);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	ShaderCache::recordHit(ms);
+	std::cout << "Shader program " << name << ": loaded from cache (" << ms << " ms)" << std::endl;
+	reflectUniforms();
+	return true;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const int val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+bool ShaderProgram::parallelCompileSupported() {
+	static const bool supported = [] {
+		if (GLEW_KHR_parallel_shader_compile) {
+			// Počet vláken nechá na ovladači (0xFFFFFFFF = co nejvíc)
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			return true;
+		}
+		if (GLEW_ARB_parallel_shader_compile) {
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+			return true;
+		}
+		std::cout << "KHR_parallel_shader_compile not available, shaders are compiled synchronously" << std::endl;
+		return false;
+	}();
+	return supported;
+}
+
+ShaderProgram ShaderProgram::build(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+	const std::vector<std::string>& defines) {
+	if (!parallelCompileSupported()) {
+		return ShaderProgram(VS_file, FS_file, defines);
+	}
+
+	ShaderProgram program;
+	program.uniforms = std::make_shared<UniformTable>();
+	auto state = std::make_shared<ProgramBuild>();
+	state->start = std::chrono::steady_clock::now();
+	state->name = programName(VS_file, FS_file, defines);
+	state->files = { VS_file, FS_file };
+
+	std::vector<std::string> sources{ loadSource(VS_file), loadSource(FS_file) };
+
+	state->use_cache = ShaderCache::supported();
+	state->cache_key = state->use_cache ? ShaderCache::programKey(sources, joinDefines(defines)) : 0;
+	for (auto& source : sources) {
+		source = injectDefines(source, defines);
 	}
-	glUniform1i(loc, val);
+	if (state->use_cache && program.loadCached(state->name, state->cache_key, state->start)) {
+		state->status = ProgramBuild::Status::Ready;
+		program.build_state = state;
+		return program;
+	}
+
+	// Odeslání kompilace a linkování bez dotazu na stav - dotaz na GL_COMPILE_STATUS/GL_LINK_STATUS
+	// by čekal na dokončení, výsledek se vyzvedne až v ready()
+	const GLenum types[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (size_t i = 0; i < sources.size(); i++) {
+		GLuint shader_h = glCreateShader(types[i]);
+		const char* source = sources[i].c_str();
+		glShaderSource(shader_h, 1, &source, NULL);
+		glCompileShader(shader_h);
+		state->shader_ids.push_back(shader_h);
+	}
+
+	program.ID = glCreateProgram();
+	if (state->use_cache)
+		glProgramParameteri(program.ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	for (const auto& id : state->shader_ids)
+		glAttachShader(program.ID, id);
+	glLinkProgram(program.ID);
+
+	program.build_state = state;
+	return program;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec3 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+bool ShaderProgram::ready() const {
+	if (!build_state) {
+		return ID != 0;
 	}
-	glUniform3fv(loc, 1, glm::value_ptr(val));
+	if (build_state->status == ProgramBuild::Status::Pending) {
+		GLint completed = GL_FALSE;
+		glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &completed);
+		if (completed == GL_FALSE) {
+			return false;
+		}
+		finishBuild();
+	}
+	return build_state->status == ProgramBuild::Status::Ready;
+}
+
+bool ShaderProgram::failed() const {
+	return build_state && !ready() && build_state->status == ProgramBuild::Status::Failed;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec4 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
+void ShaderProgram::finishBuild() const {
+	ProgramBuild& state = *build_state;
+
+	// Stav linkování je teď k dispozici bez čekání; logy kompilace jednotlivých stupňů
+	GLint success = 0;
+	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+	for (size_t i = 0; i < state.shader_ids.size(); i++) {
+		std::string log = getShaderInfoLog(state.shader_ids[i]);
+		if (!log.empty()) {
+			std::cout << "Shader compilation log for " << state.files[i].filename() << ":\n" << log << std::endl;
+		}
+	}
+	std::string log = getProgramInfoLog(ID);
+	if (!log.empty()) {
+		std::cout << "Shader program linking log:\n" << log << std::endl;
+	}
+
+	for (const auto& id : state.shader_ids) {
+		glDetachShader(ID, id);
+		glDeleteShader(id);
+	}
+	state.shader_ids.clear();
+
+	if (success == GL_FALSE) {
+		std::cerr << "Shader program " << state.name << ": build failed" << std::endl;
+		GLState::getInstance()->forgetProgram(ID);
+		glDeleteProgram(ID);
+		ID = 0;
+		state.status = ProgramBuild::Status::Failed;
 		return;
 	}
-	glUniform4fv(loc, 1, glm::value_ptr(val));
+
+	// Čas od odeslání do zjištění dokončení (přesnost dána frekvencí dotazů)
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state.start).count();
+	ShaderCache::recordCompile(ms);
+	std::cout << "Shader program " << state.name << ": compiled in parallel, ready after " << ms << " ms" << std::endl;
+	if (state.use_cache) {
+		ShaderCache::store(state.cache_key, ID);
+	}
+	reflectUniforms();
+	state.status = ProgramBuild::Status::Ready;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat3 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+GLuint ShaderProgram::load_binary(uint64_t key) {
+	GLenum format = 0;
+	std::vector<char> binary;
+	if (!ShaderCache::load(key, format, binary)) {
+		return 0;
+	}
+
+	GLuint prog_h = glCreateProgram();
+	glProgramBinary(prog_h, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	// Ovladač binárku odmítne např. po aktualizaci - záznam se smaže a program se přeloží
+	GLint success = 0;
+	glGetProgramiv(prog_h, GL_LINK_STATUS, &success);
+	if (success == GL_FALSE) {
+		std::cout << "Shader cache: binary rejected by driver, recompiling" << std::endl;
+		glDeleteProgram(prog_h);
+		ShaderCache::remove(key);
+		ShaderCache::recordRejected();
+		return 0;
 	}
-	glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(val));
+	return prog_h;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4 val) {
-	auto loc = glGetUniformLocation(ID, name.c_str());
-	if (loc == -1) {
-		std::cerr << "no uniform with name:" << name << '\n';
-		return;
+void ShaderProgram::setUniform(std::string_view name, const float val) const {
+	GLint location = findLocation(name, GL_FLOAT, true);
+	if (location >= 0)
+		glProgramUniform1f(ID, location, val);
+}
+
+void ShaderProgram::setUniform(std::string_view name, const int val) const {
+	GLint location = findLocation(name, GL_INT, true);
+	if (location >= 0)
+		glProgramUniform1i(ID, location, val);
+}
+
+void ShaderProgram::setUniform(std::string_view name, const glm::vec3 val) const {
+	GLint location = findLocation(name, GL_FLOAT_VEC3, true);
+	if (location >= 0)
+		glProgramUniform3fv(ID, location, 1, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(std::string_view name, const glm::vec4 val) const {
+	GLint location = findLocation(name, GL_FLOAT_VEC4, true);
+	if (location >= 0)
+		glProgramUniform4fv(ID, location, 1, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(std::string_view name, const glm::mat3 val) const {
+	GLint location = findLocation(name, GL_FLOAT_MAT3, true);
+	if (location >= 0)
+		glProgramUniformMatrix3fv(ID, location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void ShaderProgram::setUniform(std::string_view name, const glm::mat4 val) const {
+	GLint location = findLocation(name, GL_FLOAT_MAT4, true);
+	if (location >= 0)
+		glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+void ShaderProgram::reflectUniforms() const {
+	// Tabulku sdílí i kopie vytvořené před dokončením asynchronního sestavení - plní se na místě
+	*uniforms = UniformTable();
+
+	GLint count = 0;
+	glGetProgramInterfaceiv(ID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+	const GLenum properties[] = { GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX };
+	for (GLint i = 0; i < count; i++) {
+		GLint values[5] = {};
+		glGetProgramResourceiv(ID, GL_UNIFORM, i, 5, properties, 5, NULL, values);
+		// Členy uniform bloků nemají location - nastavují se přes buffer
+		if (values[4] != -1 || values[2] < 0) {
+			continue;
+		}
+
+		std::vector<char> name_buffer(values[0]);
+		glGetProgramResourceName(ID, GL_UNIFORM, i, values[0], NULL, name_buffer.data());
+		std::string name(name_buffer.data());
+
+		auto add = [this](const std::string& name, GLint location, GLenum type) {
+			uniforms->index[uniformHash(name)] = static_cast<uint32_t>(uniforms->entries.size());
+			uniforms->entries.push_back({ name, location, type });
+		};
+
+		// Pole základních typů: "a[0]" -> "a", "a[0]", "a[1]", ... (prvky mají po sobě jdoucí location)
+		if (values[3] > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+			std::string base = name.substr(0, name.size() - 3);
+			add(base, values[2], values[1]);
+			for (GLint element = 0; element < values[3]; element++) {
+				add(base + "[" + std::to_string(element) + "]", values[2] + element, values[1]);
+			}
+		}
+		else {
+			add(name, values[2], values[1]);
+		}
+	}
+}
+
+GLint ShaderProgram::findLocation(std::string_view name, GLenum expected_type, bool warn) const {
+	// Program ještě není sestavený - uniformy nejsou známé, nic se nehlásí
+	if (!uniforms || (build_state && build_state->status != ProgramBuild::Status::Ready)) {
+		return -1;
+	}
+
+	uint64_t hash = uniformHash(name);
+	auto found = uniforms->index.find(hash);
+	if (found == uniforms->index.end()) {
+		if (warn && uniforms->warned.insert(hash).second) {
+			std::cerr << "no uniform with name:" << name << '\n';
+		}
+		return -1;
 	}
-	glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(val));
+
+	const UniformTable::Entry& entry = uniforms->entries[found->second];
+	// Kontrola typu - int lze nastavit i do bool a samplerů, float do bool, ostatní typy se musí shodovat
+	bool type_ok = expected_type == 0 || entry.type == expected_type || (expected_type == GL_FLOAT && entry.type == GL_BOOL) ||
+		(expected_type == GL_INT && entry.type != GL_FLOAT && entry.type != GL_FLOAT_VEC3 && entry.type != GL_FLOAT_VEC4 &&
+			entry.type != GL_FLOAT_MAT3 && entry.type != GL_FLOAT_MAT4);
+	if (!type_ok) {
+		if (uniforms->warned.insert(hash ^ expected_type).second) {
+			std::cerr << "uniform " << name << " has a different type (GL type 0x" << std::hex << entry.type << std::dec << ")\n";
+		}
+		return -1;
+	}
+	return entry.location;
 }
 
 std::string ShaderProgram::getShaderInfoLog(const GLuint obj) {
@@ -96,27 +355,68 @@ std::string ShaderProgram::getProgramInfoLog(const GLuint obj) {
 	return "";
 }
 
-GLuint ShaderProgram::compile_shader(const std::filesystem::path& source_file, const GLenum type) {
-	// Naten obsahu souboru
-	std::string shaderSource;
+std::string ShaderProgram::loadSource(const std::filesystem::path& source_file) {
 	try {
-		shaderSource = textFileRead(source_file);
+		return textFileRead(source_file);
 	}
 	catch (const std::exception& e) {
 		throw std::runtime_error("Couldn't load shader file: " + source_file.string() + "\nError: " + e.what());
 	}
+}
+
+std::string ShaderProgram::injectDefines(const std::string& source, const std::vector<std::string>& defines) {
+	if (defines.empty()) {
+		return source;
+	}
+
+	std::string block;
+	for (const auto& define : defines) {
+		block += "#define " + define + "\n";
+	}
+
+	// #version musí zůstat první direktivou - definice až za ním
+	size_t version = source.find("#version");
+	if (version == std::string::npos) {
+		return block + "#line 1\n" + source;
+	}
+	size_t line_end = source.find('\n', version);
+	if (line_end == std::string::npos) {
+		return source + "\n" + block;
+	}
+	size_t version_line = std::count(source.begin(), source.begin() + line_end, '\n') + 1;
+	return source.substr(0, line_end + 1) + block + "#line " + std::to_string(version_line + 1) + "\n" +
+		source.substr(line_end + 1);
+}
+
+std::string ShaderProgram::joinDefines(const std::vector<std::string>& defines) {
+	std::string joined;
+	for (const auto& define : defines) {
+		joined += (joined.empty() ? "" : ",") + define;
+	}
+	return joined;
+}
+
+std::string ShaderProgram::programName(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+	const std::vector<std::string>& defines) {
+	std::string name = VS_file.stem().string() + "/" + FS_file.stem().string();
+	if (!defines.empty()) {
+		name += "[" + joinDefines(defines) + "]";
+	}
+	return name;
+}
 
-	// Vytvoen a kompilace shaderu
+GLuint ShaderProgram::compile_shader(const std::string& shaderSource, const std::filesystem::path& source_file, const GLenum type) {
+	// Vytvoření a kompilace shaderu
 	GLuint shader_h = glCreateShader(type);
 	const char* source = shaderSource.c_str();
 	glShaderSource(shader_h, 1, &source, NULL);
 	glCompileShader(shader_h);
 
-	// Kontrola spnosti kompilace
+	// Kontrola úspěšnosti kompilace
 	GLint success = 0;
 	glGetShaderiv(shader_h, GL_COMPILE_STATUS, &success);
 
-	// Zskn log informac bez ohledu na vsledek (mohou tam bt varovn)
+	// Získání log informací bez ohledu na výsledek (mohou tam být varování)
 	std::string log = getShaderInfoLog(shader_h);
 	if (!log.empty()) {
 		std::cout << "Shader compilation log for " << source_file.filename() << ":\n" << log << std::endl;
@@ -130,28 +430,32 @@ GLuint ShaderProgram::compile_shader(const std::filesystem::path& source_file, c
 	return shader_h;
 }
 
-GLuint ShaderProgram::link_shader(const std::vector<GLuint> shader_ids) {
+GLuint ShaderProgram::link_shader(const std::vector<GLuint> shader_ids, bool retrievable) {
 	GLuint prog_h = glCreateProgram();
 
+	// Binárku půjde po linkování uložit do cache
+	if (retrievable)
+		glProgramParameteri(prog_h, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	for (const auto& id : shader_ids)
 		glAttachShader(prog_h, id);
 
 	glLinkProgram(prog_h);
 
-	// Kontrola spnosti linkovn
+	// Kontrola úspěšnosti linkování
 	GLint success = 0;
 	glGetProgramiv(prog_h, GL_LINK_STATUS, &success);
 
-	// Zskn log informac bez ohledu na vsledek
+	// Získání log informací bez ohledu na výsledek
 	std::string log = getProgramInfoLog(prog_h);
 	if (!log.empty()) {
 		std::cout << "Shader program linking log:\n" << log << std::endl;
 	}
 
-	// Odpojen shader po linkovn
+	// Odpojení shaderů po linkování
 	for (const auto& id : shader_ids) {
 		glDetachShader(prog_h, id);
-		glDeleteShader(id); // U nepotebujeme jednotliv shadery
+		glDeleteShader(id); // Už nepotřebujeme jednotlivé shadery
 	}
 
 	if (success == GL_FALSE) {
@@ -164,10 +468,12 @@ GLuint ShaderProgram::link_shader(const std::vector<GLuint> shader_ids) {
 
 std::string ShaderProgram::textFileRead(const std::filesystem::path& filename)
 {
-	std::ifstream file(filename);
+	// Celý soubor jedním čtením do předem alokovaného řetězce
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
 	if (!file.is_open())
 		throw std::runtime_error("Error opening file.\n");
-	std::stringstream ss;
-	ss << file.rdbuf();
-	return ss.str();
+	std::string text(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(text.data(), text.size());
+	return text;
 }
@@ -1,39 +1,163 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <GL/glew.h>
-#include <glm/glm.hpp>  // Pidvme include pro glm
+#include <glm/glm.hpp>  // Přidáváme include pro glm
 #include <glm/gtc/type_ptr.hpp>  // Pro glm::value_ptr
+#include "GLState.hpp"
+
+// FNV-1a (64 bitů) jména uniformy - constexpr, takže jména známá při překladu lze hashovat předem
+constexpr uint64_t uniformHash(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Typovaný handle na uniformu - location se zjistí jednou (ShaderProgram::uniform), nastavení je pak
+// jen glProgramUniform*. Neplatný handle (location -1) GL tiše ignoruje.
+template <typename T>
+struct Uniform {
+    GLint location{ -1 };
+    bool valid() const { return location >= 0; }
+};
+
+// Tabulka aktivních uniforem programu (reflexe při linkování) - sdílená mezi kopiemi ShaderProgram
+struct UniformTable {
+    struct Entry {
+        std::string name;
+        GLint location;
+        GLenum type;
+    };
+    std::vector<Entry> entries;                     // plochá tabulka (pořadí podle GL)
+    std::unordered_map<uint64_t, uint32_t> index;   // hash jména -> index do entries
+    std::unordered_set<uint64_t> warned;            // chybějící jména, která už byla nahlášena
+};
+
+// Stav asynchronního sestavení programu (KHR_parallel_shader_compile) - sdílený mezi kopiemi ShaderProgram
+struct ProgramBuild {
+    enum class Status { Pending, Ready, Failed };
+    Status status{ Status::Pending };
+    std::string name;
+    std::vector<GLuint> shader_ids;                 // stupně čekající na dokončení linkování
+    std::vector<std::filesystem::path> files;       // zdroje stupňů (pro hlášení chyb)
+    uint64_t cache_key{ 0 };
+    bool use_cache{ false };
+    std::chrono::steady_clock::time_point start;
+};
 
 class ShaderProgram {
 public:
     // you can add more constructors for pipeline with GS, TS etc.
     ShaderProgram(void) = default; //does nothing
-    ShaderProgram(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file); // TODO: implementation of load, compile, and link shader
+    // defines = jména funkcí, která se do všech stupňů vloží jako "#define JMENO" hned za #version
+    ShaderProgram(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+        const std::vector<std::string>& defines = {});
+
+    // Asynchronní sestavení - všechny stupně se jen odešlou ovladači (kompilace i linkování běží
+    // na jeho vláknech), stav se zjišťuje bez blokování přes ready(). Bez KHR_parallel_shader_compile
+    // se program sestaví synchronně jako konstruktor.
+    static ShaderProgram build(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+        const std::vector<std::string>& defines = {});
+
+    // Compute shader (synchronní sestavení, binárka v ShaderCache jako u ostatních programů)
+    static ShaderProgram compute(const std::filesystem::path& CS_file, const std::vector<std::string>& defines = {});
+
+    // Je program slinkovaný a použitelný? (u asynchronního sestavení průběžně dokončuje build)
+    bool ready() const;
+    bool failed() const;
     // V ShaderProgram.hpp
-    void activate(void) const { glUseProgram(ID); };
-    void deactivate(void) const { glUseProgram(0); };
+    // Rozpracovaný asynchronní program se neaktivuje (glUseProgram by čekal na dokončení linkování)
+    // Přepnutí programu přes GLState - stejný program se znovu neaktivuje
+    void activate(void) const { if (!build_state || ready()) GLState::getInstance()->useProgram(ID); };
+    void deactivate(void) const { GLState::getInstance()->useProgram(0); };
     void clear(void) { 	//deallocate shader program
         deactivate();
-        glDeleteProgram(ID);
+        // Program s neúspěšným sestavením už smazal finishBuild - jméno mohl ovladač mezitím přidělit jinému
+        if (GLuint id = getID()) {
+            GLState::getInstance()->forgetProgram(id);
+            glDeleteProgram(id);
+        }
         ID = 0;
+        uniforms.reset();
+        build_state.reset();
     }
-    // Getter pro ID
-    GLuint getID() const { return ID; }
-    // set uniform according to name 
-    // https://docs.gl/gl4/glUniform
-    void setUniform(const std::string& name, const float val);
-    void setUniform(const std::string& name, const int val);
-    void setUniform(const std::string& name, const glm::vec3 val);
-    void setUniform(const std::string& name, const glm::vec4 val);
-    void setUniform(const std::string& name, const glm::mat3 val);
-    void setUniform(const std::string& name, const glm::mat4 val);
+    // Getter pro ID (0 i u kopií programu, jehož asynchronní sestavení selhalo)
+    GLuint getID() const { return build_state && build_state->status == ProgramBuild::Status::Failed ? 0 : ID; }
+
+    // Typovaný handle (bez varování, pokud uniforma neexistuje - viz Uniform::valid)
+    template <typename T>
+    Uniform<T> uniform(std::string_view name) const {
+        return Uniform<T>{ findLocation(name, uniformType(T{}), false) };
+    }
+
+    // Nastavení přes handle - DSA (glProgramUniform*), program nemusí být aktivní
+    void set(Uniform<float> u, const float val) const { glProgramUniform1f(getID(), u.location, val); }
+    void set(Uniform<int> u, const int val) const { glProgramUniform1i(getID(), u.location, val); }
+    void set(Uniform<glm::vec3> u, const glm::vec3& val) const { glProgramUniform3fv(getID(), u.location, 1, glm::value_ptr(val)); }
+    void set(Uniform<glm::vec4> u, const glm::vec4& val) const { glProgramUniform4fv(getID(), u.location, 1, glm::value_ptr(val)); }
+    void set(Uniform<glm::mat3> u, const glm::mat3& val) const { glProgramUniformMatrix3fv(getID(), u.location, 1, GL_FALSE, glm::value_ptr(val)); }
+    void set(Uniform<glm::mat4> u, const glm::mat4& val) const { glProgramUniformMatrix4fv(getID(), u.location, 1, GL_FALSE, glm::value_ptr(val)); }
+
+    // set uniform according to name - vyhledání v tabulce z reflexe (bez glGetUniformLocation),
+    // chybějící jméno se ohlásí jen jednou
+    void setUniform(std::string_view name, const float val) const;
+    void setUniform(std::string_view name, const int val) const;
+    void setUniform(std::string_view name, const glm::vec3 val) const;
+    void setUniform(std::string_view name, const glm::vec4 val) const;
+    void setUniform(std::string_view name, const glm::mat3 val) const;
+    void setUniform(std::string_view name, const glm::mat4 val) const;
+
+    // Počet aktivních uniforem (z reflexe)
+    size_t uniformCount() const { return uniforms ? uniforms->entries.size() : 0; }
 private:
-    GLuint ID{ 0 }; // default = 0, empty shader
-    std::string getShaderInfoLog(const GLuint obj);
-    std::string getProgramInfoLog(const GLuint obj);
-    GLuint compile_shader(const std::filesystem::path& source_file, const GLenum type);
-    GLuint link_shader(const std::vector<GLuint> shader_ids);
-    std::string textFileRead(const std::filesystem::path& filename); // load text file
-};
\ No newline at end of file
+    mutable GLuint ID{ 0 }; // default = 0, empty shader (finishBuild ho při selhání vynuluje)
+    std::shared_ptr<UniformTable> uniforms;
+    std::shared_ptr<ProgramBuild> build_state; // nullptr = sestaven synchronně
+
+    // KHR_parallel_shader_compile (nastaví počet vláken překladače při prvním dotazu)
+    static bool parallelCompileSupported();
+    // Synchronní načtení/překlad a linkování stupňů (files[i] typu types[i])
+    void buildSync(const std::vector<std::filesystem::path>& files, const std::vector<GLenum>& types,
+        const std::vector<std::string>& defines, const std::string& name);
+    // Program z cache - zaznamená čas a zjistí uniformy; false = nutný překlad
+    bool loadCached(const std::string& name, uint64_t key, std::chrono::steady_clock::time_point start);
+    // Dokončení asynchronního sestavení po GL_COMPLETION_STATUS_KHR
+    void finishBuild() const;
+
+    static std::string getShaderInfoLog(const GLuint obj);
+    static std::string getProgramInfoLog(const GLuint obj);
+    static std::string loadSource(const std::filesystem::path& source_file);
+    // Vložení definic za řádek #version (a #line, aby čísla řádků v chybách odpovídala souboru)
+    static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines);
+    static std::string programName(const std::filesystem::path& VS_file, const std::filesystem::path& FS_file,
+        const std::vector<std::string>& defines);
+    static std::string joinDefines(const std::vector<std::string>& defines);
+    GLuint compile_shader(const std::string& source, const std::filesystem::path& source_file, const GLenum type);
+    GLuint link_shader(const std::vector<GLuint> shader_ids, bool retrievable);
+    static std::string textFileRead(const std::filesystem::path& filename); // load text file
+    // Program z binárky v ShaderCache (0 = není v cache nebo ji ovladač odmítl)
+    GLuint load_binary(uint64_t key);
+
+    // Reflexe aktivních uniforem (glGetProgramInterfaceiv / glGetProgramResource*) do tabulky
+    void reflectUniforms() const;
+    // Location podle jména (-1 = neexistuje); expected_type 0 = bez kontroly typu
+    GLint findLocation(std::string_view name, GLenum expected_type, bool warn) const;
+
+    // GL typ odpovídající typu v C++ (int pokrývá i bool a samplery)
+    static GLenum uniformType(float) { return GL_FLOAT; }
+    static GLenum uniformType(int) { return GL_INT; }
+    static GLenum uniformType(const glm::vec3&) { return GL_FLOAT_VEC3; }
+    static GLenum uniformType(const glm::vec4&) { return GL_FLOAT_VEC4; }
+    static GLenum uniformType(const glm::mat3&) { return GL_FLOAT_MAT3; }
+    static GLenum uniformType(const glm::mat4&) { return GL_FLOAT_MAT4; }
+};
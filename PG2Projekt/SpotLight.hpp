@@ -89,9 +89,8 @@ public:
     }
 
     // Nastavení všech uniforem pro světlo do shaderu
+    // (program nemusí být aktivní - ShaderProgram nastavuje uniformy přes DSA)
     void SetUniforms(ShaderProgram& shader) const {
-        shader.activate();
-
         shader.setUniform("spotLight.position", _position);
         shader.setUniform("spotLight.direction", _direction);
         shader.setUniform("spotLight.ambient", _ambient);
@@ -7,8 +7,10 @@ TextRenderer::TextRenderer() : width(800), height(600) {
 TextRenderer::~TextRenderer() {
     // Úklid OpenGL objektů
     for (auto& c : characters) {
+        GLState::getInstance()->forgetTexture(c.second.textureID);
         glDeleteTextures(1, &c.second.textureID);
     }
+    GLState::getInstance()->forgetVertexArray(VAO);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 }
@@ -31,17 +33,14 @@ bool TextRenderer::init(int screenWidth, int screenHeight) {
         glCreateVertexArrays(1, &VAO);
         glCreateBuffers(1, &VBO);
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
         // Dynamická alokace pro VBO (budeme často měnit data pro různé znaky)
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+        glNamedBufferData(VBO, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
 
-        // Nastavení vertex attributů
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        // Nastavení vertex attributů (DSA - VAO se nenavazuje, stav drží GLState)
+        glEnableVertexArrayAttrib(VAO, 0);
+        glVertexArrayAttribFormat(VAO, 0, 4, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(VAO, 0, 0);
+        glVertexArrayVertexBuffer(VAO, 0, VBO, 0, 4 * sizeof(float));
 
         // Vytvoření fontů
         createSimpleFont();
@@ -126,8 +125,8 @@ void TextRenderer::renderText(const std::string& text, float x, float y, float s
     textShader.activate();
     textShader.setUniform("textColor", color);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    GLState* state = GLState::getInstance();
+    state->bindVertexArray(VAO);
 
     // Iterace přes všechny znaky textu
     for (char c : text) {
@@ -158,12 +157,10 @@ void TextRenderer::renderText(const std::string& text, float x, float y, float s
         };
 
         // Navázání textury znaku
-        glBindTextureUnit(0, ch.textureID);
+        state->bindTextureUnit(0, ch.textureID);
 
-        // Aktualizace obsahu VBO
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // Aktualizace obsahu VBO (DSA - bez navazování GL_ARRAY_BUFFER)
+        glNamedBufferSubData(VBO, 0, sizeof(vertices), vertices);
 
         // Vykreslení obdélníku znaku
         glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -172,10 +169,6 @@ void TextRenderer::renderText(const std::string& text, float x, float y, float s
         x += (ch.advance * scale);
     }
 
-    // Uvolnění VAO a textury
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
     // Deaktivace shaderu
     textShader.deactivate();
 }
\ No newline at end of file
@@ -0,0 +1,199 @@
+﻿#include "Texture.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include "GLState.hpp"
+
+Texture::Texture(const std::string& name, const std::vector<TextureLevelData>& level_data, const TextureOptions& options,
+    std::shared_ptr<const void> source) :
+    target(GL_TEXTURE_2D),
+    internal_format(options.internalFormat()),
+    compression(options.compression),
+    name(name),
+    options(options)
+{
+    if (level_data.empty()) {
+        throw std::runtime_error("Textura nemá žádnou úroveň: " + name);
+    }
+    width = level_data[0].width;
+    height = level_data[0].height;
+    levels = static_cast<int>(level_data.size());
+
+    // Streamování - na začátku jen mip tail (úrovně do STREAMING_TAIL_SIZE), zbytek zůstává na CPU
+    if (options.streaming && levels > 1) {
+        streaming = true;
+        source_levels = level_data;
+        this->source = std::move(source);
+        while (tail_level < levels - 1 &&
+            std::max(width >> tail_level, height >> tail_level) > STREAMING_TAIL_SIZE) {
+            tail_level++;
+        }
+        storage_level = resident_level = wanted_level = tail_level;
+    }
+
+    // Immutable úložiště + nahrání předpočítaných úrovní
+    glCreateTextures(GL_TEXTURE_2D, 1, &id);
+    glTextureStorage2D(id, levels - storage_level, internal_format,
+        std::max(1, width >> storage_level), std::max(1, height >> storage_level));
+    for (int level = storage_level; level < levels; level++) {
+        uploadLevel(level - storage_level, 0, level_data[level]);
+        memory_bytes += level_data[level].size;
+    }
+
+    applyOptions();
+}
+
+Texture::Texture(const std::string& name, const std::vector<std::vector<TextureLevelData>>& layer_levels,
+    const TextureOptions& options) :
+    target(GL_TEXTURE_2D_ARRAY),
+    internal_format(options.internalFormat()),
+    compression(options.compression),
+    name(name),
+    options(options)
+{
+    if (layer_levels.empty() || layer_levels[0].empty()) {
+        throw std::runtime_error("Pole textur nemá žádnou vrstvu: " + name);
+    }
+    width = layer_levels[0][0].width;
+    height = layer_levels[0][0].height;
+    layers = static_cast<int>(layer_levels.size());
+    levels = static_cast<int>(layer_levels[0].size());
+    for (const auto& layer : layer_levels) {
+        if (layer.size() != layer_levels[0].size() || layer[0].width != width || layer[0].height != height) {
+            throw std::runtime_error("Vrstvy pole textur musí mít stejný rozměr a počet úrovní: " + name);
+        }
+    }
+
+    // Mipmapy každé vrstvy jsou spočítané zvlášť - žádné prosakování mezi vrstvami
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &id);
+    glTextureStorage3D(id, levels, internal_format, width, height, layers);
+    for (int layer = 0; layer < layers; layer++) {
+        for (int level = 0; level < levels; level++) {
+            uploadLevel(level, layer, layer_levels[layer][level]);
+            memory_bytes += layer_levels[layer][level].size;
+        }
+    }
+
+    applyOptions();
+}
+
+Texture::~Texture() {
+    if (id != 0) {
+        GLState::getInstance()->forgetTexture(id);
+        glDeleteTextures(1, &id);
+        id = 0;
+    }
+}
+
+void Texture::uploadLevel(int level, int layer, const TextureLevelData& data) {
+    if (compressed()) {
+        if (target == GL_TEXTURE_2D_ARRAY) {
+            glCompressedTextureSubImage3D(id, level, 0, 0, layer, data.width, data.height, 1, internal_format,
+                static_cast<GLsizei>(data.size), data.data);
+        }
+        else {
+            glCompressedTextureSubImage2D(id, level, 0, 0, data.width, data.height, internal_format,
+                static_cast<GLsizei>(data.size), data.data);
+        }
+    }
+    else {
+        // Řádky RGBA8 jsou vždy zarovnané na 4 bajty (výchozí GL_UNPACK_ALIGNMENT)
+        if (target == GL_TEXTURE_2D_ARRAY) {
+            glTextureSubImage3D(id, level, 0, 0, layer, data.width, data.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+        }
+        else {
+            glTextureSubImage2D(id, level, 0, 0, data.width, data.height, GL_RGBA, GL_UNSIGNED_BYTE, data.data);
+        }
+    }
+}
+
+void Texture::applyOptions() {
+    glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, options.mag_filter);
+    glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, levels > 1 ? options.minFilter() : GL_LINEAR);
+    glTextureParameteri(id, GL_TEXTURE_WRAP_S, options.wrap);
+    glTextureParameteri(id, GL_TEXTURE_WRAP_T, options.wrap);
+    if (options.anisotropy > 1.0f && GLEW_ARB_texture_filter_anisotropic) {
+        glTextureParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, options.anisotropy);
+    }
+    glTextureParameteri(id, GL_TEXTURE_BASE_LEVEL, resident_level - storage_level);
+    glTextureParameteri(id, GL_TEXTURE_MAX_LEVEL, levels - storage_level - 1);
+    glTextureParameterf(id, GL_TEXTURE_MIN_LOD, min_lod);
+}
+
+size_t Texture::levelBytes(int level) const {
+    return source_levels[level].size;
+}
+
+size_t Texture::streamInCost() const {
+    size_t bytes = 0;
+    for (int level = wanted_level; level < storage_level; level++) {
+        bytes += levelBytes(level);
+    }
+    return bytes;
+}
+
+void Texture::streamIn() {
+    if (!streaming || resident_level <= wanted_level) {
+        return;
+    }
+    if (wanted_level < storage_level) {
+        reallocate(wanted_level);
+    }
+
+    resident_level--;
+    uploadLevel(resident_level - storage_level, 0, source_levels[resident_level]);
+
+    // Vzorkování smí sáhnout na novou úroveň, ale začne na LOD předchozí (bez skoku v ostrosti)
+    min_lod = 1.0f;
+    glTextureParameteri(id, GL_TEXTURE_BASE_LEVEL, resident_level - storage_level);
+    glTextureParameterf(id, GL_TEXTURE_MIN_LOD, min_lod);
+}
+
+void Texture::evictLevel() {
+    if (!streaming || storage_level >= tail_level) {
+        return;
+    }
+    reallocate(storage_level + 1);
+}
+
+void Texture::updateFade(float delta_t, float fade_time) {
+    if (min_lod <= 0.0f) {
+        return;
+    }
+    min_lod = std::max(0.0f, min_lod - delta_t / fade_time);
+    glTextureParameterf(id, GL_TEXTURE_MIN_LOD, min_lod);
+}
+
+void Texture::reallocate(int first_level) {
+    GLuint storage;
+    glCreateTextures(GL_TEXTURE_2D, 1, &storage);
+    glTextureStorage2D(storage, levels - first_level, internal_format,
+        std::max(1, width >> first_level), std::max(1, height >> first_level));
+
+    // Nahrané úrovně, které v novém úložišti zůstanou, se zkopírují bez návratu na CPU
+    int first_copied = std::max(resident_level, first_level);
+    for (int level = first_copied; level < levels; level++) {
+        glCopyImageSubData(id, GL_TEXTURE_2D, level - storage_level, 0, 0, 0,
+            storage, GL_TEXTURE_2D, level - first_level, 0, 0, 0,
+            std::max(1, width >> level), std::max(1, height >> level), 1);
+    }
+    GLState::getInstance()->forgetTexture(id);
+    glDeleteTextures(1, &id);
+    id = storage;
+
+    storage_level = first_level;
+    resident_level = first_copied; // úrovně first_level..resident_level-1 jsou alokované, ale ještě prázdné
+    memory_bytes = 0;
+    for (int level = first_level; level < levels; level++) {
+        memory_bytes += levelBytes(level);
+    }
+    applyOptions();
+}
+
+int Texture::mipLevelCount(int width, int height) {
+    int levels = 1;
+    while ((std::max(width, height) >> levels) > 0) {
+        levels++;
+    }
+    return levels;
+}
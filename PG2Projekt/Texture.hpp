@@ -0,0 +1,149 @@
+﻿#pragma once
+
+#include <climits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "TextureCompressor.hpp"
+
+// Volby vzorkování a formátu textury (součást klíče cache - stejný soubor
+// s jinými volbami je jiná textura)
+struct TextureOptions {
+    bool mipmaps{ true };
+    GLenum wrap{ GL_REPEAT };
+    GLenum mag_filter{ GL_LINEAR };
+    float anisotropy{ 1.0f };
+    // Barvy v sRGB (hardware je při vzorkování převede do lineárního prostoru)
+    bool srgb{ false };
+    // Filtr pro výpočet mipmap na CPU (viz MipGenerator)
+    MipFilter mip_filter{ MipFilter::Box };
+    // Bloková komprese při importu (zkomprimované úrovně se ukládají do TextureCache)
+    TextureCompression compression{ TextureCompression::None };
+    // Streamování (jen 2D s mipmapami): při vytvoření se nahraje jen mip tail, vyšší úrovně
+    // nahrává TextureStreamer podle velikosti objektů na obrazovce
+    bool streaming{ false };
+
+    GLenum minFilter() const {
+        return mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    }
+
+    // Vnitřní formát pro glTextureStorage (nekomprimované úrovně jsou vždy RGBA8)
+    GLenum internalFormat() const {
+        if (compression != TextureCompression::None) {
+            return compressedInternalFormat(compression, srgb);
+        }
+        return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+
+    std::string key() const {
+        std::string key = mipmaps ? "|mip" : "";
+        key += "|w" + std::to_string(wrap) + "|f" + std::to_string(mag_filter);
+        if (anisotropy > 1.0f) {
+            key += "|aniso" + std::to_string(anisotropy);
+        }
+        if (srgb) {
+            key += "|srgb";
+        }
+        if (mipmaps && mip_filter != MipFilter::Box) {
+            key += std::string("|") + mipFilterName(mip_filter);
+        }
+        if (streaming) {
+            key += "|stream";
+        }
+        return key + compressionKey();
+    }
+
+    // Varianta zkomprimovaných dat v cache (na vzorkování nezáleží)
+    std::string compressionKey() const {
+        if (compression == TextureCompression::None) {
+            return "";
+        }
+        std::string key = std::string("|") + compressionName(compression);
+        if (mipmaps) {
+            key += std::string("|mip|") + mipFilterName(mip_filter);
+        }
+        return key;
+    }
+};
+
+// Jedna předpřipravená mip úroveň (RGBA8 nebo bloky BCn)
+struct TextureLevelData {
+    int width{ 0 };
+    int height{ 0 };
+    const void* data{ nullptr };
+    size_t size{ 0 };
+};
+
+// Textura na GPU - sdílená přes std::shared_ptr (viz ResourceManager), GL objekt se smaže,
+// až ji nepoužívá žádný mesh
+struct Texture {
+    GLuint id{ 0 };
+    GLenum target{ GL_TEXTURE_2D };
+    GLenum internal_format{ GL_RGBA8 };
+    TextureCompression compression{ TextureCompression::None };
+    std::string name;
+    int width{ 0 };
+    int height{ 0 };
+    int layers{ 1 };
+    int levels{ 1 };
+    size_t memory_bytes{ 0 }; // velikost na GPU (všechny vrstvy a alokované mip úrovně)
+
+    // Streamování mip úrovní (řídí TextureStreamer). Úložiště pokrývá jen úrovně storage_level..levels-1
+    // (úroveň 0 GL objektu = storage_level), nahrané jsou resident_level..levels-1 a vzorkování je na ně
+    // omezené přes GL_TEXTURE_BASE_LEVEL; nově nahraná úroveň se plynule prolne přes GL_TEXTURE_MIN_LOD.
+    bool streaming{ false };
+    int storage_level{ 0 };
+    int resident_level{ 0 };
+    int tail_level{ 0 };                // mip tail - na GPU od vytvoření, nikdy se neuvolní
+    int requested_level{ INT_MAX };     // nejjemnější úroveň požadovaná v tomto snímku
+    int wanted_level{ 0 };              // poslední známý požadavek
+    double last_seen{ 0.0 };            // čas posledního požadavku (glfwGetTime)
+    float min_lod{ 0.0f };              // probíhající prolnutí nové úrovně (1 -> 0)
+
+    // Největší rozměr mip tailu streamované textury
+    static constexpr int STREAMING_TAIL_SIZE = 128;
+
+    // 2D textura s hotovým mip řetězcem z CPU - na GL vlákně už jen glTextureSubImage2D
+    // (resp. glCompressedTextureSubImage2D) pro každou úroveň, žádné glGenerateTextureMipmap.
+    // Streamovaná textura (options.streaming) nahraje jen mip tail a drží si source - vlastníka dat úrovní.
+    Texture(const std::string& name, const std::vector<TextureLevelData>& level_data,
+        const TextureOptions& options = TextureOptions(), std::shared_ptr<const void> source = nullptr);
+    // Pole textur (GL_TEXTURE_2D_ARRAY) - každá vrstva má vlastní mip řetězec stejného rozměru
+    Texture(const std::string& name, const std::vector<std::vector<TextureLevelData>>& layer_levels,
+        const TextureOptions& options = TextureOptions());
+
+    ~Texture();
+
+    // Vlastní GL objekt - kopírování není povoleno
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // Velikost na GPU v bajtech (všechny vrstvy a mip úrovně)
+    size_t gpuBytes() const { return memory_bytes; }
+    bool compressed() const { return compression != TextureCompression::None; }
+
+    // Streamování: kolik bajtů navíc by alokovalo nahrání další úrovně (0 = úložiště už existuje)
+    size_t streamInCost() const;
+    // Nahrání další jemnější úrovně (úložiště se podle potřeby zvětší až po wanted_level najednou)
+    void streamIn();
+    // Uvolnění nejjemnější alokované úrovně (nové menší úložiště, zbytek se zkopíruje na GPU)
+    void evictLevel();
+    // Prolnutí nově nahrané úrovně - posun GL_TEXTURE_MIN_LOD k 0
+    void updateFade(float delta_t, float fade_time);
+
+    // Počet mip úrovní až do 1x1
+    static int mipLevelCount(int width, int height);
+
+private:
+    TextureOptions options;
+    std::vector<TextureLevelData> source_levels; // data všech úrovní na CPU (jen streamování)
+    std::shared_ptr<const void> source;
+
+    // Nahrání jedné úrovně (level = index v GL objektu, u pole jedné vrstvy)
+    void uploadLevel(int level, int layer, const TextureLevelData& data);
+    void applyOptions();
+    // Nové úložiště od úrovně first_level - nahrané úrovně se zkopírují (glCopyImageSubData)
+    void reallocate(int first_level);
+    size_t levelBytes(int level) const;
+};
@@ -0,0 +1,160 @@
+﻿#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "TextureCache.hpp"
+#include "MeshCache.hpp"
+#include "ResourceManager.hpp"
+
+const std::filesystem::path TextureCache::CACHE_DIRECTORY = "cache/textures";
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+uint32_t TextureCache::vkFormat(TextureCompression compression) {
+    switch (compression) {
+    case TextureCompression::BC1: return 131; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case TextureCompression::BC3: return 137; // VK_FORMAT_BC3_UNORM_BLOCK
+    case TextureCompression::BC7: return 145; // VK_FORMAT_BC7_UNORM_BLOCK
+    default: return 0;                        // VK_FORMAT_UNDEFINED
+    }
+}
+
+std::filesystem::path TextureCache::cachePath(const std::filesystem::path& source, const std::string& variant) {
+    std::string key = ResourceManager::pathKey(source) + variant;
+    std::ostringstream name;
+    name << source.stem().string() << "-" << std::hex << std::setw(16) << std::setfill('0')
+        << MeshCache::hashBytes(key.data(), key.size()) << ".pgtex";
+    return CACHE_DIRECTORY / name.str();
+}
+
+bool TextureCache::load(const std::filesystem::path& source, const std::string& variant, TextureCacheEntry& out) {
+    std::filesystem::path path = cachePath(source, variant);
+    if (!std::filesystem::exists(path) || !out.file.open(path)) {
+        return false;
+    }
+
+    if (out.file.size() < sizeof(TextureCacheHeader)) {
+        out.file.close();
+        return false;
+    }
+    TextureCacheHeader header;
+    std::memcpy(&header, out.file.data(), sizeof(header));
+
+    TextureCompression compression = static_cast<TextureCompression>(header.compression);
+    if (header.magic != TextureCacheHeader::MAGIC || header.version != TextureCacheHeader::VERSION ||
+        header.level_count == 0 || header.level_count > TextureCacheHeader::MAX_LEVELS ||
+        header.vk_format != vkFormat(compression) || header.vk_format == 0) {
+        std::cout << "Texture cache " << path.filename().string() << ": incompatible format, rebuilding" << std::endl;
+        out.file.close();
+        return false;
+    }
+
+    // Každá úroveň musí mít očekávanou velikost a ležet celá v souboru
+    for (uint32_t level = 0; level < header.level_count; level++) {
+        int width = std::max(1, static_cast<int>(header.pixel_width >> level));
+        int height = std::max(1, static_cast<int>(header.pixel_height >> level));
+        const TextureCacheLevel& entry = header.levels[level];
+        if (entry.byte_length != compressedLevelBytes(compression, width, height) ||
+            entry.byte_offset + entry.byte_length > out.file.size()) {
+            std::cerr << "Texture cache " << path.filename().string() << ": truncated file, rebuilding" << std::endl;
+            out.file.close();
+            return false;
+        }
+    }
+
+    // Zastaralost - velikost + čas změny, při neshodě času rozhoduje hash obsahu
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    if (!MeshCache::sourceInfo(source, source_size, source_mtime) || source_size != header.source_size) {
+        out.file.close();
+        return false;
+    }
+    if (source_mtime != header.source_mtime) {
+        if (MeshCache::hashFile(source) != header.source_hash) {
+            std::cout << "Texture cache " << path.filename().string() << ": source changed, rebuilding" << std::endl;
+            out.file.close();
+            return false;
+        }
+        if (!MeshCache::refreshSourceTime(out.file, path, offsetof(TextureCacheHeader, source_mtime), source_mtime)) {
+            return false;
+        }
+    }
+
+    out.header = reinterpret_cast<const TextureCacheHeader*>(out.file.data());
+    return true;
+}
+
+bool TextureCache::store(const std::filesystem::path& source, const std::string& variant, TextureCompression compression,
+    int width, int height, const std::vector<std::vector<uint8_t>>& levels) {
+    if (levels.empty() || levels.size() > TextureCacheHeader::MAX_LEVELS) {
+        return false;
+    }
+
+    TextureCacheHeader header{};
+    header.magic = TextureCacheHeader::MAGIC;
+    header.version = TextureCacheHeader::VERSION;
+    if (!MeshCache::sourceInfo(source, header.source_size, header.source_mtime)) {
+        return false;
+    }
+    header.source_hash = MeshCache::hashFile(source);
+    header.vk_format = vkFormat(compression);
+    header.compression = static_cast<uint32_t>(compression);
+    header.pixel_width = static_cast<uint32_t>(width);
+    header.pixel_height = static_cast<uint32_t>(height);
+    header.level_count = static_cast<uint32_t>(levels.size());
+
+    // Jako v KTX2 jsou v souboru nejdřív nejmenší úrovně
+    size_t offset = alignUp(sizeof(TextureCacheHeader), 16);
+    for (size_t i = levels.size(); i-- > 0;) {
+        header.levels[i].byte_offset = offset;
+        header.levels[i].byte_length = levels[i].size();
+        header.levels[i].uncompressed_byte_length = static_cast<uint64_t>(std::max(1, width >> i)) *
+            std::max(1, height >> i) * 4;
+        offset = alignUp(offset + levels[i].size(), 16);
+    }
+
+    std::filesystem::path path = cachePath(source, variant);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Zápis do dočasného souboru a přejmenování - rozepsaný soubor se nikdy nenačte
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Texture cache: cannot write " << temp_path.string() << std::endl;
+            return false;
+        }
+
+        const char zeros[16] = {};
+        size_t position = sizeof(header);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t i = levels.size(); i-- > 0;) {
+            file.write(zeros, header.levels[i].byte_offset - position);
+            file.write(reinterpret_cast<const char*>(levels[i].data()), levels[i].size());
+            position = header.levels[i].byte_offset + levels[i].size();
+        }
+        if (!file) {
+            std::cerr << "Texture cache: write failed " << temp_path.string() << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "Texture cache: cannot replace " << path.string() << ": " << ec.message() << std::endl;
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
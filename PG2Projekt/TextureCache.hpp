@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "TextureCompressor.hpp"
+
+// Cache zkomprimovaných textur (*.pgtex) - rozložení podle KTX2: formát jako VkFormat,
+// tabulka úrovní (offset, délka) a data úrovní od nejmenší po největší. Oproti KTX2 nese hlavička
+// informace o zdrojovém souboru (kontrola zastaralosti jako u MeshCache) a GL vnitřní formát.
+//
+// Rozložení souboru: TextureCacheHeader | úroveň N-1 | ... | úroveň 0 (každá zarovnaná na 16 B)
+
+// Záznam v tabulce úrovní (shodný s KTX2 level index)
+struct TextureCacheLevel {
+    uint64_t byte_offset;
+    uint64_t byte_length;
+    uint64_t uncompressed_byte_length;
+};
+
+struct TextureCacheHeader {
+    static constexpr uint32_t MAGIC = 0x58455450; // "PTEX"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAX_LEVELS = 16;
+
+    uint32_t magic;
+    uint32_t version;
+
+    // Zdrojový soubor
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t source_hash;
+
+    // Formát
+    uint32_t vk_format;          // VkFormat (např. VK_FORMAT_BC7_UNORM_BLOCK = 145)
+    uint32_t compression;        // TextureCompression
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t level_count;
+    uint32_t reserved;
+
+    TextureCacheLevel levels[MAX_LEVELS];
+};
+
+// Namapovaný platný záznam - data úrovní míří přímo do souboru
+struct TextureCacheEntry {
+    MappedFile file;
+    const TextureCacheHeader* header{ nullptr };
+
+    TextureCompression compression() const { return static_cast<TextureCompression>(header->compression); }
+    const uint8_t* levelData(uint32_t level) const {
+        return reinterpret_cast<const uint8_t*>(file.data()) + header->levels[level].byte_offset;
+    }
+};
+
+class TextureCache {
+public:
+    static const std::filesystem::path CACHE_DIRECTORY;
+
+    // Soubor v cache pro daný zdroj a variantu (formát komprese, mipmapy)
+    static std::filesystem::path cachePath(const std::filesystem::path& source, const std::string& variant);
+
+    // Namapování záznamu - false, pokud neexistuje, je jiné verze nebo je zdroj novější
+    static bool load(const std::filesystem::path& source, const std::string& variant, TextureCacheEntry& out);
+
+    // Uložení zkomprimovaných úrovní (levels[0] = plné rozlišení)
+    static bool store(const std::filesystem::path& source, const std::string& variant, TextureCompression compression,
+        int width, int height, const std::vector<std::vector<uint8_t>>& levels);
+
+    // VkFormat pro KTX2 popis formátu
+    static uint32_t vkFormat(TextureCompression compression);
+};
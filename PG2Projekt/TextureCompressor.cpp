@@ -0,0 +1,637 @@
+﻿#include "TextureCompressor.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Průměr a hlavní osa (mocninná metoda na kovarianční matici) barev bloku
+void principalAxis(const float pixels[16][4], int channels, float mean[4], float axis[4]) {
+    float minimum[4], maximum[4];
+    for (int c = 0; c < 4; c++) {
+        mean[c] = 0.0f;
+        minimum[c] = 255.0f;
+        maximum[c] = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            mean[c] += pixels[i][c];
+            minimum[c] = std::min(minimum[c], pixels[i][c]);
+            maximum[c] = std::max(maximum[c], pixels[i][c]);
+        }
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++) {
+        for (int a = 0; a < channels; a++) {
+            for (int b = a; b < channels; b++) {
+                covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+            }
+        }
+    }
+    for (int a = 0; a < channels; a++) {
+        for (int b = 0; b < a; b++) {
+            covariance[a][b] = covariance[b][a];
+        }
+    }
+
+    // Start ze sloupce s největším rozptylem - pevný vektor (1,1,1) je kolmý na osu
+    // barev s nulovým součtem rozdílů (např. červená/zelená) a iterace by skončila na nule
+    int start = 0;
+    for (int a = 1; a < channels; a++) {
+        if (covariance[a][a] > covariance[start][start]) {
+            start = a;
+        }
+    }
+    float vector[4] = {};
+    for (int a = 0; a < channels; a++) {
+        vector[a] = covariance[a][start];
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * vector[b];
+            }
+        }
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            length = std::max(length, std::fabs(next[a]));
+        }
+        if (length < 1e-6f) {
+            // Degenerovaná iterace - osou je úhlopříčka obalového kvádru (u jednobarevného bloku nulová)
+            for (int a = 0; a < channels; a++) {
+                vector[a] = maximum[a] - minimum[a];
+            }
+            break;
+        }
+        for (int a = 0; a < channels; a++) {
+            vector[a] = next[a] / length;
+        }
+    }
+
+    float length = 0.0f;
+    for (int a = 0; a < channels; a++) {
+        length += vector[a] * vector[a];
+    }
+    length = std::sqrt(length);
+    for (int a = 0; a < 4; a++) {
+        axis[a] = a < channels && length > 0.0f ? vector[a] / length : 0.0f;
+    }
+}
+
+// Krajní body bloku na hlavní ose, mírně zúžené dovnitř (menší chyba pro většinu pixelů)
+void axisEndpoints(const float pixels[16][4], int channels, float low[4], float high[4]) {
+    float mean[4], axis[4];
+    principalAxis(pixels, channels, mean, axis);
+
+    float t_min = 0.0f, t_max = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (pixels[i][c] - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    float inset = (t_max - t_min) / 32.0f;
+    t_min += inset;
+    t_max -= inset;
+
+    for (int c = 0; c < 4; c++) {
+        low[c] = std::clamp(mean[c] + axis[c] * t_min, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * t_max, 0.0f, 255.0f);
+    }
+}
+
+void loadBlock(const uint8_t rgba[64], float pixels[16][4]) {
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            pixels[i][c] = rgba[i * 4 + c];
+        }
+    }
+}
+
+// ---------------------------------------------------------------- BC1
+
+uint16_t packRGB565(const float color[3]) {
+    int r = std::clamp(static_cast<int>(std::lround(color[0] * 31.0f / 255.0f)), 0, 31);
+    int g = std::clamp(static_cast<int>(std::lround(color[1] * 63.0f / 255.0f)), 0, 63);
+    int b = std::clamp(static_cast<int>(std::lround(color[2] * 31.0f / 255.0f)), 0, 31);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(uint16_t value, int color[3]) {
+    int r = (value >> 11) & 31;
+    int g = (value >> 5) & 63;
+    int b = value & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Zakódování bloku pro dané koncové barvy - vrací součet čtverců chyb
+float encodeBC1(const float pixels[16][4], const float high[3], const float low[3], uint8_t out[8], uint8_t indices[16]) {
+    uint16_t c0 = packRGB565(high);
+    uint16_t c1 = packRGB565(low);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    // Paleta režimu se 4 barvami (c0 > c1): c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+    int palette[4][3];
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    int palette_size = c0 == c1 ? 1 : 4;
+
+    float error = 0.0f;
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0;
+        float best_error = 1e30f;
+        for (int k = 0; k < palette_size; k++) {
+            float e = 0.0f;
+            for (int c = 0; c < 3; c++) {
+                float d = pixels[i][c] - palette[k][c];
+                e += d * d;
+            }
+            if (e < best_error) {
+                best_error = e;
+                best = k;
+            }
+        }
+        indices[i] = static_cast<uint8_t>(best);
+        bits |= static_cast<uint32_t>(best) << (2 * i);
+        error += best_error;
+    }
+
+    out[0] = c0 & 0xFF;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xFF;
+    out[3] = c1 >> 8;
+    std::memcpy(out + 4, &bits, 4);
+    return error;
+}
+
+// Koncové barvy metodou nejmenších čtverců pro dané přiřazení indexů
+bool refineBC1(const float pixels[16][4], const uint8_t indices[16], float high[3], float low[3]) {
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; i++) {
+        float a = weights[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < 3; c++) {
+            ax[c] += a * pixels[i][c];
+            bx[c] += b * pixels[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < 3; c++) {
+        high[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        low[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+void compressColorBC1(const float pixels[16][4], uint8_t out[8]) {
+    float low[4], high[4];
+    axisEndpoints(pixels, 3, low, high);
+
+    uint8_t indices[16];
+    float error = encodeBC1(pixels, high, low, out, indices);
+
+    // Dvě iterace zpřesnění koncových barev - ponechá se lepší výsledek
+    for (int iteration = 0; iteration < 2 && error > 0.0f; iteration++) {
+        if (!refineBC1(pixels, indices, high, low)) {
+            break;
+        }
+        uint8_t candidate[8], candidate_indices[16];
+        float candidate_error = encodeBC1(pixels, high, low, candidate, candidate_indices);
+        if (candidate_error >= error) {
+            break;
+        }
+        error = candidate_error;
+        std::memcpy(out, candidate, 8);
+        std::memcpy(indices, candidate_indices, 16);
+    }
+}
+
+// ---------------------------------------------------------------- BC4 (alfa v BC3)
+
+void compressAlphaBC4(const float pixels[16][4], uint8_t out[8]) {
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++) {
+        a0 = std::max(a0, static_cast<int>(pixels[i][3]));
+        a1 = std::min(a1, static_cast<int>(pixels[i][3]));
+    }
+
+    // Režim s 8 hodnotami (a0 > a1): a0, a1 a 6 interpolovaných
+    int palette[8] = { a0, a1 };
+    for (int k = 1; k <= 6; k++) {
+        palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+    }
+
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int best_error = 1 << 30;
+            for (int k = 0; k < 8; k++) {
+                int e = std::abs(static_cast<int>(pixels[i][3]) - palette[k]);
+                if (e < best_error) {
+                    best_error = e;
+                    best = k;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(a0);
+    out[1] = static_cast<uint8_t>(a1);
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+// ---------------------------------------------------------------- BC7 (režim 6)
+
+// Zápis bitů od nejnižšího (bloky BC7 jsou little-endian bitové pole)
+struct BitWriter {
+    uint8_t* out;
+    int position{ 0 };
+
+    void write(uint32_t value, int bits) {
+        for (int b = 0; b < bits; b++, position++) {
+            out[position >> 3] |= static_cast<uint8_t>(((value >> b) & 1) << (position & 7));
+        }
+    }
+};
+
+const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Režim 6: jedna podmnožina, koncové body RGBA 7 bitů + p-bit každého bodu, 4bitové indexy
+void compressBlockBC7Mode6(const float pixels[16][4], uint8_t out[16]) {
+    float low[4], high[4];
+    axisEndpoints(pixels, 4, low, high);
+
+    int best_endpoints[2][4] = {};
+    int best_pbits[2] = {};
+    uint8_t best_indices[16] = {};
+    float best_error = 1e30f;
+
+    // Vyzkoušení všech kombinací p-bitů
+    for (int p0 = 0; p0 < 2; p0++) {
+        for (int p1 = 0; p1 < 2; p1++) {
+            int quantized[2][4];
+            int expanded[2][4];
+            for (int c = 0; c < 4; c++) {
+                quantized[0][c] = std::clamp(static_cast<int>(std::lround((low[c] - p0) / 2.0f)), 0, 127);
+                quantized[1][c] = std::clamp(static_cast<int>(std::lround((high[c] - p1) / 2.0f)), 0, 127);
+                expanded[0][c] = (quantized[0][c] << 1) | p0;
+                expanded[1][c] = (quantized[1][c] << 1) | p1;
+            }
+
+            int palette[16][4];
+            for (int k = 0; k < 16; k++) {
+                for (int c = 0; c < 4; c++) {
+                    palette[k][c] = ((64 - BC7_WEIGHTS4[k]) * expanded[0][c] + BC7_WEIGHTS4[k] * expanded[1][c] + 32) >> 6;
+                }
+            }
+
+            float error = 0.0f;
+            uint8_t indices[16];
+            for (int i = 0; i < 16 && error < best_error; i++) {
+                int best = 0;
+                float pixel_error = 1e30f;
+                for (int k = 0; k < 16; k++) {
+                    float e = 0.0f;
+                    for (int c = 0; c < 4; c++) {
+                        float d = pixels[i][c] - palette[k][c];
+                        e += d * d;
+                    }
+                    if (e < pixel_error) {
+                        pixel_error = e;
+                        best = k;
+                    }
+                }
+                indices[i] = static_cast<uint8_t>(best);
+                error += pixel_error;
+            }
+
+            if (error < best_error) {
+                best_error = error;
+                std::memcpy(best_endpoints, quantized, sizeof(quantized));
+                best_pbits[0] = p0;
+                best_pbits[1] = p1;
+                std::memcpy(best_indices, indices, sizeof(indices));
+            }
+        }
+    }
+
+    // Kotevní index (pixel 0) musí mít nejvyšší bit nulový - jinak se prohodí koncové body
+    if (best_indices[0] & 8) {
+        for (int c = 0; c < 4; c++) {
+            std::swap(best_endpoints[0][c], best_endpoints[1][c]);
+        }
+        std::swap(best_pbits[0], best_pbits[1]);
+        for (int i = 0; i < 16; i++) {
+            best_indices[i] = static_cast<uint8_t>(15 - best_indices[i]);
+        }
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer{ out };
+    writer.write(1 << 6, 7); // režim 6
+    for (int c = 0; c < 4; c++) {
+        writer.write(best_endpoints[0][c], 7);
+        writer.write(best_endpoints[1][c], 7);
+    }
+    writer.write(best_pbits[0], 1);
+    writer.write(best_pbits[1], 1);
+    writer.write(best_indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        writer.write(best_indices[i], 4);
+    }
+}
+
+// ---------------------------------------------------------------- Dekódování (jen pro kontrolu kodéru)
+
+void decodeColorBC1(const uint8_t block[8], uint8_t rgba[64]) {
+    uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    int palette[4][4];
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        if (c0 > c1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    for (int k = 0; k < 4; k++) {
+        palette[k][3] = c0 <= c1 && k == 3 ? 0 : 255;
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, block + 4, 4);
+    for (int i = 0; i < 16; i++) {
+        const int* color = palette[(bits >> (2 * i)) & 3];
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+        }
+    }
+}
+
+void decodeAlphaBC4(const uint8_t block[8], uint8_t rgba[64]) {
+    int a0 = block[0], a1 = block[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+        for (int k = 1; k <= 6; k++) {
+            palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+        }
+    }
+    else {
+        for (int k = 1; k <= 4; k++) {
+            palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; i++) {
+        bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+    }
+}
+
+// Jen režim 6 (jiný kodér nevytváří) - pro ostatní režimy vrací false
+bool decodeBC7Mode6(const uint8_t block[16], uint8_t rgba[64]) {
+    int position = 0;
+    auto read = [&](int bits) {
+        uint32_t value = 0;
+        for (int b = 0; b < bits; b++, position++) {
+            value |= static_cast<uint32_t>((block[position >> 3] >> (position & 7)) & 1) << b;
+        }
+        return value;
+    };
+
+    if (read(7) != (1u << 6)) {
+        return false;
+    }
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = static_cast<int>(read(7)) << 1;
+        endpoints[1][c] = static_cast<int>(read(7)) << 1;
+    }
+    int p0 = static_cast<int>(read(1));
+    int p1 = static_cast<int>(read(1));
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] |= p0;
+        endpoints[1][c] |= p1;
+    }
+    for (int i = 0; i < 16; i++) {
+        int weight = BC7_WEIGHTS4[read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+// Porovnání dekódovaného bloku s originálem - tolerance pokryje kvantizaci koncových bodů (RGB565)
+bool blockMatches(const uint8_t original[64], const uint8_t decoded[64], bool alpha) {
+    for (int i = 0; i < 64; i++) {
+        if ((alpha || i % 4 != 3) && std::abs(original[i] - decoded[i]) > 8) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+const char* compressionName(TextureCompression compression) {
+    switch (compression) {
+    case TextureCompression::BC1: return "BC1";
+    case TextureCompression::BC3: return "BC3";
+    case TextureCompression::BC7: return "BC7";
+    default: return "none";
+    }
+}
+
+TextureCompression parseCompression(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "bc1") {
+        return TextureCompression::BC1;
+    }
+    if (lower == "bc3") {
+        return TextureCompression::BC3;
+    }
+    if (lower == "bc7") {
+        return TextureCompression::BC7;
+    }
+    return TextureCompression::None;
+}
+
+size_t compressedBlockBytes(TextureCompression compression) {
+    return compression == TextureCompression::BC1 ? 8 : 16;
+}
+
+size_t compressedLevelBytes(TextureCompression compression, int width, int height) {
+    size_t blocks_x = (static_cast<size_t>(width) + 3) / 4;
+    size_t blocks_y = (static_cast<size_t>(height) + 3) / 4;
+    return blocks_x * blocks_y * compressedBlockBytes(compression);
+}
+
+GLenum compressedInternalFormat(TextureCompression compression, bool srgb) {
+    switch (compression) {
+    case TextureCompression::BC1:
+        return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureCompression::BC3:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TextureCompression::BC7:
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        throw std::runtime_error("Texture compression format not set");
+    }
+}
+
+void compressBlockBC1(const uint8_t rgba[64], uint8_t out[8]) {
+    float pixels[16][4];
+    loadBlock(rgba, pixels);
+    compressColorBC1(pixels, out);
+}
+
+void compressBlockBC3(const uint8_t rgba[64], uint8_t out[16]) {
+    float pixels[16][4];
+    loadBlock(rgba, pixels);
+    compressAlphaBC4(pixels, out);
+    compressColorBC1(pixels, out + 8);
+}
+
+void compressBlockBC7(const uint8_t rgba[64], uint8_t out[16]) {
+    float pixels[16][4];
+    loadBlock(rgba, pixels);
+    compressBlockBC7Mode6(pixels, out);
+}
+
+bool verifyCompression() {
+    // Dvoubarevné šachovnice, jejichž rozdíl barev má nulový součet složek (osa kolmá na šedou)
+    static const uint8_t colors[][2][4] = {
+        { { 255, 0, 0, 255 }, { 0, 255, 0, 255 } },
+        { { 200, 50, 120, 255 }, { 50, 200, 120, 255 } },
+        { { 0, 0, 255, 255 }, { 255, 255, 0, 255 } },
+    };
+
+    bool valid = true;
+    for (const auto& pair : colors) {
+        uint8_t block[64];
+        for (int i = 0; i < 16; i++) {
+            std::memcpy(block + i * 4, pair[((i & 3) + (i >> 2)) & 1], 4);
+        }
+
+        uint8_t compressed[16], decoded[64];
+        const TextureCompression formats[] = { TextureCompression::BC1, TextureCompression::BC3, TextureCompression::BC7 };
+        for (TextureCompression format : formats) {
+            bool decodable = true;
+            switch (format) {
+            case TextureCompression::BC1:
+                compressBlockBC1(block, compressed);
+                decodeColorBC1(compressed, decoded);
+                break;
+            case TextureCompression::BC3:
+                compressBlockBC3(block, compressed);
+                decodeColorBC1(compressed + 8, decoded);
+                decodeAlphaBC4(compressed, decoded);
+                break;
+            default:
+                compressBlockBC7(block, compressed);
+                decodable = decodeBC7Mode6(compressed, decoded);
+                break;
+            }
+
+            if (!decodable || !blockMatches(block, decoded, format != TextureCompression::BC1)) {
+                std::cerr << "Texture compression check failed: " << compressionName(format) << " block ("
+                    << +pair[0][0] << "," << +pair[0][1] << "," << +pair[0][2] << ")|("
+                    << +pair[1][0] << "," << +pair[1][1] << "," << +pair[1][2] << ") lost its colours" << std::endl;
+                valid = false;
+            }
+        }
+    }
+    return valid;
+}
+
+std::vector<uint8_t> compressImage(const RgbaImage& image, TextureCompression compression, unsigned int thread_count) {
+    if (compression == TextureCompression::None) {
+        throw std::runtime_error("Texture compression format not set");
+    }
+
+    const int blocks_x = (image.width + 3) / 4;
+    const int blocks_y = (image.height + 3) / 4;
+    const size_t block_bytes = compressedBlockBytes(compression);
+    std::vector<uint8_t> result(static_cast<size_t>(blocks_x) * blocks_y * block_bytes);
+
+    // Řádky bloků po skupinách - bloky jsou nezávislé, vlákna nic nesdílí
+    auto compressRows = [&](int first_row, int last_row) {
+        uint8_t block[64];
+        for (int by = first_row; by < last_row; by++) {
+            for (int bx = 0; bx < blocks_x; bx++) {
+                // Okrajové bloky - pixely mimo obrázek se nahradí krajními
+                for (int py = 0; py < 4; py++) {
+                    int y = std::min(by * 4 + py, image.height - 1);
+                    for (int px = 0; px < 4; px++) {
+                        int x = std::min(bx * 4 + px, image.width - 1);
+                        std::memcpy(block + (py * 4 + px) * 4, &image.pixels[(static_cast<size_t>(y) * image.width + x) * 4], 4);
+                    }
+                }
+
+                uint8_t* out = &result[(static_cast<size_t>(by) * blocks_x + bx) * block_bytes];
+                switch (compression) {
+                case TextureCompression::BC1: compressBlockBC1(block, out); break;
+                case TextureCompression::BC3: compressBlockBC3(block, out); break;
+                default: compressBlockBC7(block, out); break;
+                }
+            }
+        }
+    };
+
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Malé úrovně (konec mip řetězce) se nevyplatí dělit
+    int chunk_count = std::clamp(static_cast<int>(thread_count), 1, std::max(1, blocks_y / 8));
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < chunk_count; i++) {
+        workers.emplace_back(compressRows, blocks_y * i / chunk_count, blocks_y * (i + 1) / chunk_count);
+    }
+    compressRows(0, blocks_y / chunk_count);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return result;
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include "MipGenerator.hpp"
+
+// Blokové kompresní formáty (bloky 4x4 pixely), komprese probíhá na CPU při importu
+enum class TextureCompression : uint32_t {
+    None = 0,
+    BC1 = 1, // RGB, 8 B na blok (4 bity na pixel) - neprůhledné textury
+    BC3 = 2, // RGBA, 16 B na blok - barva jako BC1 + interpolovaná alfa (BC4)
+    BC7 = 3, // RGBA, 16 B na blok - nejvyšší kvalita (kodér používá režim 6)
+};
+
+const char* compressionName(TextureCompression compression);
+// "bc1" / "bc3" / "bc7" (bez ohledu na velikost písmen), jinak None
+TextureCompression parseCompression(const std::string& name);
+
+// Velikost bloku a celé úrovně v bajtech
+size_t compressedBlockBytes(TextureCompression compression);
+size_t compressedLevelBytes(TextureCompression compression, int width, int height);
+// Vnitřní formát pro glTextureStorage2D
+GLenum compressedInternalFormat(TextureCompression compression, bool srgb);
+
+// Komprese jednoho bloku 4x4 (rgba = 16 pixelů po řádcích)
+void compressBlockBC1(const uint8_t rgba[64], uint8_t out[8]);
+void compressBlockBC3(const uint8_t rgba[64], uint8_t out[16]);
+void compressBlockBC7(const uint8_t rgba[64], uint8_t out[16]);
+
+// Kontrola kodérů: dvoubarevné bloky projdou kompresí BC1/BC3/BC7 a dekódováním, obě barvy musí zůstat
+bool verifyCompression();
+
+// Komprese celé úrovně - řádky bloků se rozdělí mezi vlákna (0 = podle počtu jader)
+std::vector<uint8_t> compressImage(const RgbaImage& image, TextureCompression compression, unsigned int thread_count = 0);
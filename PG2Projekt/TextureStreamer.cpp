@@ -0,0 +1,120 @@
+﻿#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+TextureStreamer* TextureStreamer::instance = nullptr;
+
+TextureStreamer* TextureStreamer::getInstance() {
+    if (!instance) {
+        instance = new TextureStreamer();
+    }
+    return instance;
+}
+
+void TextureStreamer::add(const std::shared_ptr<Texture>& texture) {
+    if (texture && texture->streaming) {
+        textures.push_back(texture);
+    }
+}
+
+void TextureStreamer::request(Texture& texture, float screen_pixels) {
+    if (!texture.streaming) {
+        return;
+    }
+    // Úroveň, jejíž rozlišení odpovídá velikosti na obrazovce (1 texel ~ 1 pixel)
+    float texels = static_cast<float>(std::max(texture.width, texture.height));
+    int level = static_cast<int>(std::floor(std::log2(std::max(1.0f, texels / std::max(screen_pixels, 1.0f)))));
+    texture.requested_level = std::min(texture.requested_level, std::clamp(level, 0, texture.tail_level));
+}
+
+void TextureStreamer::update(double time, float delta_t, double budget_ms) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::shared_ptr<Texture>> live;
+    textures.erase(std::remove_if(textures.begin(), textures.end(),
+        [](const std::weak_ptr<Texture>& texture) { return texture.expired(); }), textures.end());
+    for (const auto& weak : textures) {
+        live.push_back(weak.lock());
+    }
+
+    size_t resident = 0;
+    for (const auto& texture : live) {
+        if (texture->requested_level != INT_MAX) {
+            texture->wanted_level = texture->requested_level;
+            texture->last_seen = time;
+            texture->requested_level = INT_MAX;
+        }
+        else if (time - texture->last_seen > EVICT_AFTER_SECONDS) {
+            texture->wanted_level = texture->tail_level;
+        }
+        texture->updateFade(delta_t, FADE_TIME);
+        resident += texture->gpuBytes();
+    }
+
+    // Nejdřív textury, kterým chybí nejvíc úrovní
+    std::vector<std::shared_ptr<Texture>> pending;
+    for (const auto& texture : live) {
+        if (texture->resident_level > texture->wanted_level) {
+            pending.push_back(texture);
+        }
+    }
+    std::sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return a->resident_level - a->wanted_level > b->resident_level - b->wanted_level;
+        });
+
+    for (const auto& texture : pending) {
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        if (elapsed > budget_ms) {
+            break;
+        }
+
+        // Místo v limitu - uvolnění nejjemnějších úrovní textur, které nejdéle nebyly vidět
+        size_t cost = texture->streamInCost();
+        while (resident + cost > budget_bytes) {
+            std::shared_ptr<Texture> victim;
+            for (const auto& candidate : live) {
+                if (candidate == texture || candidate->storage_level >= candidate->tail_level ||
+                    time - candidate->last_seen <= EVICT_AFTER_SECONDS) {
+                    continue;
+                }
+                if (!victim || candidate->last_seen < victim->last_seen) {
+                    victim = candidate;
+                }
+            }
+            if (!victim) {
+                break;
+            }
+            resident -= victim->gpuBytes();
+            victim->evictLevel();
+            resident += victim->gpuBytes();
+            evicted_levels++;
+        }
+        if (resident + cost > budget_bytes) {
+            continue;
+        }
+
+        resident -= texture->gpuBytes();
+        texture->streamIn();
+        resident += texture->gpuBytes();
+        streamed_levels++;
+    }
+}
+
+size_t TextureStreamer::residentBytes() const {
+    size_t bytes = 0;
+    for (const auto& weak : textures) {
+        if (auto texture = weak.lock()) {
+            bytes += texture->gpuBytes();
+        }
+    }
+    return bytes;
+}
+
+void TextureStreamer::printStats() const {
+    std::cout << "Texture streaming: " << textures.size() << " textures, "
+        << residentBytes() / 1024 << " / " << budget_bytes / 1024 << " KB, "
+        << streamed_levels << " levels streamed, " << evicted_levels << " evicted" << std::endl;
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+#include "Texture.hpp"
+
+// Streamování mip úrovní textur (TextureOptions::streaming). Textura začne jen s mip tailem,
+// vykreslování každý snímek nahlásí, jak velký je objekt s texturou na obrazovce, a update()
+// podle toho nahrává jemnější úrovně - vždy jednu úroveň na texturu a krok, s časovým limitem.
+// Při překročení paměťového limitu se uvolní nejjemnější úrovně textur, které nebyly dlouho vidět.
+class TextureStreamer {
+private:
+    static TextureStreamer* instance;
+
+    TextureStreamer() = default;
+
+    std::vector<std::weak_ptr<Texture>> textures;
+    size_t budget_bytes{ 256u * 1024u * 1024u };
+
+    // Statistiky
+    size_t streamed_levels{ 0 };
+    size_t evicted_levels{ 0 };
+
+public:
+    // Po jak dlouhé době bez požadavku je textura kandidát na uvolnění
+    static constexpr double EVICT_AFTER_SECONDS = 5.0;
+    // Délka prolnutí nově nahrané úrovně
+    static constexpr float FADE_TIME = 0.25f;
+
+    static TextureStreamer* getInstance();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    void add(const std::shared_ptr<Texture>& texture);
+
+    // Požadavek z vykreslování - objekt s texturou zabírá na obrazovce zhruba screen_pixels pixelů
+    void request(Texture& texture, float screen_pixels);
+
+    // Zpracování požadavků snímku: prolnutí, nahrání chybějících úrovní a uvolnění podle limitu paměti
+    void update(double time, float delta_t, double budget_ms);
+
+    // Paměťový limit pro všechny streamované textury (v bajtech)
+    void setBudget(size_t bytes) { budget_bytes = bytes; }
+    size_t budget() const { return budget_bytes; }
+    size_t residentBytes() const;
+
+    void printStats() const;
+};
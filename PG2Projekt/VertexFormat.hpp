@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include "assets.hpp"
+
+// Formát vrcholů na GPU
+enum class VertexFormat : uint32_t {
+    Float = 0,     // struct vertex - 32 B, vše float
+    Quantized = 1  // struct packed_vertex - 16 B, pro statickou geometrii
+};
+
+// Kompaktní vrchol (16 B):
+//  - pozice jako unorm16 relativně k obalovému kvádru meshe (dekóduje shader přes uPosOffset/uPosScale)
+//  - normála oktaedricky zakódovaná do 2x snorm16
+//  - texturové koordináty jako half float
+struct packed_vertex {
+    uint16_t position[4]; // x, y, z, padding (zarovnání na 4 B)
+    int16_t normal[2];
+    uint16_t texCoord[2];
+};
+static_assert(sizeof(packed_vertex) == 16, "packed_vertex must be 16 bytes");
+
+// Velikost jednoho vrcholu v bajtech
+inline size_t vertexStride(VertexFormat format) {
+    return format == VertexFormat::Quantized ? sizeof(packed_vertex) : sizeof(vertex);
+}
+
+// Oktaedrické zakódování jednotkové normály do [-1,1]^2 (dekódování viz octDecode v shaderech)
+inline glm::vec2 octEncode(glm::vec3 n) {
+    n /= (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+    glm::vec2 e(n.x, n.y);
+    if (n.z < 0.0f) {
+        e = (1.0f - glm::abs(glm::vec2(n.y, n.x))) *
+            glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return e;
+}
+
+// Převod vrcholů do kompaktního formátu; pozice se kvantují do obalového kvádru bounds_min..bounds_max
+inline std::vector<packed_vertex> packVertices(const std::vector<vertex>& vertices,
+    const glm::vec3& bounds_min, const glm::vec3& bounds_max) {
+    glm::vec3 extent = bounds_max - bounds_min;
+    glm::vec3 inv_extent(
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+    std::vector<packed_vertex> result(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const vertex& v = vertices[i];
+        packed_vertex& p = result[i];
+
+        glm::vec3 t = (v.position - bounds_min) * inv_extent;
+        p.position[0] = glm::packUnorm1x16(t.x);
+        p.position[1] = glm::packUnorm1x16(t.y);
+        p.position[2] = glm::packUnorm1x16(t.z);
+        p.position[3] = 0;
+
+        float length = glm::length(v.normal);
+        glm::vec2 n = octEncode(length > 0.0f ? v.normal / length : glm::vec3(0.0f, 0.0f, 1.0f));
+        p.normal[0] = static_cast<int16_t>(glm::packSnorm1x16(n.x));
+        p.normal[1] = static_cast<int16_t>(glm::packSnorm1x16(n.y));
+
+        p.texCoord[0] = glm::packHalf1x16(v.texCoord.x);
+        p.texCoord[1] = glm::packHalf1x16(v.texCoord.y);
+    }
+    return result;
+}
@@ -1,5 +1,6 @@
 ﻿#include <iostream>
 #include <string>
+#include <fstream>
 #include <cmath>
 #include <random>
 #include <algorithm>
@@ -59,9 +60,13 @@ App::App() :
 }
 
 App::~App() {
+    // Zastavení načítání (pracovní vlákna nesmí přežít GL kontext)
+    AssetLoader::getInstance()->shutdown();
+
     // Úklid
     shader.clear();
-    lightingShader.clear();
+    lightingShader = ShaderProgram(); // kopie základní varianty - program smaže lightingVariants
+    lightingVariants.clear();
 
     if (triangle) {
         delete triangle;
@@ -80,6 +85,18 @@ App::~App() {
     }
     maze_walls.clear();
 
+    for (auto& batch : maze_batches) {
+        delete batch;
+    }
+    maze_batches.clear();
+    sceneBVH.clear();
+    mazePVS.clear();
+
+    if (mazeCuller) {
+        delete mazeCuller;
+        mazeCuller = nullptr;
+    }
+
     // Uvolnìní transparentních králíkù
     for (auto& bunny : transparent_bunnies) {
         delete bunny;
@@ -126,11 +143,11 @@ bool App::init(GLFWwindow* win) {
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     // Povolení Z-bufferu pro správné vykreslování 3D modelů
-    glEnable(GL_DEPTH_TEST);
+    GLState::getInstance()->setDepthTest(true);
 
     // Nastavení pro průhlednost
     glDepthFunc(GL_LEQUAL);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::getInstance()->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Získání velikosti framebufferu
     glfwGetFramebufferSize(window, &width, &height);
@@ -148,6 +165,9 @@ bool App::init(GLFWwindow* win) {
     // Načtení assets
     init_assets();
 
+    // Sdílené uniform bloky (kamera, světla, materiál) - vyžadují GL kontext
+    SceneUniforms::getInstance();
+
     // První aktualizace projekční matice
     update_projection_matrix();
 
@@ -155,18 +175,7 @@ bool App::init(GLFWwindow* win) {
     initLighting();
 
     // Explicitní nastavení view matice
-    if (shader.getID() != 0) {
-        shader.activate();
-        shader.setUniform("uV_m", camera.GetViewMatrix());
-    }
-
-    if (lightingShader.getID() != 0) {
-        lightingShader.activate();
-        lightingShader.setUniform("uV_m", camera.GetViewMatrix());
-        lightingShader.setUniform("viewPos", camera.Position);
-    }
-
-    createFountain();
+    SceneUniforms::getInstance()->setView(camera.GetViewMatrix(), camera.Position);
 
     if (!textRenderer.init(width, height)) {
         std::cerr << "Chyba při inicializaci text rendereru" << std::endl;
@@ -179,19 +188,108 @@ bool App::init(GLFWwindow* win) {
 void App::init_assets() {
     // Naètení shaderù
     try {
+        // Všechny programy se odešlou najednou a překládají se paralelně s načítáním assetů,
+        // do dokončení se objekty s daným programem nevykreslují
         std::cout << "Loading shaders..." << std::endl;
-        shader = ShaderProgram("resources/shaders/tex.vert", "resources/shaders/tex.frag");
-
-        // Naètení shaderù pro osvìtlení
-        lightingShader = ShaderProgram("resources/shaders/directional.vert", "resources/shaders/directional.frag");
-
-        std::cout << "Shaders loaded successfully" << std::endl;
+        shader = ShaderProgram::build("resources/shaders/tex.vert", "resources/shaders/tex.frag");
+
+        // Naètení shaderù pro osvìtlení - všechny používané varianty (průhlednost, instancování,
+        // čelovka), aby přepnutí čelovky nečekalo na překlad
+        lightingVariants = ShaderPermutations("resources/shaders/directional.vert", "resources/shaders/directional.frag",
+            { "SPOT_LIGHT", "TRANSPARENT", "INSTANCED" });
+        lightingShader = lightingVariants.get(0);
+        lightingVariants.prebuild({ LIGHTING_SPOT_LIGHT,
+            LIGHTING_INSTANCED, LIGHTING_INSTANCED | LIGHTING_SPOT_LIGHT,
+            LIGHTING_TRANSPARENT, LIGHTING_TRANSPARENT | LIGHTING_SPOT_LIGHT });
+
+        std::cout << "Shaders submitted" << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "Shader loading error: " << e.what() << std::endl;
         throw;
     }
 
+    // Meshe a textury se načítají asynchronně, scéna se sestaví ve finishLoading()
+    requestAssets();
+}
+
+void App::requestAssets() {
+    AssetLoader* loader = AssetLoader::getInstance();
+    loadingStart = glfwGetTime();
+    loading = true;
+
+    // Statická geometrie bludiště - kompaktní (kvantizovaný) formát vrcholů
+    MeshImportOptions staticImport;
+    staticImport.quantize = true;
+    cubeMesh = loader->loadMesh("resources/models/cube.obj", staticImport);
+    particleMesh = loader->loadMesh("resources/models/cube.obj");
+
+    // Králík je hustý mesh - optimalizace pořadí indexů pro vertex cache a overdraw, 4 úrovně detailu
+    MeshImportOptions bunnyImport;
+    bunnyImport.optimize = true;
+    bunnyImport.lod_levels = 4;
+    bunnyImport.quantize = true;
+    bunnyMesh = loader->loadMesh("resources/models/bunny_tri_vnt.obj", bunnyImport);
+
+    MeshImportOptions sunImport;
+    sunImport.quantize = true;
+    sunMesh = loader->loadMesh("resources/models/sphere.obj", sunImport);
+
+    // Textury ze souborů jednou dávkou (dekódování + mipmapy paralelně na pracovních vláknech).
+    // Textura králíka je neprůhledná fotografie - BC1 (8:1), zkomprimovaná data se ukládají do cache/textures
+    // a streamuje se (nejdřív mip tail, plné rozlišení až podle velikosti králíků na obrazovce)
+    TextureOptions bunnyTextureOptions;
+    bunnyTextureOptions.compression = TextureCompression::BC1;
+    bunnyTextureOptions.streaming = true;
+    auto textures = loader->loadTextures({
+        { "resources/textures/kralik.jpg", bunnyTextureOptions },
+        });
+    bunnyTexture = textures[0];
+
+    // Textury bludiště z atlasu 16x16 - výřez dlaždic v paměti (na pracovním vlákně) do vrstev pole textur,
+    // každá vrstva má vlastní mipmapy (Kaiser filtr na CPU), takže se sousední dlaždice atlasu nepromíchají
+    TextureOptions mazeTextureOptions;
+    mazeTextureOptions.mip_filter = MipFilter::Kaiser;
+    mazeTextures = loader->submit<std::vector<TextureImportData>, std::shared_ptr<Texture>>("tex_256.png",
+        [mazeTextureOptions](std::vector<TextureImportData>& layers) {
+            cv::Mat atlas = cv::imread("resources/textures/tex_256.png", cv::IMREAD_UNCHANGED);
+            if (atlas.empty()) {
+                throw std::runtime_error("Nelze načíst atlas textur!");
+            }
+
+            const int texCount = 16; // Počet textur v každém směru
+            const int tileSize = atlas.cols / texCount; // Velikost jedné textury v pixelech
+
+            // Pořadí odpovídá MAZE_LAYER_FLOOR, MAZE_LAYER_WALL
+            const cv::Point tiles[] = { cv::Point(1, 1), cv::Point(2, 3) }; // (sloupec, řádek) v atlasu
+            layers.resize(std::size(tiles));
+            for (size_t i = 0; i < layers.size(); i++) {
+                cv::Mat tile = atlas(cv::Rect(tiles[i].x * tileSize, tiles[i].y * tileSize, tileSize, tileSize)).clone();
+                ResourceManager::prepareTextureData(tile, mazeTextureOptions, layers[i], "tex_256.png#maze");
+            }
+        },
+        [mazeTextureOptions](std::vector<TextureImportData>& layers) {
+            return ResourceManager::getInstance()->addTextureArray("resources/textures/tex_256.png#maze",
+                mazeTextureOptions, layers);
+        });
+
+    // Textura slunce (žlutá) - vytvoří se v paměti, bez zápisu na disk
+    sunTexture = loader->submit<TextureImportData, std::shared_ptr<Texture>>("sun",
+        [](TextureImportData& data) {
+            cv::Mat image(64, 64, CV_8UC3, cv::Scalar(255, 255, 0)); // Žlutá barva
+            ResourceManager::prepareTextureData(image, TextureOptions(), data, "sun");
+        },
+        [](TextureImportData& data) {
+            return ResourceManager::getInstance()->addTexture("generated/sun", TextureOptions(), data);
+        });
+
+    std::cout << "Requested " << loader->totalCount() << " assets ("
+        << loader->workerCount() << " worker threads)" << std::endl;
+}
+
+void App::finishLoading() {
+    loading = false;
+
     // Vytvoøení bludištì
     try {
         std::cout << "Creating maze..." << std::endl;
@@ -224,52 +322,70 @@ void App::init_assets() {
         std::cerr << "Sun model creation error: " << e.what() << std::endl;
         throw;
     }
+
+    createFountain();
+
+    // Ořezání na CPU - jednotlivě kreslené modely (zdi bludiště jen bez GPU ořezání, viz buildMazeBatches)
+    for (auto* bunny : transparent_bunnies) {
+        sceneBVH.insert(bunny);
+    }
+    if (sunModel) {
+        sceneBVH.insert(sunModel);
+    }
+
+    std::cout << "Assets loaded in " << (glfwGetTime() - loadingStart) * 1000.0 << " ms" << std::endl;
+    ResourceManager::getInstance()->printStats();
+    ResourceManager::getInstance()->printTextureReport();
+    TextureStreamer::getInstance()->printStats();
+    ShaderCache::printStats();
+    GeometryPool::getInstance()->printStats();
+}
+
+void App::renderLoadingScreen() {
+    AssetLoader* loader = AssetLoader::getInstance();
+
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Textový ukazatel průběhu: [##########..........] 50%
+    const int barLength = 20;
+    float progress = loader->progress();
+    int filled = static_cast<int>(progress * barLength);
+    std::string bar = "[" + std::string(filled, '#') + std::string(barLength - filled, '.') + "] " +
+        std::to_string(static_cast<int>(progress * 100.0f)) + "%";
+    std::string status = std::to_string(loader->completedCount()) + " / " +
+        std::to_string(loader->totalCount()) + " assets";
+
+    float x = width / 2.0f - 200.0f;
+    float y = height / 2.0f;
+    textRenderer.renderText("Loading...", x, y + 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
+    textRenderer.renderText(bar, x, y, 0.8f, glm::vec3(0.3f, 1.0f, 0.3f));
+    textRenderer.renderText(status, x, y - 40.0f, 0.5f, glm::vec3(0.7f, 0.7f, 0.7f));
 }
 
 // Nová metoda pro inicializaci osvìtlení
 void App::initLighting() {
-    // Nastavení light uniforms pro osvìtlení
-    lightingShader.activate();
+    SceneUniforms* scene = SceneUniforms::getInstance();
 
     // Nastavení smìrového svìtla
-    lightingShader.setUniform("lightDir", dirLight.direction);
-    lightingShader.setUniform("lightAmbient", dirLight.ambient);
-    lightingShader.setUniform("lightDiffuse", dirLight.diffuse);
-    lightingShader.setUniform("lightSpecular", dirLight.specular);
+    setupLightingUniforms();
 
     // Výchozí materiál
-    lightingShader.setUniform("ambientMaterial", glm::vec3(0.2f, 0.2f, 0.2f));
-    lightingShader.setUniform("diffuseMaterial", glm::vec3(1.0f, 1.0f, 1.0f));
-    lightingShader.setUniform("specularMaterial", glm::vec3(1.0f, 1.0f, 1.0f));
-    lightingShader.setUniform("shininess", 32.0f);
-
-    // Deaktivace shaderu
-    lightingShader.deactivate();
+    scene->setMaterial(glm::vec3(0.2f, 0.2f, 0.2f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f), 32.0f);
 
     // Nastavení uniforms pro spotlight
-    lightingShader.setUniform("spotLightEnabled", spotLightEnabled);
-    spotLight.SetUniforms(lightingShader);
+    scene->setSpotLight(spotLight);
 }
 
 
 void App::setupLightingUniforms() {
-    lightingShader.activate();
-
-    // Nastavení smìrového svìtla
-    lightingShader.setUniform("lightDir", dirLight.direction);
-    lightingShader.setUniform("lightAmbient", dirLight.ambient);
-    lightingShader.setUniform("lightDiffuse", dirLight.diffuse);
-    lightingShader.setUniform("lightSpecular", dirLight.specular);
-
-    // Nastavení pozice kamery pro spekulární výpoèty (v world space)
-    lightingShader.setUniform("viewPos", camera.Position);
-
-    lightingShader.deactivate();
+    // Směrové světlo do sdíleného uniform bloku (pozice kamery je v bloku kamery)
+    SceneUniforms::getInstance()->setDirectionalLight(dirLight.direction, dirLight.ambient, dirLight.diffuse, dirLight.specular);
 }
 
 void App::createTransparentBunnies() {
-    // Naètení textury pro králíky
-    GLuint bunnyTexture = textureInit("resources/textures/kralik.jpg");
+    // Textura a geometrie králíka (načtené v AssetLoaderu)
+    std::shared_ptr<MeshGeometry> bunnyGeometry = bunnyMesh.get();
 
     // Pozice pro králíky v bludišti
     std::vector<glm::vec3> bunny_positions = {
@@ -288,10 +404,10 @@ void App::createTransparentBunnies() {
     // Vytvoøení tøí transparentních králíkù
     for (int i = 0; i < 3; i++) {
         // Vytvoøení modelu králíka - nyní použijeme lightingShader
-        Model* bunny = new Model("resources/models/bunny_tri_vnt.obj", lightingShader);
+        Model* bunny = new Model("bunny_tri_vnt", lightingShader, bunnyGeometry);
 
         // Nastavení textury a barvy s prùhledností
-        bunny->meshes[0].texture_id = bunnyTexture;
+        bunny->meshes[0].texture = bunnyTexture.get();
         bunny->meshes[0].diffuse_material = bunny_colors[i];
 
         // Nastavení pozice a velikosti
@@ -309,19 +425,10 @@ void App::createTransparentBunnies() {
 // Metoda pro vytvoøení modelu slunce
 void App::createSunModel() {
     // Vytvoøení modelu slunce (koule) - použijeme pùvodní shader bez osvìtlení, aby slunce vždy svítilo
-    sunModel = new Model("resources/models/sphere.obj", shader);
-
-    // Vytvoøení textury slunce (žlutá koule)
-    cv::Mat sunTexture(64, 64, CV_8UC3, cv::Scalar(255, 255, 0)); // Žlutá barva
+    sunModel = new Model("sphere", shader, sunMesh.get());
 
-    // Uložení textury
-    cv::imwrite("resources/textures/sun.png", sunTexture);
-
-    // Naètení textury pro slunce
-    GLuint sunTextureID = textureInit("resources/textures/sun.png");
-
-    // Nastavení textury a materiálu
-    sunModel->meshes[0].texture_id = sunTextureID;
+    // Nastavení textury (žlutá, vytvořená v requestAssets) a materiálu
+    sunModel->meshes[0].texture = sunTexture.get();
     sunModel->meshes[0].diffuse_material = glm::vec4(1.0f, 1.0f, 0, 1.0f); // Žlutá barva
 
     // Nastavení velikosti
@@ -364,53 +471,14 @@ void App::updateLighting(float deltaTime) {
     spotLight.SetDirection(camera.Front);
 
     // Nastavení uniforms pro spotlight
-    lightingShader.setUniform("spotLightEnabled", spotLightEnabled);
-    spotLight.SetUniforms(lightingShader);
+    SceneUniforms::getInstance()->setSpotLight(spotLight);
 }
 
-GLuint App::textureInit(const std::filesystem::path& filepath) {
+std::shared_ptr<Texture> App::textureInit(const std::filesystem::path& filepath) {
     std::cout << "Naèítám texturu: " << filepath << std::endl;  // Debug výpis
-    // Použij std::filesystem::path správnì
-    std::string pathString = filepath.string();
-    cv::Mat image = cv::imread(pathString, cv::IMREAD_UNCHANGED);
-    if (image.empty()) {
-        throw std::runtime_error("Nelze naèíst texturu ze souboru: " + pathString);
-    }
-    return gen_tex(image);
-}
 
-GLuint App::gen_tex(cv::Mat& image) {
-    GLuint ID = 0;
-
-    // Generování ID OpenGL textury
-    glCreateTextures(GL_TEXTURE_2D, 1, &ID);
-
-    // Nastavení podle poètu kanálù v obrázku
-    switch (image.channels()) {
-    case 3:
-        // Vytvoøení a inicializace datového prostoru pro texturu - immutable formát
-        glTextureStorage2D(ID, 1, GL_RGB8, image.cols, image.rows);
-        // Nahrání dat do textury
-        glTextureSubImage2D(ID, 0, 0, 0, image.cols, image.rows, GL_BGR, GL_UNSIGNED_BYTE, image.data);
-        break;
-    case 4:
-        glTextureStorage2D(ID, 1, GL_RGBA8, image.cols, image.rows);
-        glTextureSubImage2D(ID, 0, 0, 0, image.cols, image.rows, GL_BGRA, GL_UNSIGNED_BYTE, image.data);
-        break;
-    default:
-        throw std::runtime_error("Nepodporovaný poèet kanálù v textuøe: " + std::to_string(image.channels()));
-    }
-
-    // Nastavení filtrování textury
-    glTextureParameteri(ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // bilineární zvìtšování
-    glTextureParameteri(ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // trilineární zmenšování
-    glGenerateTextureMipmap(ID);  // Generování mipmap
-
-    // Nastavení opakování textury
-    glTextureParameteri(ID, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTextureParameteri(ID, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    return ID;
+    // Každý soubor se dekóduje a nahraje jen jednou, opakované požadavky dostanou stejnou texturu
+    return ResourceManager::getInstance()->getTexture(filepath);
 }
 
 uchar App::getmap(cv::Mat& map, int x, int y) {
@@ -490,34 +558,9 @@ void App::genLabyrinth(cv::Mat& map) {
 }
 
 void App::createMazeModel() {
-    // Naètení atlasu textur
-    cv::Mat atlas = cv::imread("resources/textures/tex_256.png", cv::IMREAD_UNCHANGED);
-    if (atlas.empty()) {
-        throw std::runtime_error("Nelze naèíst atlas textur!");
-    }
-
-    // Atlas je 16x16 textur
-    const int texCount = 16; // Poèet textur v každém smìru
-    const int tileSize = atlas.cols / texCount; // Velikost jedné textury v pixelech
-
-    // Uložení textur
-    auto saveTextureFromAtlas = [&](int row, int col, const std::string& filename) {
-        int x = col * tileSize;
-        int y = row * tileSize;
-        cv::Mat tileMat = atlas(cv::Rect(x, y, tileSize, tileSize));
-        cv::imwrite("resources/textures/" + filename, tileMat);
-        };
-
-    // Uložení textur
-    saveTextureFromAtlas(1, 1, "floor.png"); // Podlaha
-    saveTextureFromAtlas(3, 2, "wall.png");  // Zdi
-
-    // Naètení textur
-    wall_textures.clear();
-    GLuint floorTexture = textureInit("resources/textures/floor.png");
-    GLuint wallTexture = textureInit("resources/textures/wall.png");
-    wall_textures.push_back(floorTexture);
-    wall_textures.push_back(wallTexture);
+    // Pole textur podlahy a zdí z atlasu (načtené v AssetLoaderu)
+    mazeTextureArray = mazeTextures.get();
+    std::shared_ptr<MeshGeometry> cubeGeometry = cubeMesh.get();
 
     // Vytvoøení bludištì
     maze_map = cv::Mat(15, 15, CV_8U);
@@ -527,8 +570,9 @@ void App::createMazeModel() {
     for (int j = 0; j < 15; j++) {
         for (int i = 0; i < 15; i++) {
             // Použití lightingShader místo pùvodního shader
-            Model* floor = new Model("resources/models/cube.obj", lightingShader);
-            floor->meshes[0].texture_id = floorTexture;
+            Model* floor = new Model("cube", lightingShader, cubeGeometry);
+            floor->meshes[0].texture = mazeTextureArray;
+            floor->meshes[0].texture_layer = MAZE_LAYER_FLOOR;
             floor->origin = glm::vec3(i, 0.0f, j); // Spodní vrstva
             floor->scale = glm::vec3(1.0f, 1.0f, 1.0f);
             maze_walls.push_back(floor);
@@ -540,14 +584,89 @@ void App::createMazeModel() {
         for (int i = 0; i < 15; i++) {
             if (getmap(maze_map, i, j) == '#') { // Pokud je tam zeï
                 // Použití lightingShader místo pùvodního shader
-                Model* wall = new Model("resources/models/cube.obj", lightingShader);
-                wall->meshes[0].texture_id = wallTexture;
+                Model* wall = new Model("cube", lightingShader, cubeGeometry);
+                wall->meshes[0].texture = mazeTextureArray;
+                wall->meshes[0].texture_layer = MAZE_LAYER_WALL;
                 wall->origin = glm::vec3(i, 1.0f, j); // Umístìní nad podlahu
                 wall->scale = glm::vec3(1.0f, 1.0f, 1.0f);
                 maze_walls.push_back(wall);
             }
         }
     }
+
+    // Viditelnost mezi buňkami - mřížka se po vygenerování nemění
+    std::vector<uint8_t> walls(maze_map.rows * maze_map.cols, 0);
+    for (int j = 0; j < maze_map.rows; j++) {
+        for (int i = 0; i < maze_map.cols; i++) {
+            walls[j * maze_map.cols + i] = getmap(maze_map, i, j) == '#';
+        }
+    }
+    mazePVS.build(maze_map.cols, maze_map.rows, walls);
+    pvsCell = MazePVS::NO_CELL;
+
+    buildMazeBatches();
+}
+
+// Zdi a podlaha do ořezání na GPU (jeden multi-draw indirect), co GpuCuller nepřijme nebo bez
+// compute shaderů se ořezává na CPU (SceneBVH) a viditelné se každý snímek seskupí podle meshe
+// a textury do instancovaných skupin
+// (podlaha a zdi sdílí pole textur, vrstva je v datech instance - celé bludiště je jedna skupina)
+void App::buildMazeBatches() {
+    for (auto& batch : maze_batches) {
+        delete batch;
+    }
+    maze_batches.clear();
+    if (mazeCuller) {
+        delete mazeCuller;
+        mazeCuller = nullptr;
+    }
+    if (GpuCuller::supported()) {
+        mazeCuller = new GpuCuller();
+    }
+
+    for (auto& wall : maze_walls) {
+        int cell = mazePVS.cellAt(wall->origin.x, wall->origin.z);
+        if (mazeCuller && mazeCuller->add(wall, wall->meshes[0].texture_layer,
+            cell != MazePVS::NO_CELL ? static_cast<GLuint>(cell) : GpuCuller::NO_CELL)) {
+            continue;
+        }
+        InstanceBatch* target = nullptr;
+        for (auto& batch : maze_batches) {
+            if (batch->matches(wall)) {
+                target = batch;
+                break;
+            }
+        }
+        if (!target) {
+            maze_batches.push_back(new InstanceBatch(wall));
+        }
+        sceneBVH.insert(wall);
+    }
+
+    if (mazeCuller) {
+        mazeCuller->build();
+    }
+    std::cout << "Maze batches: " << maze_batches.size() << " draw calls for "
+        << maze_walls.size() - (mazeCuller ? mazeCuller->objectCount() : 0) << " objects" << std::endl;
+}
+
+// Výběr buňky PVS podle kamery. Nad horní hranou zdí nebo ve zdi (volný let) je vidět přes zdi -
+// PVS se vypne. Množina viditelných buněk se na GPU nahrává jen při přechodu do jiné buňky.
+void App::updatePVSCell() {
+    int cell = MazePVS::NO_CELL;
+    if (!mazePVS.empty() && camera.Position.y < MAZE_WALL_TOP) {
+        cell = mazePVS.cellAt(camera.Position.x, camera.Position.z);
+        if (mazePVS.isWall(cell)) {
+            cell = MazePVS::NO_CELL;
+        }
+    }
+    if (cell == pvsCell) {
+        return;
+    }
+    pvsCell = cell;
+    if (mazeCuller) {
+        mazeCuller->setVisibleCells(cell != MazePVS::NO_CELL ? &mazePVS.visibleFrom(cell) : nullptr);
+    }
 }
 
 // Implementace metody pro přepínání mezi celoobrazovkovým a okenním režimem
@@ -684,8 +803,7 @@ bool App::run() {
 
     // Inicializace projekèní a pohledové matice
     update_projection_matrix();
-    lightingShader.setUniform("uV_m", camera.GetViewMatrix());
-    lightingShader.setUniform("viewPos", camera.Position);
+    SceneUniforms::getInstance()->setView(camera.GetViewMatrix(), camera.Position);
 
     // Promìnné pro mìøení FPS a deltaTime
     double lastTime = glfwGetTime();
@@ -708,7 +826,14 @@ bool App::run() {
 
             // Aktualizace titulku okna (pro okenní režim)
             if (!isFullscreen) {
-                std::string fpsTitle = title + " | FPS: " + std::to_string(frameCount);
+                // Úspora GLState v posledním snímku - vydaná / všechna volání změny stavu
+                const GLStateStats& stateStats = GLState::getInstance()->frameStats();
+                const CullStats& cullStats = sceneBVH.stats();
+                std::string fpsTitle = title + " | FPS: " + std::to_string(frameCount) +
+                    " | GL state calls: " + std::to_string(stateStats.issued) + " / " +
+                    std::to_string(stateStats.issued + stateStats.skipped) +
+                    " | CPU culled: " + std::to_string(cullStats.culled) + " / " +
+                    std::to_string(cullStats.visible + cullStats.culled);
                 glfwSetWindowTitle(window, fpsTitle.c_str());
             }
 
@@ -716,6 +841,26 @@ bool App::run() {
             lastTime = currentTime;
         }
 
+        // Chyba asynchronního překladu shaderů se projeví až zde
+        if (shader.failed() || lightingVariants.failed()) {
+            throw std::runtime_error("Shader program build failed");
+        }
+
+        // Načítání assetů - nahrávání na GPU s časovým limitem, mezitím obrazovka s průběhem
+        if (loading) {
+            AssetLoader::getInstance()->update(LOADING_UPLOAD_BUDGET_MS);
+            if (AssetLoader::getInstance()->idle()) {
+                finishLoading();
+            }
+            else {
+                renderLoadingScreen();
+                GLState::getInstance()->endFrame();
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+                continue;
+            }
+        }
+
         // Zpracování vstupu z klávesnice pro pohyb kamery
         glm::vec3 direction = camera.ProcessKeyboard(window, deltaTime);
 
@@ -743,93 +888,94 @@ bool App::run() {
         }
 
         // Aktualizace pohledové matice a pozice kamery
-        lightingShader.activate();
-        lightingShader.setUniform("uV_m", camera.GetViewMatrix());
-        lightingShader.setUniform("viewPos", camera.Position);
+        SceneUniforms::getInstance()->setView(camera.GetViewMatrix(), camera.Position);
 
         // Aktualizace osvìtlení
         updateLighting(deltaTime);
 
+        // Nahrání kamery, světel a materiálu pro všechny programy (jeden zápis za snímek)
+        SceneUniforms::getInstance()->upload();
+
+        // Buňka kamery vybírá předpočítanou množinu viditelných buněk bludiště
+        updatePVSCell();
+
+        // Ořezání bludiště pohledovým jehlanem na GPU (čte kameru ze SceneUniforms)
+        if (mazeCuller) {
+            mazeCuller->cull();
+        }
+
+        // Ořezání ostatních modelů na CPU (posunuté modely, např. slunce, upraví strom)
+        sceneBVH.update();
+        sceneBVH.cull(Frustum(projection_matrix * camera.GetViewMatrix()), visibleModels);
+        if (pvsCell != MazePVS::NO_CELL) {
+            // Modely celé za zdmi, které z buňky kamery nejsou vidět
+            visibleModels.erase(std::remove_if(visibleModels.begin(), visibleModels.end(), [this](Model* model) {
+                glm::vec3 bounds_min, bounds_max;
+                model->getWorldBounds(bounds_min, bounds_max);
+                return !mazePVS.isBoxVisible(pvsCell, bounds_min, bounds_max, MAZE_WALL_TOP);
+                }), visibleModels.end());
+        }
+
+        // Varianta osvětlovacího programu podle stavu scény (čelovka) - bez dynamického větvení ve shaderu
+        uint32_t sceneFeatures = spotLightEnabled ? LIGHTING_SPOT_LIGHT : 0;
+
         // Vyèištìní obrazovky
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Implementace Painter's algoritmu pro transparentní objekty
-        std::vector<Model*> transparent_objects;
-
-        // 1. NEJPRVE VYKRESLÍME VŠECHNY NEPRÙHLEDNÉ OBJEKTY
-        // Vykreslení bludištì (neprùhledné objekty)
-        for (auto& wall : maze_walls) {
-            // Nastavení model matice v shaderu
-            lightingShader.setUniform("uM_m", wall->getModelMatrix());
-            lightingShader.setUniform("transparent", false);
-            // Vykreslení modelu
-            wall->draw();
-        }
+        // Fronta vykreslení - objekty se zařadí s řadicím klíčem (průchod, program, textura, mesh, hloubka)
+        // a vykreslí seřazené: neprůhledné zepředu dozadu, průhledné zezadu dopředu
+        renderQueue.begin(camera.Position, FAR_PLANE);
 
-        // 2. PØIPRAVÍME SI SEZNAM TRANSPARENTNÍCH OBJEKTÙ
-        // Pøidání transparentních králíkù do seznamu
-        for (auto& bunny : transparent_bunnies) {
-            transparent_objects.push_back(bunny);
+        // 1. NEPRÙHLEDNÉ OBJEKTY
+        // Bludištì - viditelné instance z GPU ořezání (matice v SSBO), zbytek instancovaně
+        const ShaderProgram& instancedShader = lightingVariants.get(sceneFeatures | LIGHTING_INSTANCED);
+        renderQueue.submit(RenderPass::Opaque, instancedShader, mazeCuller);
+        for (auto& batch : maze_batches) {
+            batch->clear();
         }
 
-        // 3. SEØADÍME TRANSPARENTNÍ OBJEKTY OD NEJVZDÁLENÌJŠÍHO K NEJBLIŽŠÍMU
-        std::sort(transparent_objects.begin(), transparent_objects.end(),
-            [this](Model* a, Model* b) {
-                // Získání pozice objektù
-                glm::vec3 pos_a = a->origin;
-                glm::vec3 pos_b = b->origin;
-
-                // Výpoèet vzdálenosti od kamery
-                float dist_a = glm::distance(camera.Position, pos_a);
-                float dist_b = glm::distance(camera.Position, pos_b);
-
-                // Øazení od nejvzdálenìjšího k nejbližšímu (vìtší > menší)
-                return dist_a > dist_b;
-            });
-
-        // 4. NASTAVENÍ OPENGL PRO TRANSPARENTNÍ OBJEKTY
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glDepthMask(GL_FALSE); // Zakázat zápis do depth bufferu
-
-        // 5. VYKRESLENÍ TRANSPARENTNÍCH OBJEKTÙ
-        for (auto* model : transparent_objects) {
-            // Nastavení model matice v shaderu
-            lightingShader.setUniform("uM_m", model->getModelMatrix());
-            // Nastavení diffuse materiálu (vèetnì alpha)
-            lightingShader.setUniform("u_diffuse_color", model->meshes[0].diffuse_material);
-            lightingShader.setUniform("transparent", true);
-            // Vykreslení modelu
-            model->draw();
+        // Jen modely, které prošly ořezáním (SceneBVH)
+        const ShaderProgram& transparentShader = lightingVariants.get(sceneFeatures | LIGHTING_TRANSPARENT);
+        for (auto* model : visibleModels) {
+            if (model == sunModel) {
+                // Slunce (používáme pùvodní shader, aby bylo jasnì viditelné)
+                renderQueue.submit(RenderPass::Opaque, shader, sunModel, sunModel->getModelMatrix(),
+                    glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)); // Jasnì žlutá barva
+            }
+            else if (model->transparent) {
+                // 2. PRŮHLEDNÉ OBJEKTY - králíci
+                // Úroveň detailu a rozlišení textury podle velikosti na obrazovce
+                model->selectLod(projection_matrix, camera.Position, static_cast<float>(height), deltaTime);
+                model->requestTextureDetail(projection_matrix, camera.Position, static_cast<float>(height));
+                renderQueue.submit(RenderPass::Transparent, transparentShader, model, model->getModelMatrix(),
+                    model->meshes[0].diffuse_material);
+            }
+            else {
+                // Zeď nebo podlaha mimo GPU ořezání - do instancované skupiny
+                for (auto& batch : maze_batches) {
+                    if (batch->matches(model)) {
+                        batch->add(model->getModelMatrix(), model->meshes[0].texture_layer);
+                        break;
+                    }
+                }
+            }
         }
-
-        // 6. OBNOVENÍ PÙVODNÍHO STAVU OPENGL
-        glDepthMask(GL_TRUE);  // Povolit zápis do depth bufferu
-        glDisable(GL_BLEND);   // Vypnout blending
-
-        // 7. VYKRESLENÍ SLUNCE (používáme pùvodní shader, aby bylo jasnì viditelné)
-        if (sunModel) {
-            shader.activate();
-            shader.setUniform("uP_m", projection_matrix);
-            shader.setUniform("uV_m", camera.GetViewMatrix());
-            shader.setUniform("uM_m", sunModel->getModelMatrix());
-            shader.setUniform("u_diffuse_color", glm::vec4(1.0f, 1.0f, 0.0f, 1.0f)); // Jasnì žlutá barva
-            sunModel->draw();
+        for (auto& batch : maze_batches) {
+            renderQueue.submit(RenderPass::Opaque, instancedShader, batch);
         }
 
-        // 8. AKTUALIZACE A VYKRESLENÍ FONTÁNY
+        // Fontána - částice jsou průhledné a řadí se spolu s králíky
         if (fountain) {
             fountain->Update(deltaTime);
+            fountain->Submit(renderQueue);
+        }
 
-            // Nastavení shader pro fontánu
-            shader.activate();
-            shader.setUniform("uP_m", projection_matrix);
-            shader.setUniform("uV_m", camera.GetViewMatrix());
+        // 3. SEŘAZENÍ A VYKRESLENÍ (blending a zápis hloubky nastaví fronta podle průchodu)
+        renderQueue.execute();
 
-            // Vykreslení fontány
-            fountain->Draw();
-        }
+        // Streamování textur podle požadavků z tohoto snímku
+        TextureStreamer::getInstance()->update(currentTime, deltaTime, TEXTURE_STREAMING_BUDGET_MS);
 
         // Vykreslení menu, pokud je aktivní
         renderMenu();
@@ -838,6 +984,7 @@ bool App::run() {
         renderFPS(currentFPS);
 
         // Výmìna bufferù a zpracování událostí
+        GLState::getInstance()->endFrame();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -860,19 +1007,11 @@ void App::update_projection_matrix() {
         glm::radians(fov),   // Vertikální zorné pole ve stupních, pøevedeno na radiány
         ratio,               // Pomìr stran okna
         0.1f,                // Near clipping plane
-        20000.0f             // Far clipping plane
+        FAR_PLANE            // Far clipping plane
     );
 
-    // Nastavení uniform v shaderech
-    if (shader.getID() != 0) {
-        shader.activate();
-        shader.setUniform("uP_m", projection_matrix);
-    }
-
-    if (lightingShader.getID() != 0) {
-        lightingShader.activate();
-        lightingShader.setUniform("uP_m", projection_matrix);
-    }
+    // Nastavení projekce ve sdíleném bloku kamery
+    SceneUniforms::getInstance()->setProjection(projection_matrix);
 }
 
 void App::fbsize_callback(GLFWwindow* window, int width, int height) {
@@ -940,6 +1079,11 @@ void App::key_callback(GLFWwindow* window, int key, int scancode, int action, in
                 // Přepínání VSync klávesou V
                 app->toggleVsync();
                 break;
+            case GLFW_KEY_G:
+                // Defragmentace sdílených bufferů geometrie a výpis jejich obsazenosti klávesou G
+                GeometryPool::getInstance()->defragment();
+                GeometryPool::getInstance()->printStats();
+                break;
             }
         }
     }
@@ -981,7 +1125,7 @@ void App::mouse_button_callback(GLFWwindow* window, int button, int action, int
 
 void App::createFountain() {
     // Vytvoření modelu pro částice (použijeme jednoduchou kostku)
-    particleModel = new Model("resources/models/cube.obj", shader);
+    particleModel = new Model("cube", shader, particleMesh.get());
 
     // Umístění fontány do středu bludiště
     glm::vec3 fountainPosition = glm::vec3(7.5f, 0.1f, 7.5f);
@@ -1096,8 +1240,9 @@ void App::renderMenu() {
     if (!showMenu) return;
 
     // Poloprůhledné pozadí menu
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState* glState = GLState::getInstance();
+    glState->setBlend(true);
+    glState->blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Aktualizace textů položek menu podle aktuálního stavu
     std::vector<std::string> currentMenuItems = menuItems;
@@ -1112,7 +1257,7 @@ void App::renderMenu() {
     float menuY = (height - menuHeight) / 2.0f;
 
     // Vykreslení pozadí menu (černý poloprůhledný obdélník)
-    glDisable(GL_DEPTH_TEST);
+    glState->setDepthTest(false);
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
     glLoadIdentity();
@@ -1133,7 +1278,7 @@ void App::renderMenu() {
     glMatrixMode(GL_PROJECTION);
     glPopMatrix();
     glMatrixMode(GL_MODELVIEW);
-    glEnable(GL_DEPTH_TEST);
+    glState->setDepthTest(true);
 
     // Vykreslení textu menu
     float titleScale = 2.0f;
@@ -1171,7 +1316,7 @@ void App::renderMenu() {
             color);
     }
 
-    glDisable(GL_BLEND);
+    glState->setBlend(false);
 }
 
 // Metoda pro zpracování výběru položky menu
@@ -1212,10 +1357,7 @@ void App::toggleSpotLight() {
     // Aktualizace položky menu
     menuItems[4] = "Flashlight: " + std::string(spotLightEnabled ? "ON" : "OFF");
 
-    // Aktualizace uniformu v shaderu
-    lightingShader.activate();
-    lightingShader.setUniform("spotLightEnabled", spotLightEnabled);
-    lightingShader.deactivate();
+    // Varianta programu s čelovkou se vybere při dalším vykreslení (viz App::run)
 
     std::cout << "Flashlight " << (spotLightEnabled ? "enabled" : "disabled") << std::endl;
 }
\ No newline at end of file
@@ -7,10 +7,20 @@
 #include "assets.hpp"
 #include "ShaderProgram.hpp"
 #include "Model.hpp"
+#include "InstanceBatch.hpp"
+#include "AssetLoader.hpp"
 #include "Camera.hpp"
 #include "ParticleSystem.hpp"
 #include "TextRenderer.hpp"
 #include "SpotLight.hpp" // Přidaný include pro SpotLight
+#include "SceneUniforms.hpp"
+#include "ShaderCache.hpp"
+#include "ShaderPermutations.hpp"
+#include "GLState.hpp"
+#include "RenderQueue.hpp"
+#include "GpuCuller.hpp"
+#include "SceneBVH.hpp"
+#include "MazePVS.hpp"
 
 // Struktura pro směrové světlo
 struct DirectionalLight {
@@ -27,8 +37,8 @@ public:
     bool init(GLFWwindow* window);
     void init_assets();
     bool run();
-    // Načtení textury z obrázku pomocí OpenCV
-    GLuint textureInit(const std::filesystem::path& filepath);
+    // Načtení textury z obrázku pomocí OpenCV (sdílená přes ResourceManager)
+    std::shared_ptr<Texture> textureInit(const std::filesystem::path& filepath);
     // Callback metody
     static void fbsize_callback(GLFWwindow* window, int width, int height);
     static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
@@ -51,13 +61,32 @@ public:
 
 private:
     ShaderProgram shader;
-    ShaderProgram lightingShader; // Nový shader pro osvětlení
+    ShaderProgram lightingShader; // Nový shader pro osvětlení (základní varianta, se kterou se vytváří modely)
+
+    // Varianty osvětlovacího programu podle stavu objektu a scény (bity = definice v directional.vert/.frag)
+    ShaderPermutations lightingVariants;
+    static constexpr uint32_t LIGHTING_SPOT_LIGHT = 1u << 0;
+    static constexpr uint32_t LIGHTING_TRANSPARENT = 1u << 1;
+    static constexpr uint32_t LIGHTING_INSTANCED = 1u << 2;
 
     Model* triangle{ nullptr };
     // Bludiště
     cv::Mat maze_map;
     std::vector<Model*> maze_walls;
-    std::vector<GLuint> wall_textures;
+    // Textury bludiště - jedno GL_TEXTURE_2D_ARRAY z atlasu, meshe vybírají vrstvu
+    std::shared_ptr<Texture> mazeTextureArray;
+    static constexpr int MAZE_LAYER_FLOOR = 0;
+    static constexpr int MAZE_LAYER_WALL = 1;
+    // Instancované skupiny zdí a podlahy (jeden draw call na mesh + texturu)
+    std::vector<InstanceBatch*> maze_batches;
+    // Ořezání zdí a podlahy na GPU a vykreslení jedním glMultiDrawElementsIndirectCount (nullptr = bez compute shaderů)
+    GpuCuller* mazeCuller{ nullptr };
+    void buildMazeBatches();
+    // Předpočítaná viditelnost mezi buňkami bludiště a buňka kamery (NO_CELL = PVS se nepoužije)
+    MazePVS mazePVS;
+    int pvsCell{ MazePVS::NO_CELL };
+    static constexpr float MAZE_WALL_TOP = 1.5f; // horní hrana zdí (kostky se středem v y = 1)
+    void updatePVSCell();
 
     // Transparentní králíci
     std::vector<Model*> transparent_bunnies;
@@ -91,11 +120,32 @@ private:
     bool firstMouse{ true };             // Proměnná pro inicializaci pozice kurzoru
     // Metoda pro aktualizaci projekční matice
     void update_projection_matrix();
-    // Pomocná metoda pro generování OpenGL textury z OpenCV obrázku
-    GLuint gen_tex(cv::Mat& image);
 
-    Model* particleModel;
-    ParticleSystem* fountain;
+    Model* particleModel{ nullptr };
+    ParticleSystem* fountain{ nullptr };
+
+    // Fronta vykreslení scény (řadicí klíče, viz RenderQueue.hpp)
+    RenderQueue renderQueue;
+    // Ořezání pohledovým jehlanem na CPU (králíci, slunce; zdi jen bez GPU ořezání) a výsledek snímku
+    SceneBVH sceneBVH;
+    std::vector<Model*> visibleModels;
+    static constexpr float FAR_PLANE = 20000.0f;
+
+    // Asynchronní načítání - do dokončení se místo scény kreslí obrazovka s průběhem
+    bool loading{ false };
+    double loadingStart{ 0.0 };
+    static constexpr double LOADING_UPLOAD_BUDGET_MS = 4.0; // čas na nahrávání na GPU za snímek
+    static constexpr double TEXTURE_STREAMING_BUDGET_MS = 2.0; // čas na streamování textur za snímek
+    AssetHandle<std::shared_ptr<MeshGeometry>> cubeMesh;     // kostky bludiště
+    AssetHandle<std::shared_ptr<MeshGeometry>> particleMesh; // částice fontány
+    AssetHandle<std::shared_ptr<MeshGeometry>> bunnyMesh;
+    AssetHandle<std::shared_ptr<MeshGeometry>> sunMesh;
+    AssetHandle<std::shared_ptr<Texture>> mazeTextures;      // pole textur (podlaha, zeď) z atlasu
+    AssetHandle<std::shared_ptr<Texture>> bunnyTexture;
+    AssetHandle<std::shared_ptr<Texture>> sunTexture;
+    void requestAssets();        // Zadání požadavků do AssetLoaderu
+    void finishLoading();        // Sestavení scény z načtených assetů
+    void renderLoadingScreen();  // Obrazovka s průběhem načítání
 
     // Proměnné pro správu celoobrazovkového režimu
     bool isFullscreen{ false };
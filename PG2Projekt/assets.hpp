@@ -8,6 +8,6 @@
 //vertex description
 struct vertex {
     glm::vec3 position;  // Pozice vrcholu
-    glm::vec3 normal;    // Normla vrcholu
-    glm::vec2 texCoord;  // Texturovac koordinty
+    glm::vec3 normal;    // Normála vrcholu
+    glm::vec2 texCoord;  // Texturovací koordináty
 };
\ No newline at end of file
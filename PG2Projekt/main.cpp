@@ -2,23 +2,27 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <stdexcept>
+#include <cstdlib>
 #include <string>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include "app.hpp"
+#include "OBJloader.hpp"
+#include "MeshOptimizer.hpp"
+#include "ResourceManager.hpp"
 
 using json = nlohmann::json;
 
-// Globln instance aplikace
+// Globální instance aplikace
 App myApp;
 
-// Callback funkce pro klvesy
+// Callback funkce pro klávesy
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    // Ukonen aplikace klvesou Escape
+    // Ukončení aplikace klávesou Escape
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GLFW_TRUE);
 
-    // Pepnn VSync klvesou F10
+    // Přepínání VSync klávesou F10
     if (key == GLFW_KEY_F10 && action == GLFW_PRESS) {
         static bool vsync = false;
         vsync = !vsync;
@@ -27,22 +31,22 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
 }
 
-// KOL 2: Implementace natn a validace antialiasingu
+// ÚKOL 2: Implementace načítání a validace antialiasingu
 
-// Funkce pro vytvoen vchoz konfigurace
-// Funkce pro vytvoen vchoz konfigurace
+// Funkce pro vytvoření výchozí konfigurace
+// Funkce pro vytvoření výchozí konfigurace
 void create_default_config() {
     json config;
     config["window"] = {
         {"width", 800},
         {"height", 600},
         {"title", "OpenGL Maze Demo"},
-        {"x", 100},                // Vchoz pozice X
-        {"y", 100},                // Vchoz pozice Y
-        {"isFullscreen", false}    // Vchoz reim je okenn
+        {"x", 100},                // Výchozí pozice X
+        {"y", 100},                // Výchozí pozice Y
+        {"isFullscreen", false}    // Výchozí režim je okenní
     };
 
-    // Pidn konfigurace pro antialiasing
+    // Přidání konfigurace pro antialiasing
     config["graphics"] = {
         {"antialiasing", {
             {"enabled", false},
@@ -52,37 +56,37 @@ void create_default_config() {
 
     std::ofstream file("config.json");
     if (!file.is_open()) {
-        std::cerr << "Nelze vytvoit konfiguran soubor!" << std::endl;
+        std::cerr << "Nelze vytvořit konfigurační soubor!" << std::endl;
         return;
     }
-    file << config.dump(4); // Formtovan JSON se 4 mezerami
+    file << config.dump(4); // Formátovaný JSON se 4 mezerami
 }
 
-// Funkce pro naten konfigurace
+// Funkce pro načtení konfigurace
 json load_config() {
     try {
         std::ifstream file("config.json");
         if (!file.is_open()) {
-            std::cout << "Konfiguran soubor neexistuje, vytvm vchoz." << std::endl;
+            std::cout << "Konfigurační soubor neexistuje, vytvářím výchozí." << std::endl;
             create_default_config();
             file.open("config.json");
             if (!file.is_open()) {
-                throw std::runtime_error("Nelze vytvoit konfiguran soubor");
+                throw std::runtime_error("Nelze vytvořit konfigurační soubor");
             }
         }
         return json::parse(file);
     }
     catch (const std::exception& e) {
-        std::cerr << "Chyba pi natn konfigurace: " << e.what() << std::endl;
-        // Vrtme vchoz konfiguraci
+        std::cerr << "Chyba při načítání konfigurace: " << e.what() << std::endl;
+        // Vrátíme výchozí konfiguraci
         json default_config;
         default_config["window"] = {
             {"width", 800},
             {"height", 600},
             {"title", "OpenGL Maze Demo"},
-            {"x", 100},                // Vchoz pozice X
-            {"y", 100},                // Vchoz pozice Y
-            {"isFullscreen", false}    // Vchoz reim je okenn
+            {"x", 100},                // Výchozí pozice X
+            {"y", 100},                // Výchozí pozice Y
+            {"isFullscreen", false}    // Výchozí režim je okenní
         };
         default_config["graphics"] = {
             {"antialiasing", {
@@ -94,34 +98,34 @@ json load_config() {
     }
 }
 
-// Funkce pro validaci nastaven antialiasingu
+// Funkce pro validaci nastavení antialiasingu
 bool validate_antialiasing_settings(const json& config, bool& antialiasing_enabled, int& samples) {
     bool valid = true;
 
-    // Kontrola, zda jsou nastaven antialiasingu v konfiguraci
+    // Kontrola, zda jsou nastavení antialiasingu v konfiguraci
     if (!config.contains("graphics") || !config["graphics"].contains("antialiasing")) {
-        std::cerr << "Varovn: Chyb nastaven antialiasingu v konfiguraci." << std::endl;
+        std::cerr << "Varování: Chybí nastavení antialiasingu v konfiguraci." << std::endl;
         antialiasing_enabled = false;
         samples = 0;
         return false;
     }
 
-    // Zskn hodnot z konfigurace
+    // Získání hodnot z konfigurace
     const auto& aa_config = config["graphics"]["antialiasing"];
     antialiasing_enabled = aa_config.value("enabled", false);
     samples = aa_config.value("samples", 0);
 
-    // Kontrola potu vzork pokud je antialiasing povolen
+    // Kontrola počtu vzorků pokud je antialiasing povolen
     if (antialiasing_enabled) {
         if (samples <= 1) {
-            std::cerr << "Varovn: Antialiasing je povolen, ale poet vzork je <= 1. "
-                << "Nastavuji poet vzork na 4." << std::endl;
+            std::cerr << "Varování: Antialiasing je povolen, ale počet vzorků je <= 1. "
+                << "Nastavuji počet vzorků na 4." << std::endl;
             samples = 4;
             valid = false;
         }
         else if (samples > 8) {
-            std::cerr << "Varovn: Pli vysok poet vzork antialiasingu (> 8). "
-                << "Nastavuji poet vzork na 8." << std::endl;
+            std::cerr << "Varování: Příliš vysoký počet vzorků antialiasingu (> 8). "
+                << "Nastavuji počet vzorků na 8." << std::endl;
             samples = 8;
             valid = false;
         }
@@ -130,37 +134,82 @@ bool validate_antialiasing_settings(const json& config, bool& antialiasing_enabl
     return valid;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Benchmark OBJ parseru: PG2Projekt.exe --bench-obj <soubor.obj> [počet opakování]
+    if (argc >= 3 && std::string(argv[1]) == "--bench-obj") {
+        benchmarkOBJ(argv[2], argc >= 4 ? std::atoi(argv[3]) : 10);
+        return 0;
+    }
+
+    // Optimalizace meshe bez spuštění okna (výpis ACMR/ATVR): PG2Projekt.exe --optimize-obj <soubor.obj>
+    if (argc >= 3 && std::string(argv[1]) == "--optimize-obj") {
+        ObjData obj;
+        if (!parseOBJ(argv[2], obj)) {
+            return EXIT_FAILURE;
+        }
+        std::vector<vertex> vertices;
+        std::vector<GLuint> indices;
+        ResourceManager::deduplicateVertices(obj, vertices, indices);
+        optimizeMesh(vertices, indices, argv[2]);
+        return 0;
+    }
+
+    // Kontrola kodérů BCn na dvoubarevných blocích: PG2Projekt.exe --verify-compression
+    if (argc >= 2 && std::string(argv[1]) == "--verify-compression") {
+        bool valid = verifyCompression();
+        std::cout << "Texture compression check: " << (valid ? "OK" : "FAILED") << std::endl;
+        return valid ? 0 : EXIT_FAILURE;
+    }
+
+    // Offline komprese textury do cache: PG2Projekt.exe --compress-texture <soubor> [bc1|bc3|bc7]
+    if (argc >= 3 && std::string(argv[1]) == "--compress-texture") {
+        TextureOptions options;
+        options.compression = parseCompression(argc >= 4 ? argv[3] : "bc7");
+        if (options.compression == TextureCompression::None) {
+            std::cerr << "Neznámý formát komprese: " << argv[3] << std::endl;
+            return EXIT_FAILURE;
+        }
+        try {
+            TextureImportData data;
+            ResourceManager::loadTextureData(argv[2], options, data);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
     try {
         // Inicializace GLFW
         if (!glfwInit()) {
-            throw std::runtime_error("Nepodailo se inicializovat GLFW");
+            throw std::runtime_error("Nepodařilo se inicializovat GLFW");
         }
 
-        // Naten konfigurace
+        // Načtení konfigurace
         json config = load_config();
         int width = config["window"]["width"];
         int height = config["window"]["height"];
         std::string title = config["window"]["title"];
 
-        // Naten pozice okna, pokud je k dispozici
+        // Načtení pozice okna, pokud je k dispozici
         int windowX = config["window"].value("x", 100);
         int windowY = config["window"].value("y", 100);
         bool isFullscreen = config["window"].value("isFullscreen", false);
 
-        // Validace a nastaven antialiasingu
+        // Validace a nastavení antialiasingu
         bool antialiasing_enabled;
         int samples;
         validate_antialiasing_settings(config, antialiasing_enabled, samples);
 
-        // Nastaven OpenGL verze a profilu
+        // Nastavení OpenGL verze a profilu
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-        // Nastaven antialiasingu podle konfigurace
+        // Nastavení antialiasingu podle konfigurace
         if (antialiasing_enabled) {
-            std::cout << "Antialiasing povolen, poet vzork: " << samples << std::endl;
+            std::cout << "Antialiasing povolen, počet vzorků: " << samples << std::endl;
             glfwWindowHint(GLFW_SAMPLES, samples);
         }
         else {
@@ -168,12 +217,12 @@ int main() {
             glfwWindowHint(GLFW_SAMPLES, 0);
         }
 
-        // Vytvoen okna
+        // Vytvoření okna
         GLFWwindow* window = nullptr;
         GLFWmonitor* monitor = nullptr;
 
         if (isFullscreen) {
-            // Vytvoen celoobrazovkovho okna
+            // Vytvoření celoobrazovkového okna
             monitor = glfwGetPrimaryMonitor();
             const GLFWvidmode* mode = glfwGetVideoMode(monitor);
 
@@ -181,34 +230,34 @@ int main() {
                 width = mode->width;
                 height = mode->height;
                 window = glfwCreateWindow(width, height, title.c_str(), monitor, NULL);
-                std::cout << "Vytvm celoobrazovkov okno: " << width << "x" << height << std::endl;
+                std::cout << "Vytvářím celoobrazovkové okno: " << width << "x" << height << std::endl;
             }
             else {
-                std::cerr << "Nepodailo se zskat reim videa, pouiji okenn reim." << std::endl;
+                std::cerr << "Nepodařilo se získat režim videa, použiji okenní režim." << std::endl;
                 isFullscreen = false;
             }
         }
 
         if (!isFullscreen) {
-            // Vytvoen okna v okennm reimu
+            // Vytvoření okna v okenním režimu
             window = glfwCreateWindow(width, height, title.c_str(), NULL, NULL);
             if (window) {
-                // Nastaven pozice okna
+                // Nastavení pozice okna
                 glfwSetWindowPos(window, windowX, windowY);
-                std::cout << "Vytvm okno: " << width << "x" << height
+                std::cout << "Vytvářím okno: " << width << "x" << height
                     << " na pozici (" << windowX << ", " << windowY << ")" << std::endl;
             }
         }
 
         if (!window) {
             glfwTerminate();
-            throw std::runtime_error("Nepodailo se vytvoit GLFW okno");
+            throw std::runtime_error("Nepodařilo se vytvořit GLFW okno");
         }
 
         // Aktivace OpenGL kontextu
         glfwMakeContextCurrent(window);
 
-        // Vypnut VSync pro maximln FPS
+        // Vypnutí VSync pro maximální FPS
         glfwSwapInterval(0);
 
         // Inicializace GLEW
@@ -216,14 +265,14 @@ int main() {
         GLenum err = glewInit();
         if (err != GLEW_OK) {
             glfwTerminate();
-            throw std::runtime_error(std::string("Nepodailo se inicializovat GLEW: ") +
+            throw std::runtime_error(std::string("Nepodařilo se inicializovat GLEW: ") +
                 (const char*)glewGetErrorString(err));
         }
 
-        // Registrace callback funkce pro klvesy
+        // Registrace callback funkce pro klávesy
         glfwSetKeyCallback(window, key_callback);
 
-        // Povolen multisamplingu, pokud je antialiasing aktivn
+        // Povolení multisamplingu, pokud je antialiasing aktivní
         if (antialiasing_enabled) {
             glEnable(GL_MULTISAMPLE);
         }
@@ -231,20 +280,20 @@ int main() {
         // Inicializace aplikace
         myApp.init(window);
 
-        // Nastaven informace o celoobrazovkovm reimu do aplikace
+        // Nastavení informace o celoobrazovkovém režimu do aplikace
         if (isFullscreen) {
-            // Simulujeme pepnut do celoobrazovkovho reimu, abychom nastavili sprvn hodnoty
+            // Simulujeme přepnutí do celoobrazovkového režimu, abychom nastavili správné hodnoty
             myApp.toggleFullscreen();
         }
         else {
-            // Uloen poten konfigurace okennho reimu
+            // Uložení počáteční konfigurace okenního režimu
             myApp.saveWindowConfig();
         }
 
-        // Sputn hlavn smyky
+        // Spuštění hlavní smyčky
         myApp.run();
 
-        // klid
+        // Úklid
         glfwTerminate();
         return 0;
     }
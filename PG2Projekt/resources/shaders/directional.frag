@@ -1,4 +1,8 @@
 #version 460 core
+// Varianty (ShaderPermutations, definice vkládá ShaderProgram za #version):
+//   SPOT_LIGHT  - zapnutá čelová baterka
+//   TRANSPARENT - průhledný objekt (barva a alfa z u_diffuse_color)
+
 // Výstup - barva v RGBA
 out vec4 FragColor;
 
@@ -7,80 +11,106 @@ in VS_OUT {
     vec3 Normal;   // Normála ve world space
     vec3 FragPos;  // Pozice fragmentu ve world space 
     vec2 TexCoord; // Texturové koordináty
+    flat int TexLayer; // Vrstva pole textur
 } fs_in;
 
-// Vlastnosti materiálu
-uniform vec3 ambientMaterial = vec3(0.2, 0.2, 0.2);     // Ambient složka materiálu
-uniform vec3 diffuseMaterial = vec3(1.0, 1.0, 1.0);     // Diffuse složka materiálu
-uniform vec3 specularMaterial = vec3(1.0, 1.0, 1.0);    // Specular složka materiálu
-uniform float shininess = 32.0;                         // Lesklost materiálu
+// Uniform bloky sdílené všemi programy (SceneUniforms, layout std140) - vec3 uložené jako vec4
+// Kamera - pozice pro výpočet spekulární složky (world space)
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} camera;
 
-// Vlastnosti směrového světla - v world space
-uniform vec3 lightDir = vec3(0.0, -1.0, -1.0);          // Směr světla (výchozí hodnota)
-uniform vec3 lightAmbient = vec3(0.2, 0.2, 0.2);        // Ambient složka světla
-uniform vec3 lightDiffuse = vec3(0.8, 0.8, 0.8);        // Diffuse složka světla
-uniform vec3 lightSpecular = vec3(1.0, 1.0, 1.0);       // Specular složka světla
+// Směrové světlo (slunce) - v world space
+layout(std140, binding = 1) uniform DirectionalLightBlock {
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+} dirLight;
+
+// Spotlight (čelová baterka)
+layout(std140, binding = 2) uniform SpotLightBlock {
+    vec4 position;
+    vec4 direction;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
 
-// Struktura pro Spotlight (čelová baterka)
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    
     float constant;
     float linear;
     float quadratic;
-    
+
     float cutOff;
     float outerCutOff;
-};
-
-// Uniform pro spotlight
-uniform SpotLight spotLight;
-uniform bool spotLightEnabled = false;  // Ovládání zapnutí/vypnutí
+} spotLight;
 
-// Pozice kamery (pro výpočet spekulární složky) - world space
-uniform vec3 viewPos = vec3(0.0, 0.0, 0.0);             // Pozice kamery ve world space
+// Výchozí vlastnosti materiálu
+layout(std140, binding = 3) uniform MaterialBlock {
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    float shininess;
+} material;
 
-// Textura
-uniform sampler2D tex0;
+// Textura - samostatná nebo vrstva pole textur (bludiště). Pevné jednotky: různé typy samplerů
+// nesmí sdílet jednotku, i když se ten nepoužitý nečte (jinak GL_INVALID_OPERATION při kreslení)
+layout(binding = 0) uniform sampler2D tex0;
+layout(binding = 1) uniform sampler2DArray texArray;
+uniform bool uUseTexArray = false;
 
-// Příznak průhlednosti
-uniform bool transparent = false;                        // Je objekt průhledný?
+#ifdef TRANSPARENT
 uniform vec4 u_diffuse_color = vec4(1.0, 1.0, 1.0, 1.0); // Barva a průhlednost
+#endif
+
+// Přechod mezi úrovněmi detailu (dithered cross-fade, viz Mesh::draw)
+// 1 = bez přechodu, (0,1) = nová úroveň, (-1,0) = doplněk pro předchozí úroveň
+uniform float uLodFade = 1.0;
 
+// Práh uspořádaného ditheringu (Bayer 4x4) pro daný pixel, v rozsahu (0,1)
+float ditherThreshold() {
+    const float bayer[16] = float[16](
+         0.0,  8.0,  2.0, 10.0,
+        12.0,  4.0, 14.0,  6.0,
+         3.0, 11.0,  1.0,  9.0,
+        15.0,  7.0, 13.0,  5.0);
+    ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+#ifdef SPOT_LIGHT
 // Funkce pro výpočet vlivu spotlightu (čelové baterky)
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
-    vec3 lightDir = normalize(light.position - fragPos);
+vec3 CalcSpotLight(vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 lightDir = normalize(spotLight.position.xyz - fragPos);
     
     // Úhel mezi aktuálním směrem a směrem světla
-    float theta = dot(lightDir, normalize(-light.direction));
+    float theta = dot(lightDir, normalize(-spotLight.direction.xyz));
     
     // Výpočet intenzity na základě plynulého přechodu mezi vnitřním a vnějším úhlem
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float epsilon = spotLight.cutOff - spotLight.outerCutOff;
+    float intensity = clamp((theta - spotLight.outerCutOff) / epsilon, 0.0, 1.0);
     
     // Ambient složka (vždy přítomná i mimo kužel)
-    vec3 ambient = light.ambient * ambientMaterial;
+    vec3 ambient = spotLight.ambient.rgb * material.ambient.rgb;
     
     // Pokud jsme uvnitř kužele, přidáme diffuse a specular složky
     vec3 result = ambient;
     
-    if (theta > light.outerCutOff) {
+    if (theta > spotLight.outerCutOff) {
         // Diffuse složka
         float diff = max(dot(normal, lightDir), 0.0);
-        vec3 diffuse = light.diffuse * (diff * diffuseMaterial) * intensity;
+        vec3 diffuse = spotLight.diffuse.rgb * (diff * material.diffuse.rgb) * intensity;
         
         // Specular složka (Phong)
         vec3 reflectDir = reflect(-lightDir, normal);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-        vec3 specular = light.specular * (spec * specularMaterial) * intensity;
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+        vec3 specular = spotLight.specular.rgb * (spec * material.specular.rgb) * intensity;
         
         // Útlum na základě vzdálenosti
-        float distance = length(light.position - fragPos);
-        float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+        float distance = length(spotLight.position.xyz - fragPos);
+        float attenuation = 1.0 / (spotLight.constant + spotLight.linear * distance + spotLight.quadratic * (distance * distance));
         
         // Aplikace útlumu na všechny složky
         ambient *= attenuation;
@@ -92,44 +122,53 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     
     return result;
 }
+#endif
 
 void main() {
+    // Dithered cross-fade mezi LOD úrovněmi - obě úrovně dohromady pokryjí každý pixel právě jednou
+    if (uLodFade < 1.0) {
+        float threshold = ditherThreshold();
+        if (uLodFade >= 0.0 ? threshold >= uLodFade : threshold < 1.0 + uLodFade) {
+            discard;
+        }
+    }
+
     // Normalizace vektorů
     vec3 normal = normalize(fs_in.Normal);
-    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 viewDir = normalize(camera.position.xyz - fs_in.FragPos);
     
     // Výpočet pro směrové světlo (slunce)
-    vec3 lightDirection = normalize(-lightDir); // Otočíme směr světla
+    vec3 lightDirection = normalize(-dirLight.direction.xyz); // Otočíme směr světla
     
     // Ambient složka
-    vec3 ambient = lightAmbient * ambientMaterial;
+    vec3 ambient = dirLight.ambient.rgb * material.ambient.rgb;
     
     // Diffuse složka
     float diff = max(dot(normal, lightDirection), 0.0);
-    vec3 diffuse = lightDiffuse * (diff * diffuseMaterial);
+    vec3 diffuse = dirLight.diffuse.rgb * (diff * material.diffuse.rgb);
     
     // Specular složka (Phong)
     vec3 reflectDir = reflect(-lightDirection, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    vec3 specular = lightSpecular * (spec * specularMaterial);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = dirLight.specular.rgb * (spec * material.specular.rgb);
     
     // Kombinace složek směrového světla
     vec3 result = ambient + diffuse + specular;
     
     // Přidání vlivu čelové baterky, pokud je zapnutá
-    if (spotLightEnabled) {
-        result += CalcSpotLight(spotLight, normal, fs_in.FragPos, viewDir);
-    }
+#ifdef SPOT_LIGHT
+    result += CalcSpotLight(normal, fs_in.FragPos, viewDir);
+#endif
     
     // Textura
-    vec4 texColor = texture(tex0, fs_in.TexCoord);
+    vec4 texColor = uUseTexArray ? texture(texArray, vec3(fs_in.TexCoord, fs_in.TexLayer)) : texture(tex0, fs_in.TexCoord);
     
     // Aplikace textury a průhlednosti
-    if (transparent) {
-        // Pro průhledné objekty použijeme u_diffuse_color
-        FragColor = vec4(result, 1.0) * vec4(texColor.rgb, 1.0) * u_diffuse_color;
-    } else {
-        // Pro neprůhledné objekty
-        FragColor = vec4(result, 1.0) * texColor;
-    }
+#ifdef TRANSPARENT
+    // Pro průhledné objekty použijeme u_diffuse_color
+    FragColor = vec4(result, 1.0) * vec4(texColor.rgb, 1.0) * u_diffuse_color;
+#else
+    // Pro neprůhledné objekty
+    FragColor = vec4(result, 1.0) * texColor;
+#endif
 }
\ No newline at end of file
@@ -1,37 +1,90 @@
 #version 460 core
-// Vertex attributes
-in vec3 aPos;
-in vec3 aNorm;
-in vec2 aTex;
+// Varianty (ShaderPermutations): INSTANCED - matice a vrstva textury z SSBO podle gl_BaseInstance + gl_InstanceID
+// Vertex attributes (umístění odpovídají sdíleným VAO v GeometryPool)
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNorm;
+layout (location = 2) in vec2 aTex;
 
+// Kamera - uniform blok sdílený všemi programy (SceneUniforms, binding 0)
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} camera;
+
+#ifdef INSTANCED
+// Instancované vykreslování - matice instancí v SSBO (viz InstanceBatch.hpp)
+struct InstanceData {
+    mat4 model;   // Model matice
+    mat4 normal;  // Normálová matice (mat3 uložená v mat4 kvůli zarovnání)
+    ivec4 params; // x = vrstva pole textur
+};
+layout(std430, binding = 0) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+#else
 // Matrices 
-uniform mat4 uP_m = mat4(1.0f); // Projekční matice
-uniform mat4 uV_m = mat4(1.0f); // View matice (kamera)
 uniform mat4 uM_m = mat4(1.0f); // Model matice (pozice, rotace, měřítko objektu)
+uniform mat3 uN_m = mat3(1.0f); // Normálová matice (předpočítaná na CPU)
+uniform int uTexLayer = 0;       // vrstva pole textur pro neinstancované vykreslení
+#endif
+
+// Kvantizované vrcholy (packed_vertex, viz VertexFormat.hpp)
+uniform bool uQuantized = false;
+uniform vec3 uPosOffset = vec3(0.0); // minimum obalového kvádru meshe
+uniform vec3 uPosScale = vec3(1.0);  // rozměr obalového kvádru meshe
 
-// Směrové světlo - vlastnosti
-uniform vec3 lightDir = vec3(0.0, -1.0, -1.0); // Výchozí hodnota - světový prostor
+// Dekódování oktaedricky zakódované normály
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
 
 // Výstupy do fragment shaderu
 out VS_OUT {
     vec3 Normal;   // Normála ve world space
     vec3 FragPos;  // Pozice fragmentu ve world space
     vec2 TexCoord; // Texturové koordináty
+    flat int TexLayer; // Vrstva pole textur
 } vs_out;
 
 void main(void) {
+    // Model a normálová matice - z SSBO (instance) nebo z uniformů
+#ifdef INSTANCED
+    // Base instance = začátek úseku příkazu při multi-draw indirect (GpuCuller), jinak 0
+    int instance = gl_BaseInstance + gl_InstanceID;
+    mat4 model = instances[instance].model;
+    mat3 normalMatrix = mat3(instances[instance].normal);
+    vs_out.TexLayer = instances[instance].params.x;
+#else
+    mat4 model = uM_m;
+    mat3 normalMatrix = uN_m;
+    vs_out.TexLayer = uTexLayer;
+#endif
+
+    // Lokální pozice a normála - u kvantizovaného formátu dekódované
+    vec3 position = aPos;
+    vec3 normal = aNorm;
+    if (uQuantized) {
+        position = uPosOffset + aPos * uPosScale;
+        normal = octDecode(aNorm.xy);
+    }
+
     // Pozice vrcholu ve world space
-    vec4 worldPos = uM_m * vec4(aPos, 1.0);
+    vec4 worldPos = model * vec4(position, 1.0);
     
     // Předání pozice fragmentu ve world space
     vs_out.FragPos = worldPos.xyz;
     
     // Výpočet normály ve world space (ne view space)
-    vs_out.Normal = mat3(transpose(inverse(uM_m))) * aNorm;
+    vs_out.Normal = normalMatrix * normal;
     
     // Předání texturových koordinátů
     vs_out.TexCoord = aTex;
     
     // Výpočet clip-space pozice každého vrcholu
-    gl_Position = uP_m * uV_m * worldPos;
+    gl_Position = camera.viewProjection * worldPos;
 }
\ No newline at end of file
@@ -1,17 +1,29 @@
 #version 460 core
-in vec3 aPos;
-in vec3 aNorm;
-in vec2 aTex;
-uniform mat4 uP_m = mat4(1.0f);
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNorm;
+layout (location = 2) in vec2 aTex;
+// Kamera - uniform blok sdílený všemi programy (SceneUniforms, binding 0)
+layout(std140, binding = 0) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} camera;
 uniform mat4 uM_m = mat4(1.0f);
-uniform mat4 uV_m = mat4(1.0f);
+// Kvantizované vrcholy (packed_vertex) - pozice relativně k obalovému kvádru meshe
+uniform bool uQuantized = false;
+uniform vec3 uPosOffset = vec3(0.0);
+uniform vec3 uPosScale = vec3(1.0);
 out VS_OUT
 {
     vec2 texcoord;
 } vs_out;
 void main()
 {
+    // Dekódování kvantizované pozice (normála se zde nepoužívá)
+    vec3 position = uQuantized ? uPosOffset + aPos * uPosScale : aPos;
+
     // Outputs the positions/coordinates of all vertices
-    gl_Position = uP_m * uV_m * uM_m * vec4(aPos, 1.0f);
+    gl_Position = camera.viewProjection * uM_m * vec4(position, 1.0f);
     vs_out.texcoord = aTex;
 }
\ No newline at end of file